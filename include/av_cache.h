@@ -0,0 +1,170 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_cache.h                                         */
+/*                                                                   */
+/*********************************************************************/
+
+/*! \file av_cache.h
+*   \brief av_cache definition representing least recently used cache
+*/
+
+#ifndef __AV_CACHE_H
+#define __AV_CACHE_H
+
+#include <av.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+* \brief Releases cached value on eviction, removal or cache destroy
+*/
+typedef void (*av_cache_free_t)(void* value);
+
+/*!
+* \brief Tells if cached value is in use elsewhere, busy values are not evicted
+*/
+typedef av_bool_t (*av_cache_busy_t)(void* value);
+
+/*!
+* \brief cache statistics
+*/
+typedef struct av_cache_stats
+{
+	/*! Lookups finding their key */
+	unsigned int hits;
+
+	/*! Lookups missing their key */
+	unsigned int misses;
+
+	/*! Values evicted to keep the cache in budget */
+	unsigned int evictions;
+
+	/*! Number of cached values */
+	unsigned int count;
+
+	/*! Sum of the cached values sizes in bytes */
+	unsigned int bytes;
+
+	/*! Maximum bytes kept */
+	unsigned int budget;
+
+	/*! Number of pinned values */
+	unsigned int pinned;
+} av_cache_stats_t, *av_cache_stats_p;
+
+/*!
+* \brief Class cache keeping values by string keys within byte budget
+*
+* Every value is added with its size in bytes. When the sum of the sizes
+* exceeds the budget the least recently used values are evicted, except the
+* pinned and busy ones. Not synchronized.
+*/
+typedef struct av_cache
+{
+	/*! Implementation specific */
+	void* context;
+
+	/*!
+	* \brief Adds value or replaces the value of existing key
+	*
+	* The least recently used values are evicted until the cache fits its
+	* budget, the added value is kept even if exceeding the budget alone.
+	* \param self is a reference to this object
+	* \param key non empty, zero terminated string, copied by the cache
+	* \param value to keep, released by the free callback when dropped
+	* \param bytes is the value size counted against the budget
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EARG on empty key
+	*         - AV_EMEM on out of memory, the value is not kept
+	*/
+	av_result_t (*add)    (struct av_cache* self, const char* key, void* value, unsigned int bytes);
+
+	/*!
+	* \brief Returns value by key, making it the most recently used
+	* \param self is a reference to this object
+	* \param key to lookup
+	* \return the value or AV_NULL if not found
+	*/
+	void* (*get)          (struct av_cache* self, const char* key);
+
+	/*!
+	* \brief Removes and releases value by key
+	* \param self is a reference to this object
+	* \param key to remove
+	* \return AV_TRUE if the key has been found
+	*/
+	av_bool_t (*remove)   (struct av_cache* self, const char* key);
+
+	/*!
+	* \brief Pins or unpins value, pinned values are not evicted
+	*
+	* Pins are counted, the value is evictable again after as many unpins.
+	* \param self is a reference to this object
+	* \param key of the value
+	* \param pin AV_TRUE to pin, AV_FALSE to unpin
+	* \return AV_TRUE if the key has been found
+	*/
+	av_bool_t (*pin)      (struct av_cache* self, const char* key, av_bool_t pin);
+
+	/*!
+	* \brief Removes and releases all values
+	* \param self is a reference to this object
+	*/
+	void (*clear)         (struct av_cache* self);
+
+	/*!
+	* \brief Changes the budget evicting values if needed
+	* \param self is a reference to this object
+	* \param budget is the maximum bytes kept
+	*/
+	void (*set_budget)    (struct av_cache* self, unsigned int budget);
+
+	/*!
+	* \brief Returns cache statistics
+	* \param self is a reference to this object
+	* \param stats is filled with the counters since creation
+	*/
+	void (*get_stats)     (struct av_cache* self, av_cache_stats_p stats);
+
+	/*!
+	* \brief Destroys this cache releasing all values
+	* \param self is a reference to this object
+	*/
+	void (*destroy)       (struct av_cache* self);
+} av_cache_t, *av_cache_p;
+
+/*!
+* \brief Creates new cache
+* \param budget is the maximum bytes kept
+* \param free_value releases dropped values, may be AV_NULL
+* \param ppcache result cache object
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_cache_create(unsigned int budget, av_cache_free_t free_value, av_cache_p* ppcache);
+
+/*!
+* \brief Creates new cache not evicting busy values
+* \param budget is the maximum bytes kept
+* \param free_value releases dropped values, may be AV_NULL
+* \param is_busy tells the values not to evict, may be AV_NULL
+* \param ppcache result cache object
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_cache_create_ex(unsigned int budget, av_cache_free_t free_value, av_cache_busy_t is_busy,
+									  av_cache_p* ppcache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AV_CACHE_H */
@@ -196,7 +196,24 @@ typedef struct av_display
 	*/
 	void        (*get_mouse_position)(struct av_display* self, int* pmx, int* pmy);
 
+	/*!
+	* \brief Presents the composited frame
+	*
+	* The composited content is kept between presents, so the next frame
+	* needs to composite only the damaged area.
+	* \param self is a reference to this object
+	*/
 	void        (*render)            (struct av_display* self);
+
+	/*!
+	* \brief Tells if every frame must be presented
+	*
+	* The system skips presenting frames without damage unless this returns AV_TRUE,
+	* e.g. for backends losing the screen content between presents.
+	* \param self is a reference to this object
+	* \return AV_TRUE to present frames without damage
+	*/
+	av_bool_t   (*is_present_forced) (struct av_display* self);
 } av_display_t, *av_display_p;
 
 /*!
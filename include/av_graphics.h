@@ -16,6 +16,7 @@
 
 #include <av.h>
 #include <av_oop.h>
+#include <av_cache.h>
 #include <av_surface.h>
 
 #ifdef __cplusplus
@@ -714,8 +715,31 @@ typedef struct av_graphics
 	av_result_t (*set_font_face)      (struct av_graphics* self, const char* fontface, av_font_slant_t slant, av_font_weight_t weight);
 	av_result_t (*set_font_size)      (struct av_graphics* self, int size);
 
+	/*!
+	* \brief Changes the memory budget of the text cache
+	*
+	* The glyphs and extents of the drawn and measured strings are cached by
+	* font face, font size, scale and string, the least recently used strings
+	* are dropped when the budget is exceeded.
+	* \param self is a reference to this object
+	* \param budget in bytes
+	*/
+	void (*set_text_cache_budget)     (struct av_graphics* self, unsigned int budget);
+
+	/*!
+	* \brief Returns text cache statistics
+	* \param self is a reference to this object
+	* \param stats is filled with the text cache counters
+	*/
+	void (*get_text_cache_stats)      (struct av_graphics* self, av_cache_stats_p stats);
+
 } av_graphics_t, *av_graphics_p;
 
+/*!
+* \brief Default text cache budget in bytes
+*/
+#define AV_GRAPHICS_TEXT_CACHE_BUDGET (256 * 1024)
+
 /*!
 * \brief Registers graphics class into OOP
 * \return av_result_t
@@ -0,0 +1,125 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_grid.h                                          */
+/*                                                                   */
+/*********************************************************************/
+
+/*! \file av_grid.h
+*   \brief av_grid definition representing spatial index of rectangles
+*/
+
+#ifndef __AV_GRID_H
+#define __AV_GRID_H
+
+#include <av.h>
+#include <av_rect.h>
+#include <av_vector.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+* \brief Default grid cell size in pixels
+*/
+#define AV_GRID_CELL_SIZE 128
+
+/*!
+* \brief Maximum number of cells an item is registered to
+*
+* Items spanning more cells are kept in a list tested on every query.
+*/
+#define AV_GRID_MAX_ITEM_CELLS 64
+
+/*!
+* \brief Class grid indexing items by their rectangles
+*
+* The plane is divided into square cells and every item is registered to the
+* cells its rectangle overlaps, so point and rectangle queries test only the
+* items in the queried cells instead of all items. Items without rectangle
+* are returned by every query, items spanning too many cells are tested by
+* every query.
+*/
+typedef struct av_grid
+{
+	/*! Implementation specific */
+	void* context;
+
+	/*! Cell size in pixels */
+	int cell_size;
+
+	/*! Number of items */
+	unsigned int size;
+
+	/*!
+	* \brief Adds item or updates the rectangle of already added item
+	*
+	* \param self is a reference to this object
+	* \param item to add
+	* \param rect of the item, AV_NULL for item matching all queries
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*add)       (struct av_grid* self, void* item, av_rect_p rect);
+
+	/*!
+	* \brief Removes item
+	*
+	* \param self is a reference to this object
+	* \param item to remove
+	* \return AV_TRUE if the item has been found
+	*/
+	av_bool_t (*remove)      (struct av_grid* self, void* item);
+
+	/*!
+	* \brief Appends the items intersecting rectangle in unspecified order
+	*
+	* \param self is a reference to this object
+	* \param rect to query
+	* \param items vector of pointers receiving the found items, each item once
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*query_rect)(struct av_grid* self, av_rect_p rect, av_vector_p items);
+
+	/*!
+	* \brief Appends the items containing point in unspecified order
+	*
+	* \param self is a reference to this object
+	* \param x point x position
+	* \param y point y position
+	* \param items vector of pointers receiving the found items
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*query_point)(struct av_grid* self, int x, int y, av_vector_p items);
+
+	/*!
+	* \brief Destroys this grid
+	*
+	* \param self is a reference to this object
+	*/
+	void (*destroy)          (struct av_grid* self);
+} av_grid_t, *av_grid_p;
+
+/*!
+* \brief Creates new grid
+* \param cell_size is the cell size in pixels, AV_GRID_CELL_SIZE if 0
+* \param ppgrid result grid object
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_grid_create(int cell_size, av_grid_p* ppgrid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AV_GRID_H */
@@ -18,6 +18,7 @@
 #define __AV_HASH_H
 
 #include <av.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,10 +28,62 @@ extern "C" {
 #define AV_HASH_CAPACITY_MEDIUM 5000
 #define AV_HASH_CAPACITY_HUGE   500000
 
+/*! Casts integer to a key of hash table created with AV_HASH_KEY_INTEGER */
+#define AV_HASH_INT_KEY(i) ((const void*)(intptr_t)(i))
+
+/*!
+* \brief hash table key types
+*/
+typedef enum
+{
+	/*! zero terminated string keys, copied by the hash table */
+	AV_HASH_KEY_STRING,
+
+	/*! pointer keys compared by address */
+	AV_HASH_KEY_POINTER,
+
+	/*! integer keys given by AV_HASH_INT_KEY */
+	AV_HASH_KEY_INTEGER
+} av_hash_key_t;
+
+/*!
+* \brief hash table creation flags
+*/
+typedef enum
+{
+	/*! all operations are guarded with R/W mutex */
+	AV_HASH_SYNCHRONIZED   = 0,
+
+	/*! no locking, for tables confined to a single thread */
+	AV_HASH_UNSYNCHRONIZED = 1
+} av_hash_flags_t;
+
+/*!
+* \brief hash table iterator
+*
+* Holds the iteration state outside of the hash table, so nested or
+* concurrent traversals of the same table do not disturb each other:
+* \code
+* av_hash_cursor_t cursor;
+* const void* key;
+* void* value;
+* for (hash->cursor_first(hash, &cursor); hash->cursor_next(hash, &cursor, &key, &value);)
+*     use(key, value);
+* \endcode
+* The table must not be modified during the iteration.
+*/
+typedef struct av_hash_cursor
+{
+	/*! Implementation specific */
+	unsigned int index;
+} av_hash_cursor_t, *av_hash_cursor_p;
+
 /*! 
 * \brief hash table
 *
-* Data structure associating keys with values
+* Data structure associating keys with values.
+* Implemented with robin hood double hashing over a prime sized table,
+* each record caching its hash code and probe count
 */
 typedef struct av_hash
 {
@@ -38,7 +91,7 @@ typedef struct av_hash
 	void* context;
 
 	/*!
-	* \brief Adds key/value pair
+	* \brief Adds key/value pair, replacing the value if the key is already present
 	* \param self is a reference to this object
 	* \param key a non empty, zero terminated string
 	* \param value is a user pointer
@@ -69,6 +122,83 @@ typedef struct av_hash
 						  const char* key
 	);
 
+	/*!
+	* \brief Adds key/value pair to table of any key type
+	* \param self is a reference to this object
+	* \param key a string, pointer or AV_HASH_INT_KEY(integer) depending on the table key type
+	* \param value is a user pointer
+	* \return - AV_OK on success
+	*         - AV_EARG on null or empty string given as a key
+	*         - AV_EMEM on allocation error
+	*/
+	av_result_t (*add_key)(struct av_hash* self,
+						   const void* key,
+						   void* value);
+
+	/*!
+	* \brief Returns value matching given key of any key type
+	* \param self is a reference to this object
+	* \param key which associated value is requested
+	* \return the value associated to the given \c key
+	*/
+	void* (*get_key)     (struct av_hash* self,
+						  const void* key);
+
+	/*!
+	* \brief Removes key of any key type from table, returning value
+	* \param self is a reference to this object
+	* \param key to be removed
+	* \return the value associated to the given \c key
+	*/
+	void* (*remove_key)  (struct av_hash* self,
+						  const void* key);
+
+	/*!
+	* \brief Computes the hash code of a key, to be cached and passed to the \c *_hashed methods
+	* \param self is a reference to this object
+	* \param key to compute the hash code for
+	* \return the key hash code
+	*/
+	unsigned int (*hash) (struct av_hash* self,
+						  const void* key);
+
+	/*!
+	* \brief Adds key/value pair with hash code precomputed by \c hash
+	* \param self is a reference to this object
+	* \param hash is the \c key hash code
+	* \param key to be added
+	* \param value is a user pointer
+	* \return - AV_OK on success
+	*         - AV_EARG on null or empty string given as a key
+	*         - AV_EMEM on allocation error
+	*/
+	av_result_t (*add_hashed)(struct av_hash* self,
+							  unsigned int hash,
+							  const void* key,
+							  void* value);
+
+	/*!
+	* \brief Returns value matching given key with hash code precomputed by \c hash
+	* \param self is a reference to this object
+	* \param hash is the \c key hash code
+	* \param key which associated value is requested
+	* \return the value associated to the given \c key
+	*/
+	void* (*get_hashed)  (struct av_hash* self,
+						  unsigned int hash,
+						  const void* key);
+
+	/*!
+	* \brief Removes key with hash code precomputed by \c hash, returning value
+	* \param self is a reference to this object
+	* \param hash is the \c key hash code
+	* \param key to be removed
+	* \return the value associated to the given \c key
+	*/
+	void* (*remove_hashed)(struct av_hash* self,
+						   unsigned int hash,
+						   const void* key);
+
 	/*!
 	* \brief Returns hash table size
 	* \param self is a reference to this object
@@ -86,12 +216,29 @@ typedef struct av_hash
 	/*!
 	* \brief Gets next key,value pair from hash
 	* \param self is a reference to this object
-	* \param key output
+	* \param key output, to be casted to the table key type
 	* \param value output
 	* \return AV_TRUE if the returned key,value pair is valid
 	*/
 	av_bool_t (*next)    (struct av_hash* self, const char** key, void** value);
 
+	/*!
+	* \brief Positions iterator before the first element of the hash
+	* \param self is a reference to this object
+	* \param cursor is the iterator to initialize
+	*/
+	void (*cursor_first) (struct av_hash* self, av_hash_cursor_p cursor);
+
+	/*!
+	* \brief Gets next key,value pair from hash advancing the iterator
+	* \param self is a reference to this object
+	* \param cursor is the iterator initialized by \c cursor_first
+	* \param key output, to be casted to the table key type
+	* \param value output
+	* \return AV_TRUE if the returned key,value pair is valid
+	*/
+	av_bool_t (*cursor_next)(struct av_hash* self, av_hash_cursor_p cursor, const void** key, void** value);
+
 	/*!
 	* \brief Destroys this hashtable
 	* \param self is a reference to this object
@@ -100,7 +247,7 @@ typedef struct av_hash
 } av_hash_t, *av_hash_p;
 
 /*!
-* \brief Create new hashtable
+* \brief Create new synchronized hashtable with string keys
 * \param capacity is the estimated hash table capacity
 * \param pphash is the result hashtable
 * \return AV_OK on success
@@ -108,6 +255,17 @@ typedef struct av_hash
 */
 AV_API av_result_t av_hash_create(unsigned int capacity, av_hash_p *pphash);
 
+/*!
+* \brief Create new hashtable
+* \param capacity is the estimated hash table capacity
+* \param keytype is the type of the table keys
+* \param flags is a combination of av_hash_flags_t
+* \param pphash is the result hashtable
+* \return AV_OK on success
+*         AV_EMEM on allocation error
+*/
+AV_API av_result_t av_hash_create_ex(unsigned int capacity, av_hash_key_t keytype, int flags, av_hash_p *pphash);
+
 #ifdef __cplusplus
 }
 #endif
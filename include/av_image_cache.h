@@ -0,0 +1,156 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_image_cache.h                                   */
+/*                                                                   */
+/*********************************************************************/
+
+/*! \file av_image_cache.h
+*   \brief Process wide cache of decoded images
+*
+* Images decoded from files are kept by type, file path and modification
+* time, so screens built again share the already decoded images. The cache
+* holds a reference to every image and hands out new references. Images
+* referenced outside of the cache and pinned images are not evicted, the
+* others are evicted in least recently used order to fit the byte budget.
+* The cached images are shared and must not be modified by their users.
+* All functions are thread safe.
+*/
+
+#ifndef __AV_IMAGE_CACHE_H
+#define __AV_IMAGE_CACHE_H
+
+#include <av.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+* \brief Default image cache budget in bytes
+*/
+#define AV_IMAGE_CACHE_BUDGET (32 * 1024 * 1024)
+
+/*!
+* \brief Image type, decoding and referencing one kind of images
+*/
+typedef struct av_image_type
+{
+	/*! Type name distinguishing the images of the same file decoded by different types */
+	const char* name;
+
+	/*!
+	* \brief Decodes image file
+	* \param param is the parameter given to \c av_image_cache_load
+	* \param filename is the image file path
+	* \param ppimage result image holding one reference
+	* \param pbytes result decoded image size in bytes
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - != AV_OK on failure
+	*/
+	av_result_t (*decode)(void* param, const char* filename, void** ppimage, unsigned int* pbytes);
+
+	/*! Adds reference to image */
+	void (*addref)(void* image);
+
+	/*! Releases reference to image */
+	void (*release)(void* image);
+
+	/*! Tells if the image is referenced beside the cache */
+	av_bool_t (*is_shared)(void* image);
+} av_image_type_t, *av_image_type_p;
+
+/*!
+* \brief image cache statistics
+*/
+typedef struct av_image_cache_stats
+{
+	/*! Loads served from the cache */
+	unsigned int hits;
+
+	/*! Loads decoding the file */
+	unsigned int misses;
+
+	/*! Images evicted to fit the budget */
+	unsigned int evictions;
+
+	/*! Number of cached images */
+	unsigned int count;
+
+	/*! Number of pinned images */
+	unsigned int pinned;
+
+	/*! Decoded bytes kept in the cache */
+	unsigned int resident_bytes;
+
+	/*! Maximum bytes kept, exceeded by images in use or pinned */
+	unsigned int budget;
+
+	/*! Total time spent decoding in microseconds */
+	unsigned long decode_us;
+} av_image_cache_stats_t, *av_image_cache_stats_p;
+
+/*!
+* \brief Creates the process wide image cache
+*
+* Images are loaded without caching before initialization and after finalization.
+* \param budget in bytes, AV_IMAGE_CACHE_BUDGET if 0
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_image_cache_initialize(unsigned int budget);
+
+/*!
+* \brief Destroys the process wide image cache releasing its references
+*/
+AV_API void av_image_cache_finalize(void);
+
+/*!
+* \brief Loads image from file through the cache
+* \param type of the image
+* \param param is passed to the type \c decode
+* \param filename is the image file path
+* \param ppimage result image with reference owned by the caller
+* \return av_result_t
+*         - AV_OK on success
+*         - != AV_OK decoding error
+*/
+AV_API av_result_t av_image_cache_load(av_image_type_p type, void* param, const char* filename, void** ppimage);
+
+/*!
+* \brief Pins or unpins cached image, pinned images are never evicted
+* \param type of the image
+* \param filename is the image file path
+* \param pin AV_TRUE to pin, AV_FALSE to unpin
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EFOUND if the image is not cached
+*/
+AV_API av_result_t av_image_cache_pin(av_image_type_p type, const char* filename, av_bool_t pin);
+
+/*!
+* \brief Changes the image cache budget evicting images if needed
+* \param budget in bytes
+*/
+AV_API void av_image_cache_set_budget(unsigned int budget);
+
+/*!
+* \brief Releases all cached images
+*/
+AV_API void av_image_cache_clear(void);
+
+/*!
+* \brief Returns image cache statistics
+* \param stats is filled with the counters since initialization
+*/
+AV_API void av_image_cache_get_stats(av_image_cache_stats_p stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AV_IMAGE_CACHE_H */
@@ -23,6 +23,9 @@
 extern "C" {
 #endif
 
+/*! Timeout making \c wait_event block until an event arrives */
+#define AV_INPUT_WAIT_FOREVER ((unsigned long)-1)
+
 /* forward reference to system class definition */
 struct av_system;
 /*!
@@ -42,6 +45,19 @@ typedef struct av_input
 	*/
 	av_bool_t (*poll_event)(struct av_input* self, av_event_p event);
 
+	/*!
+	* \brief Waits for the next event
+	*
+	* Blocks the calling thread until an event is available, including events
+	* pushed by other threads with \c push_event, or until the timeout expires.
+	* \param self is a reference to this object
+	* \param event is the result event if method returned AV_TRUE
+	* \param timeout_ms is the maximum time to wait in milliseconds or AV_INPUT_WAIT_FOREVER
+	* \return - AV_TRUE if event is returned
+	*         - AV_FALSE on timeout
+	*/
+	av_bool_t (*wait_event)(struct av_input* self, av_event_p event, unsigned long timeout_ms);
+
 	/*!
 	* \brief Push event into queue
 	* \param self is a reference to this object
@@ -23,6 +23,30 @@ extern "C" {
 /*! list iterator callback prototype */
 typedef av_bool_t (*av_list_iterator_t)(void*, void*);
 
+/*!
+* \brief List item
+*
+* Serves as external list iterator. Unlike the list \b current element,
+* any number of items can be held by nested or concurrent traversals:
+* \code
+* av_list_item_p item;
+* for (item = list->first_item(list); item; item = item->next)
+*     use(item->value);
+* \endcode
+* The fields are read only. An item stays valid until removed from the list.
+*/
+typedef struct av_list_item
+{
+	/*! User defined value */
+	void* value;
+
+	/*! Next item or AV_NULL if this item is the last */
+	struct av_list_item* next;
+
+	/*! Previous item or AV_NULL if this item is the first */
+	struct av_list_item* prev;
+} av_list_item_t, *av_list_item_p;
+
 /*!
 * \brief Class list defining two directional linked list
 *
@@ -130,6 +154,30 @@ typedef struct av_list
 	*/
 	av_result_t (*insert_prev)(struct av_list* self, void* value);
 
+	/*!
+	* \brief Returns the first list item to start external iteration
+	* \param self is a reference to this object
+	* \return the first item or AV_NULL if the list is empty
+	*/
+	av_list_item_p (*first_item)(struct av_list* self);
+
+	/*!
+	* \brief Returns the last list item to start external iteration backwards
+	* \param self is a reference to this object
+	* \return the last item or AV_NULL if the list is empty
+	*/
+	av_list_item_p (*last_item) (struct av_list* self);
+
+	/*!
+	* \brief Removes given item and returns its associated value.
+	* Save \c item->next before the call to continue the iteration.
+	* If the \b current element is the removed item it moves to the next item.
+	* \param self is a reference to this object
+	* \param item to be removed
+	* \return the removed value
+	*/
+	void* (*remove_item)     (struct av_list* self, av_list_item_p item);
+
 	/*! 
 	* \brief Removes the first element from the list and returns its associated value.
 	* The returned value is valid until list is not empty (size > 0),
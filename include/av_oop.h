@@ -77,6 +77,7 @@
 #include <av.h>
 #include <av_hash.h>
 #include <av_list.h>
+#include <av_thread.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -101,6 +102,13 @@ typedef av_result_t(*av_constructor_t)(struct _av_object_t* self);
 */
 typedef void(*av_destructor_t)(struct _av_object_t*);
 
+/*!
+* \brief Defines type for class methods table initializer
+* @param methods is pointing the class methods table, prefilled with the parent class methods.
+*                The initializer sets or overrides the methods implemented by the class
+*/
+typedef void(*av_methods_initializer_t)(void* methods);
+
 /* class descriptor */
 typedef struct _av_class_t
 {
@@ -114,6 +122,11 @@ typedef struct _av_class_t
 	*/
 	char classname[MAX_NAME_SIZE];
 
+	/*!
+	* Class identifier, unique in the OOP container
+	*/
+	int id;
+
 	/*!
 	* Memory size occuppied by the class
 	*/
@@ -133,6 +146,50 @@ typedef struct _av_class_t
 	* Class destructor
 	*/
 	av_destructor_t destructor;
+
+	/*!
+	* Index of the private context slot owned by this class.
+	* Equals the class depth in the inheritance tree (object is 0)
+	*/
+	int context_slot;
+
+	/*!
+	* Methods table shared by all class instances or AV_NULL.
+	* Inherited from the parent class unless the class defines its own methods
+	*/
+	void* methods;
+
+	/*!
+	* Size of the methods table in bytes
+	*/
+	int methodssize;
+
+	/*!
+	* Inheritance chain from the object class to this class, indexed by context slot
+	* which is the class depth. Constructors run along it forward and destructors backward,
+	* \c is_a checks a single entry
+	*/
+	struct _av_class_t** ancestors;
+
+	/*!
+	* Memory size allocated per object including the class contexts
+	*/
+	int objectsize;
+
+	/*!
+	* Released objects memory ready for reuse
+	*/
+	void* freelist;
+
+	/*!
+	* Memory blocks the class objects are allocated from
+	*/
+	av_list_p slabs;
+
+	/*!
+	* Guards \c freelist and \c slabs
+	*/
+	av_mutex_p mutex;
 } av_class_t, *av_class_p;
 
 /*!
@@ -151,12 +208,26 @@ typedef struct _av_object_t
 	av_hash_p attributes;
 
 	/*!
-	* Reference counter
+	* Private class contexts indexed by class context slot.
+	* Allocated with the object, one slot per class in the inheritance chain
+	*/
+	void** contexts;
+
+	/*!
+	* Reference counter, modified atomically
 	*/
 	unsigned int refcnt;
 
+	/*!
+	* Next object in the OOP container deferred destroy list
+	*/
+	struct _av_object_t* next_deferred;
+
 	/*!
     * \brief Tells if this object is instance of or derived from a specified class
+	*
+	* The class name is looked up in the class map on every call, hot paths
+	* use \c O_is_a_named or resolve the class once with \c get_class and use \c O_is_a_class.
 	* \param self is a reference to this object
 	* \param classname a string describing TORBA class
 	* \return AV_TRUE if \c self is instance of or derived from the class \c classname,
@@ -217,13 +288,65 @@ typedef struct _av_object_t
 
 } av_object_t, *av_object_p;
 
-/*! A shortcut to \c context field of an object */
+/*! Shortcuts to string keyed object attributes, for dynamic (e.g. script level) data */
 #define O_attr(o, name)            ((av_object_p)(o))->get_attribute((av_object_p)(o), name)
 #define O_set_attr(o, name, value) ((av_object_p)(o))->set_attribute((av_object_p)(o), name, value)
 
+/*! Gets object private context by class context slot */
+#define O_context_slot(o, slot)        (((av_object_p)(o))->contexts[slot])
+
+/*! Sets object private context by class context slot */
+#define O_set_context_slot(o, slot, value) (((av_object_p)(o))->contexts[slot] = (void*)(value))
+
+/*! Refers the methods table shared by the object class */
+#define O_methods(o)         (((av_object_p)(o))->classref->methods)
+
 /*! A shortcut to \c is_a method of an object */
 #define O_is_a(o, classname) (((av_object_p)(o))->is_a((av_object_p)(o), classname))
 
+/*!
+* Tells if an object is instance of or derived from a class descriptor obtained by \c get_class.
+* Faster alternative of \c O_is_a for hot paths where the class can be resolved once
+*/
+#define O_is_a_class(o, clazz) \
+	(((av_object_p)(o))->classref->context_slot >= (clazz)->context_slot && \
+	 ((av_object_p)(o))->classref->ancestors[(clazz)->context_slot]->id == (clazz)->id)
+
+/*!
+* \brief Class resolved by name once per call site, see \c O_is_a_named
+*/
+typedef struct _av_class_cache_t
+{
+	/*! Generation of the OOP container the class was resolved in, 0 if not resolved yet */
+	unsigned int generation;
+
+	/*! Resolved class, AV_NULL if the name is not registered */
+	av_class_p classref;
+} av_class_cache_t, *av_class_cache_p;
+
+/*! Initializer of the \c av_class_cache_t declared static by the call site */
+#define AV_CLASS_CACHE_INIT { 0, AV_NULL }
+
+/*!
+* \brief Tells if an object is instance of or derived from a named class.
+*
+* The name is resolved on the first call and again only after a new class
+* definition or OOP container, the other calls check the ancestors table.
+* \param self is the object to check
+* \param classname a string describing TORBA class
+* \param cache the call site cache, usually a function local static
+* \return AV_TRUE if \c self is instance of or derived from the class \c classname,
+*         AV_FALSE otherwise
+*/
+AV_API av_bool_t av_object_is_a_named(av_object_p self, const char* classname, av_class_cache_p cache);
+
+/*!
+* Tells if an object is instance of or derived from a class name interned in a call site cache, e.g.
+* \code static av_class_cache_t sprite_class = AV_CLASS_CACHE_INIT;
+* if (O_is_a_named(visible, "sprite", &sprite_class)) \endcode
+*/
+#define O_is_a_named(o, classname, cache) av_object_is_a_named((av_object_p)(o), classname, cache)
+
 /*! A shortcut to \c tostring method of an object */
 #define O_tostring(o, b, c)  ((av_object_p)(o))->tostring((av_object_p)(o), b, c)
 
@@ -236,6 +359,9 @@ typedef struct _av_object_t
 /*! A shortcut to \c release method of an object */
 #define O_release(o)         { ((av_object_p)(o))->release((av_object_p)(o)); }
 
+/*! Releases object reference from any thread, deferring the destroy to the thread calling \c destroy_deferred */
+#define O_release_deferred(o) { O_oop(o)->release_deferred(O_oop(o), (av_object_p)(o)); }
+
 /*! Refers oop from object */
 #define O_oop(o)             ((av_object_p)o)->classref->oop
 
@@ -268,6 +394,12 @@ typedef struct _av_oop_t {
 	/* list of registered service names */
 	av_list_p services;
 
+	/* objects released with zero references waiting to be destroyed */
+	av_object_p deferred;
+
+	/* unique among the containers, renewed by every class definition */
+	unsigned int generation;
+
 	/* destroys oop container */
 	void (*destroy)(struct _av_oop_t* self);
 
@@ -292,6 +424,27 @@ typedef struct _av_oop_t {
 		av_constructor_t constructor,
 		av_destructor_t destructor);
 
+	/*!
+	* \brief Defines methods table shared by all instances of a class.
+	*
+	* The table is allocated once, prefilled with the methods of the parent class and
+	* then passed to \c initializer to set or override the class own methods.
+	* Must be invoked after \c define_class and before any derived class is defined,
+	* otherwise the derived classes keep sharing the parent methods table
+	* \param classname the class name to define methods for
+	* \param methodssize the size of the methods table in bytes, e.g. sizeof(av_foo_methods_t).
+	*                    Must not be less than the parent class methods table size
+	* \param initializer sets the class methods into the table
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EFOUND if the \c classname is not registered
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*define_methods)(struct _av_oop_t* self,
+		const char* classname,
+		int methodssize,
+		av_methods_initializer_t initializer);
+
 	/*!
 	* \brief Creates new object from the given class name.
 	*
@@ -308,6 +461,62 @@ typedef struct _av_oop_t {
 		const char* classname,
 		av_object_p* ppobject);
 
+	/*!
+	* \brief Creates new object from the given class without looking up the class by name
+	* \param classref the class to be instantiated, see \c get_class
+	* \param ppobject the result object of class \c classref
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*new_by_class)(struct _av_oop_t* self,
+		av_class_p classref,
+		av_object_p* ppobject);
+
+	/*!
+	* \brief Gets class descriptor by class name
+	* \param classname the class name
+	* \param pclassref result class descriptor
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EFOUND if the \c classname is not registered
+	*/
+	av_result_t (*get_class)(struct _av_oop_t* self,
+		const char* classname,
+		av_class_p* pclassref);
+
+	/*!
+	* \brief Gets the private context slot index of a class.
+	*
+	* The slot depends only on the class position in the inheritance tree, so it is
+	* the same in all OOP containers and can be cached by the class implementation
+	* \param classname the class name
+	* \param pslot result context slot, usable with \c O_context_slot
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EFOUND if the \c classname is not registered
+	*/
+	av_result_t (*get_context_slot)(struct _av_oop_t* self,
+		const char* classname,
+		int* pslot);
+
+	/*!
+	* \brief Decrements object reference counter without destroying it on the calling thread.
+	*
+	* Safe to call from any thread. When the counter reaches 0 the object is queued
+	* lock free and destroyed on the next \c destroy_deferred call
+	* \param object the object to release
+	*/
+	void (*release_deferred)(struct _av_oop_t* self,
+		av_object_p object);
+
+	/*!
+	* \brief Destroys the objects queued by \c release_deferred.
+	*
+	* Intended to be called periodically from the main loop thread
+	*/
+	void (*destroy_deferred)(struct _av_oop_t* self);
+
 	/*!
 	* \brief Registers new service
 	* \param servicename the service name under which this service will be refered
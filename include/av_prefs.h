@@ -82,12 +82,13 @@ typedef struct av_prefs
 } av_prefs_t, *av_prefs_p;
 
 /*!
-* \brief Registers prefs class into TORBA
+* \brief Registers prefs class into TORBA and the prefs service
+* \param oop is the TORBA container
 * \return av_result_t
 *         - AV_OK on success
 *         - AV_EMEM on out of memory
 */
-AV_API av_result_t av_prefs_register_torba(void);
+AV_API av_result_t av_prefs_register_oop(av_oop_p oop);
 
 #ifdef __cplusplus
 }
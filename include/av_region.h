@@ -0,0 +1,219 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_region.h                                        */
+/*                                                                   */
+/*********************************************************************/
+
+/*! \file av_region.h
+*   \brief av_region definition representing sets of rectangles
+*/
+
+#ifndef __AV_REGION_H
+#define __AV_REGION_H
+
+#include <av.h>
+#include <av_rect.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+* \brief Region defined as a set of disjoint rectangles
+*
+* The rectangles are kept y-x banded in a single memory block: sorted by top
+* then by left position, rectangles in the same band have equal top and height
+* and vertically adjacent bands of equal spans are merged. This makes every
+* area representation unique and lets the set operations walk both regions
+* band by band.
+*
+* Regions are values, declared by the caller and initialized with
+* \c av_region_init or \c AV_REGION_INIT. The storage is kept when a region is
+* cleared or recomputed, so regions reused every frame do not allocate.
+* A region may be both the destination and an operand of an operation.
+* The fields are public for reading only.
+*/
+typedef struct av_region
+{
+	/*! Bounding box of all rectangles, empty for an empty region */
+	av_rect_t extents;
+
+	/*! Banded rectangles */
+	av_rect_p rects;
+
+	/*! Number of rectangles */
+	unsigned int count;
+
+	/*! Number of rectangles the storage can hold, 0 if the storage is not owned */
+	unsigned int capacity;
+} av_region_t, *av_region_p;
+
+/*!
+* \brief Initializer of an empty region
+*/
+#define AV_REGION_INIT { { 0, 0, 0, 0 }, AV_NULL, 0, 0 }
+
+/*!
+* \brief Iterates region rectangles as \c av_rect_p \c it
+*/
+#define av_region_foreach(region, it) \
+	for ((it) = (region)->rects; (it) < (region)->rects + (region)->count; (it)++)
+
+/*!
+* \brief Initializes an empty region
+* \param region to initialize
+*/
+AV_API void av_region_init(av_region_p region);
+
+/*!
+* \brief Frees the region storage, leaving the region empty
+* \param region to free
+*/
+AV_API void av_region_free(av_region_p region);
+
+/*!
+* \brief Empties the region keeping its storage
+* \param region to clear
+*/
+AV_API void av_region_clear(av_region_p region);
+
+/*!
+* \brief Sets the region to a single rectangle
+* \param region to set
+* \param rect to set the region to, empty rectangle empties the region
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_region_set_rect(av_region_p region, av_rect_p rect);
+
+/*!
+* \brief Copies region
+* \param dst destination region
+* \param src source region
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_region_copy(av_region_p dst, av_region_p src);
+
+/*!
+* \brief Computes the union of two regions
+* \param dst result region
+* \param a first region
+* \param b second region
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_region_union(av_region_p dst, av_region_p a, av_region_p b);
+
+/*!
+* \brief Computes the union of region and rectangle
+* \param dst result region
+* \param src source region
+* \param rect rectangle to add
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_region_union_rect(av_region_p dst, av_region_p src, av_rect_p rect);
+
+/*!
+* \brief Computes the intersection of two regions
+* \param dst result region
+* \param a first region
+* \param b second region
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_region_intersect(av_region_p dst, av_region_p a, av_region_p b);
+
+/*!
+* \brief Computes the intersection of region and rectangle
+* \param dst result region
+* \param src source region
+* \param rect clipping rectangle
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_region_intersect_rect(av_region_p dst, av_region_p src, av_rect_p rect);
+
+/*!
+* \brief Computes the area of one region not covered by another
+* \param dst result region
+* \param a region to subtract from
+* \param b subtracted region
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_region_subtract(av_region_p dst, av_region_p a, av_region_p b);
+
+/*!
+* \brief Computes the area of region not covered by rectangle
+* \param dst result region
+* \param src region to subtract from
+* \param rect subtracted rectangle
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_region_subtract_rect(av_region_p dst, av_region_p src, av_rect_p rect);
+
+/*!
+* \brief Moves region
+* \param region to move
+* \param dx offset according x axis
+* \param dy offset according y axis
+*/
+AV_API void av_region_translate(av_region_p region, int dx, int dy);
+
+/*!
+* \brief Tests if region is empty
+* \param region to test
+* \return AV_TRUE if the region has no area
+*/
+AV_API av_bool_t av_region_is_empty(av_region_p region);
+
+/*!
+* \brief Returns the region area in pixels
+* \param region to measure
+*/
+AV_API unsigned long av_region_area(av_region_p region);
+
+/*!
+* \brief Tests if point lies in region
+* \param region to test
+* \param x point x position
+* \param y point y position
+* \return AV_TRUE if the point is inside the region
+*/
+AV_API av_bool_t av_region_contains_point(av_region_p region, int x, int y);
+
+/*!
+* \brief Tests if rectangle lies entirely in region
+* \param region to test
+* \param rect rectangle to test
+* \return AV_TRUE if all the rectangle is covered by the region
+*/
+AV_API av_bool_t av_region_contains_rect(av_region_p region, av_rect_p rect);
+
+/*!
+* \brief Tests if rectangle and region have common area
+* \param region to test
+* \param rect rectangle to test
+* \return AV_TRUE if the rectangle intersects the region
+*/
+AV_API av_bool_t av_region_intersects_rect(av_region_p region, av_rect_p rect);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AV_REGION_H */
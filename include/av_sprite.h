@@ -21,13 +21,15 @@
 extern "C" {
 #endif
 
+struct _av_sprite_t;
+
 /*!
-* \brief Sprite class
+* \brief Sprite methods table shared by all sprites
 */
-typedef struct _av_sprite_t
+typedef struct _av_sprite_methods_t
 {
-	/*! Parent class visible */
-	av_visible_t visible;
+	/*! Parent class visible methods */
+	av_visible_methods_t visible;
 
 	void (*set_size)(struct _av_sprite_t* _self, int frame_width, int frame_height);
 	void (*get_size)(struct _av_sprite_t* _self, int* frame_width, int* frame_height);
@@ -35,6 +37,18 @@ typedef struct _av_sprite_t
 	void (*set_current_frame) (struct _av_sprite_t* _self, int frame);
 	int  (*get_current_frame) (struct _av_sprite_t* _self);
 	void (*set_sequence)(struct _av_sprite_t* _self, int* sequence, int count, unsigned long duration, av_bool_t is_loop);
+} av_sprite_methods_t, *av_sprite_methods_p;
+
+/*!
+* \brief Sprite class
+*/
+typedef struct _av_sprite_t
+{
+	/*! Parent class visible */
+	av_visible_t visible;
+
+	/*! Sprite methods shared by the class instances */
+	av_sprite_methods_p methods;
 } av_sprite_t, *av_sprite_p;
 
 /*!
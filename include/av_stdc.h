@@ -25,6 +25,7 @@
 
 #define av_malloc malloc
 #define av_calloc calloc
+#define av_realloc realloc
 #define av_free free
 
 AV_API int av_strlen(const char* str);
@@ -34,5 +35,6 @@ AV_API int av_strcmp(const char* str1, const char* str2);
 AV_API int av_strcasecmp(const char* str1, const char* str2);
 AV_API char* av_strdup(const char* str);
 AV_API void av_memset(void* dst, unsigned char val, int size);
+AV_API void av_memmove(void* dst, const void* src, int size);
 
 #endif /* __AV_STDC_H */
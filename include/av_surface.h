@@ -72,6 +72,24 @@ typedef struct av_surface
 								av_pixel_p* ppixels,
 								int* ppitch);
 
+	/*!
+	* \brief Locks part of the surface for writing
+	*
+	* The content of the locked part is undefined and must be entirely rewritten.
+	* \param self is a reference to this object
+	* \param rect is the part of the surface to lock
+	* \param ppixels result pointer to the top left pixel of the locked part
+	* \param ppitch result surface pitch
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_ESUPPORTED if the surface can be locked only as whole
+	*         - != AV_OK on failure
+	*/
+	av_result_t (*lock_rect)   (struct av_surface* self,
+								av_rect_p rect,
+								av_pixel_p* ppixels,
+								int* ppitch);
+
 	/*!
 	* \brief Unlocks locked surface
 	* \param self is a reference to this object
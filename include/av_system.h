@@ -22,11 +22,96 @@
 #include <av_bitmap.h>
 #include <av_surface.h>
 #include <av_visible.h>
+#include <av_thread.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*!
+* \brief Main loop modes
+*/
+typedef enum
+{
+	/*! Polls for events, sleeping between the steps */
+	AV_LOOP_MODE_POLL,
+
+	/*! Blocks until an event arrives or the nearest tick deadline expires */
+	AV_LOOP_MODE_WAIT
+} av_loop_mode_t;
+
+/*!
+* \brief Input event statistics
+*/
+typedef struct _av_event_stats_t
+{
+	/*! Events taken from the input queue during the last step */
+	unsigned int received;
+
+	/*! Events processed after coalescing during the last step */
+	unsigned int dispatched;
+
+	/*! Mouse motions merged into a following motion during the last step */
+	unsigned int coalesced;
+
+	/*! Number of processed steps */
+	unsigned long steps;
+
+	/*! Totals over all steps */
+	unsigned long total_received;
+	unsigned long total_dispatched;
+	unsigned long total_coalesced;
+} av_event_stats_t, *av_event_stats_p;
+
+/*!
+* \brief Dirty rects statistics
+*
+* Invalidated rects are merged before compositing, the difference between
+* \c requested_pixels and \c painted_pixels is the area saved by merging.
+* The damage is further reduced per visible by the opaque visibles above it.
+*/
+typedef struct _av_dirty_stats_t
+{
+	/*! Number of invalidated rects */
+	unsigned long requested_rects;
+
+	/*! Sum of invalidated rects area clipped to the screen */
+	unsigned long requested_pixels;
+
+	/*! Number of rects composited after merging */
+	unsigned long painted_rects;
+
+	/*! Area composited after merging */
+	unsigned long painted_pixels;
+
+	/*! Number of times the rects have been replaced by their bounding box */
+	unsigned long fallbacks;
+
+	/*! Number of surface render calls issued */
+	unsigned long blits;
+
+	/*! Damaged area of visibles hidden by opaque visibles above them */
+	unsigned long culled_pixels;
+
+	/*! Number of times a damaged visible has been entirely hidden */
+	unsigned long culled_visibles;
+
+	/*! Number of presented frames */
+	unsigned long frames;
+
+	/*! Number of steps without damage where compositing and presenting were skipped */
+	unsigned long skipped_frames;
+} av_dirty_stats_t, *av_dirty_stats_p;
+
+/*!
+* \brief Called on the main loop when an asynchronous surface load completes
+* \param arg given to \c load_surface_async
+* \param visible which requested the load
+* \param surface the loaded surface owned by the callee, AV_NULL on failure
+* \param rc is the load result
+*/
+typedef void (*av_surface_loaded_t)(void* arg, av_visible_p visible, av_surface_p surface, av_result_t rc);
+
 /*!
 * \brief system interface
 *
@@ -54,9 +139,12 @@ typedef struct _av_system_t
 	av_timer_p timer;
 
 	/*!
-	* \brief Process one system event
+	* \brief Processes the pending system events and renders a frame
+	*
+	* All queued input is handled before rendering, consecutive mouse motions
+	* are collapsed into the last one.
 	* \param self is a reference to this object
-	* \return - AV_FALSE is the last processed event has been AV_EVENT_QUIT
+	* \return - AV_FALSE if AV_EVENT_QUIT has been processed
 	*         - AV_TRUE otherwise
 	*/
 	av_bool_t (*step)             (struct _av_system_t* self);
@@ -69,7 +157,82 @@ typedef struct _av_system_t
 	*/
 	void (*loop)                  (struct _av_system_t* self);
 
+	/*!
+	* \brief Sets how the main loop waits for events
+	* \param self is a reference to this object
+	* \param mode is AV_LOOP_MODE_POLL (default) or AV_LOOP_MODE_WAIT
+	*/
+	void (*set_loop_mode)         (struct _av_system_t* self, av_loop_mode_t mode);
+
+	/*!
+	* \brief Requests the visibles to be ticked not later than a given time
+	*
+	* Tick handlers driving animations call this for their next frame, otherwise
+	* the loop in AV_LOOP_MODE_WAIT sleeps until the next event. Requests are
+	* cleared before each tick, the earliest one is kept.
+	* \param self is a reference to this object
+	* \param time_ms is the absolute time as returned by \c timer->now
+	*/
+	void (*request_tick)          (struct _av_system_t* self, unsigned long time_ms);
+
+	/*!
+	* \brief Subscribes visible to have its \c on_tick called on every step
+	*
+	* Only subscribed visibles are ticked, so the cost of a step depends on the
+	* number of animating visibles rather than on the tree size. Hidden visibles
+	* are not ticked. Subscribing a subscribed visible does nothing.
+	* \param self is a reference to this object
+	* \param visible to subscribe
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*subscribe_tick) (struct _av_system_t* self, av_visible_p visible);
+
+	/*!
+	* \brief Unsubscribes visible from ticks, may be called from tick handlers
+	* \param self is a reference to this object
+	* \param visible to unsubscribe
+	*/
+	void (*unsubscribe_tick)      (struct _av_system_t* self, av_visible_p visible);
+
+	/*!
+	* \brief Returns input event statistics
+	* \param self is a reference to this object
+	* \param stats is filled with the counters of the last step and the totals
+	*/
+	void (*get_event_stats)       (struct _av_system_t* self, av_event_stats_p stats);
+
+	/*!
+	* \brief Returns dirty rects statistics
+	* \param self is a reference to this object
+	* \param stats is filled with the counters since start
+	*/
+	void (*get_dirty_stats)       (struct _av_system_t* self, av_dirty_stats_p stats);
+
+	/*!
+	* \brief Presents the next frame even if nothing has been invalidated
+	*
+	* Steps without damage skip compositing and presenting the display,
+	* use this when the screen content has changed outside the visibles.
+	* \param self is a reference to this object
+	*/
+	void (*force_present)         (struct _av_system_t* self);
+
+	/*!
+	* \brief Invalidates rectangle to be composited on the next step
+	*
+	* Overlapping and nested rects are merged into a set of disjoint rects.
+	* \param self is a reference to this object
+	* \param rect in absolute coordinates or AV_NULL for the whole screen
+	*/
 	av_result_t(*invalidate_rect)  (struct _av_system_t* self, av_rect_p rect);
+
+	/*!
+	* \brief Invalidates list of rectangles
+	* \param self is a reference to this object
+	* \param rects list of av_rect_p, copied so the list remains owned by the caller
+	*/
 	av_result_t(*invalidate_rects) (struct _av_system_t* self, av_list_p rects);
 	av_visible_p (*get_root_visible) (struct _av_system_t* self);
 	void  (*set_root_visible) (struct _av_system_t* self, av_visible_p root);
@@ -84,6 +247,87 @@ typedef struct _av_system_t
 
 	av_result_t (*initialize)            (struct _av_system_t* self, av_display_config_p pdc);
 
+	/*!
+	* \brief Returns the task pool shared by the application
+	*
+	* The pool is created on first use with the number of workers given by
+	* the \c system.task_pool.workers preference, 0 meaning one per CPU.
+	* The preference is read from the prefs files loaded by \c avgl_create or
+	* set on the prefs service before the first call.
+	* The pool is owned by the system and destroyed with it.
+	* \param self is a reference to this object
+	* \param pppool result task pool
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*get_task_pool)  (struct _av_system_t* self, av_task_pool_p* pppool);
+
+	/*!
+	* \brief Loads bitmap from file through the image cache
+	*
+	* The cached bitmaps are shared and must not be modified.
+	* May be called from any thread.
+	* \param self is a reference to this object
+	* \param filename is the image file path
+	* \param ppbitmap result bitmap with reference owned by the caller
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - != AV_OK decoding error
+	*/
+	av_result_t (*load_bitmap)    (struct _av_system_t* self, const char* filename, av_bitmap_p* ppbitmap);
+
+	/*!
+	* \brief Loads surface from file through the image cache
+	* \param self is a reference to this object
+	* \param filename is the image file path
+	* \param ppsurface result surface owned by the caller
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - != AV_OK on failure
+	*/
+	av_result_t (*load_surface)   (struct _av_system_t* self, const char* filename, av_surface_p* ppsurface);
+
+	/*!
+	* \brief Loads surface from file without blocking the main loop
+	*
+	* The image is decoded by the task pool, the surface is created on the main
+	* loop and passed to \c on_loaded, or set to the visible if \c on_loaded is
+	* AV_NULL. The load is cancelled when the visible is destroyed.
+	* On success the placeholder is owned by the visible, which destroys it once
+	* another surface is set, so it must not be shared. On failure the caller
+	* keeps it.
+	* \param self is a reference to this object
+	* \param visible requesting the load
+	* \param filename is the image file path
+	* \param placeholder is set to the visible until the load completes, may be AV_NULL
+	* \param on_loaded is called on completion unless cancelled, may be AV_NULL
+	* \param arg is passed to \c on_loaded
+	* \param pid result load id for \c cancel_load, may be AV_NULL
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*load_surface_async)(struct _av_system_t* self, av_visible_p visible, const char* filename,
+									  av_surface_p placeholder, av_surface_loaded_t on_loaded, void* arg,
+									  unsigned int* pid);
+
+	/*!
+	* \brief Cancels asynchronous load, its callback is not called
+	* \param self is a reference to this object
+	* \param id of the load, ignored if already completed
+	*/
+	void (*cancel_load)           (struct _av_system_t* self, unsigned int id);
+
+	/*!
+	* \brief Cancels the asynchronous loads of visible
+	*
+	* With AV_NULL visible cancels all loads and waits for the workers decoding them.
+	* \param self is a reference to this object
+	* \param visible whose loads to cancel, AV_NULL for all
+	*/
+	void (*cancel_loads)          (struct _av_system_t* self, av_visible_p visible);
+
 } av_system_t, *av_system_p;
 
 /*!
@@ -21,6 +21,53 @@
 extern "C" {
 #endif
 
+/*!
+* \brief Atomic operations on plain integer and pointer variables.
+*
+* Follow the C11 memory model. Counters are incremented relaxed and decremented
+* with acquire/release ordering, so the thread dropping the last reference observes
+* all writes made by the others. Without AV_MT they degrade to plain operations
+*/
+#if defined(AV_MT) && (defined(__GNUC__) || defined(__clang__))
+#  define av_atomic_inc(p)             __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+#  define av_atomic_dec(p)             __atomic_sub_fetch((p), 1, __ATOMIC_ACQ_REL)
+#  define av_atomic_load(p)            __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#  define av_atomic_store(p, v)        __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#  define av_atomic_exchange(p, v)     __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#  define av_atomic_cas(p, pexp, v)    __atomic_compare_exchange_n((p), (pexp), (v), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#  define av_atomic_fence()            __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(AV_MT) && defined(_MSC_VER)
+#  include <intrin.h>
+#  define av_atomic_inc(p)             ((unsigned int)_InterlockedIncrement((volatile long*)(p)))
+#  define av_atomic_dec(p)             ((unsigned int)_InterlockedDecrement((volatile long*)(p)))
+#  define av_atomic_load(p)            (_ReadWriteBarrier(), *(p))
+#  define av_atomic_store(p, v)        (_ReadWriteBarrier(), *(p) = (v))
+#  define av_atomic_exchange(p, v)     _InterlockedExchangePointer((void* volatile*)(p), (v))
+#  define av_atomic_cas(p, pexp, v)    av_atomic_cas_msvc((void* volatile*)(p), (void**)(pexp), (v))
+#  define av_atomic_fence()            _mm_mfence()
+static __inline int av_atomic_cas_msvc(void* volatile* p, void** pexp, void* v)
+{
+	void* prev = _InterlockedCompareExchangePointer(p, v, *pexp);
+	if (prev == *pexp) return 1;
+	*pexp = prev;
+	return 0;
+}
+#else
+#  define av_atomic_inc(p)             (++(*(p)))
+#  define av_atomic_dec(p)             (--(*(p)))
+#  define av_atomic_load(p)            (*(p))
+#  define av_atomic_store(p, v)        (*(p) = (v))
+#  define av_atomic_exchange(p, v)     av_atomic_exchange_plain((void**)(p), (v))
+#  define av_atomic_cas(p, pexp, v)    (*(p) == *(pexp) ? (*(p) = (v), 1) : (*(pexp) = *(p), 0))
+#  define av_atomic_fence()
+static __inline void* av_atomic_exchange_plain(void** p, void* v)
+{
+	void* prev = *p;
+	*p = v;
+	return prev;
+}
+#endif
+
 /*! 
 * \brief mutex type
 *
@@ -395,6 +442,197 @@ typedef struct av_sync_queue
 */
 AV_API av_result_t av_sync_queue_create(int elements_max, av_sync_queue_p* ppqueue);
 
+/*! Assumed CPU cache line size used to keep data written by different threads apart */
+#define AV_CACHE_LINE_SIZE 64
+
+/*!
+* \brief bounded single producer, single consumer queue
+*
+* Ring buffer of pointers which can be used in place of av_sync_queue when
+* exactly one thread pushes and exactly one thread pops, e.g. a decoder
+* thread feeding the audio callback.
+* The methods \c try_push and \c try_pop never block and never lock,
+* they are safe to call from realtime threads.
+* The methods \c push and \c pop block while the queue is full or empty.
+* Blocked threads are woken by the opposite side or wake up periodically.
+*/
+typedef struct av_spsc_queue
+{
+	/*! Ring buffer storage */
+	void** elements;
+
+	/*! Ring buffer size, power of two */
+	unsigned int capacity;
+
+	/*! Maximum number of queued elements */
+	unsigned int elements_max;
+
+	/*! Number of popped elements, written by the consumer only */
+	unsigned int head;
+	unsigned char head_pad[AV_CACHE_LINE_SIZE - sizeof(unsigned int)];
+
+	/*! Number of pushed elements, written by the producer only */
+	unsigned int tail;
+	unsigned char tail_pad[AV_CACHE_LINE_SIZE - sizeof(unsigned int)];
+
+	/*! Number of threads blocked in \c push or \c pop */
+	unsigned int waiting;
+	av_bool_t is_abort;
+	av_mutex_p mutex;
+	av_condition_p condition;
+
+	/*!
+	* \brief Returns the number of queued elements
+	* \param self is a reference to this object
+	* \return number of elements
+	*/
+	unsigned int (*size)    (struct av_spsc_queue* self);
+
+	/*!
+	* \brief Adds element without blocking. Called by the producer thread only
+	* \param self is a reference to this object
+	* \param element to add
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EAGAIN if the queue is full
+	*         - AV_EINTERRUPT if the queue is aborted
+	*/
+	av_result_t (*try_push) (struct av_spsc_queue* self, void* element);
+
+	/*!
+	* \brief Removes element without blocking. Called by the consumer thread only
+	* \param self is a reference to this object
+	* \param ppelement returns the removed element
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EAGAIN if the queue is empty
+	*         - AV_EINTERRUPT if the queue is aborted
+	*/
+	av_result_t (*try_pop)  (struct av_spsc_queue* self, void** ppelement);
+
+	/*!
+	* \brief Adds element waiting while the queue is full. Called by the producer thread only
+	* \param self is a reference to this object
+	* \param element to add
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EINTERRUPT if the queue is aborted
+	*/
+	av_result_t (*push)     (struct av_spsc_queue* self, void* element);
+
+	/*!
+	* \brief Removes element waiting while the queue is empty. Called by the consumer thread only
+	* \param self is a reference to this object
+	* \param ppelement returns the removed element
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EINTERRUPT if the queue is aborted
+	*/
+	av_result_t (*pop)      (struct av_spsc_queue* self, void** ppelement);
+
+	/*!
+	* \brief Aborts the queue waking up the blocked threads
+	* \param self is a reference to this object
+	*/
+	void        (*abort)    (struct av_spsc_queue* self);
+
+	/*!
+	* \brief Destroys the queue. The queued elements are not freed
+	* \param self is a reference to this object
+	*/
+	void        (*destroy)  (void*);
+} av_spsc_queue_t, *av_spsc_queue_p;
+
+/*!
+* \brief Creates new single producer, single consumer queue
+* \param elements_max is the maximum number of queued elements
+* \param ppqueue returns the new queue
+* \return av_result_t
+*         - AV_OK on success
+*         - != AV_OK on failure
+*/
+AV_API av_result_t av_spsc_queue_create(unsigned int elements_max, av_spsc_queue_p* ppqueue);
+
+/*! task routine executed by av_task_pool */
+typedef void (*av_task_t)(void* arg);
+
+/*!
+* \brief group of tasks waited together
+*
+* Zero initialized by the caller, e.g. av_task_group_t group = AV_TASK_GROUP_INIT;
+* and passed to \c submit for each task of the group
+*/
+typedef struct av_task_group
+{
+	/*! Number of submitted and not yet completed tasks */
+	unsigned int pending;
+} av_task_group_t, *av_task_group_p;
+
+#define AV_TASK_GROUP_INIT { 0 }
+
+/*!
+* \brief pool of worker threads executing short tasks
+*
+* Each worker owns a deque of tasks. Tasks submitted by a worker are pushed to
+* its own deque and executed most recent first, idle workers steal the oldest
+* tasks from the other deques. Tasks submitted by other threads are
+* distributed between the workers.
+* A thread waiting for a task group executes queued tasks meanwhile,
+* so tasks may wait for groups of subtasks.
+*/
+typedef struct av_task_pool
+{
+	/*! Implementation specific */
+	void* context;
+
+	/*!
+	* \brief Queues task for execution
+	* \param self is a reference to this object
+	* \param group the task is counted in, may be AV_NULL
+	* \param task routine to execute
+	* \param arg is passed to the task routine
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*submit)       (struct av_task_pool* self, av_task_group_p group, av_task_t task, void* arg);
+
+	/*!
+	* \brief Waits until all tasks of the group are completed
+	* \param self is a reference to this object
+	* \param group to wait for
+	*/
+	void (*wait)                (struct av_task_pool* self, av_task_group_p group);
+
+	/*!
+	* \brief Returns the number of worker threads
+	* \param self is a reference to this object
+	* \return number of workers, 0 if tasks are executed by \c submit
+	*/
+	unsigned int (*get_workers) (struct av_task_pool* self);
+
+	/*!
+	* \brief Completes the queued tasks, stops the workers and destroys the pool
+	* \param self is a reference to this object
+	*/
+	void (*destroy)             (struct av_task_pool* self);
+} av_task_pool_t, *av_task_pool_p;
+
+/*!
+* \brief Returns the number of online processors
+*/
+AV_API unsigned int av_cpu_count(void);
+
+/*!
+* \brief Creates new task pool
+* \param workers is the number of worker threads, 0 for one per processor
+* \param pppool returns the new task pool
+* \return av_result_t
+*         - AV_OK on success
+*         - != AV_OK on failure
+*/
+AV_API av_result_t av_task_pool_create(unsigned int workers, av_task_pool_p* pppool);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,171 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_vector.h                                        */
+/*                                                                   */
+/*********************************************************************/
+
+/*! \file av_vector.h
+*   \brief av_vector definition representing contiguous dynamic arrays
+*/
+
+#ifndef __AV_VECTOR_H
+#define __AV_VECTOR_H
+
+#include <av.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+* \brief Returns vector element at index \c i as a value of \c type
+*/
+#define av_vector_at(v, type, i) (((type*)(v)->data)[(i)])
+
+/*!
+* \brief Returns iterator pointing the first vector element as pointer to \c type
+*/
+#define av_vector_begin(v, type) ((type*)(v)->data)
+
+/*!
+* \brief Returns iterator pointing past the last vector element as pointer to \c type
+*/
+#define av_vector_end(v, type) ((type*)(v)->data + (v)->size)
+
+/*!
+* \brief Iterates vector elements from the first to the last
+*
+* \c it is a pointer to \c type defined by the caller.
+* The iteration state lives in \c it only, so the same vector can be
+* traversed by nested loops or by several threads at once.
+* The vector must not be modified during the iteration.
+*/
+#define av_vector_foreach(v, type, it) \
+	for ((it) = av_vector_begin(v, type); (it) < av_vector_end(v, type); (it)++)
+
+/*!
+* \brief Iterates vector elements from the last to the first
+*/
+#define av_vector_foreach_reverse(v, type, it) \
+	for ((it) = av_vector_end(v, type); (it)-- > av_vector_begin(v, type);)
+
+/*!
+* \brief Class vector defining growable array of fixed size elements
+*
+* The elements are stored by value in a single memory block, so iterating them
+* reads memory sequentially instead of following pointers between list nodes.
+* Elements are copied in and out of the vector, their size is given on creation.
+* Vector of pointers is created with element size sizeof(void*).
+*
+* The fields \c data and \c size are public for reading. Elements are accessed
+* with \c av_vector_at or iterated with \c av_vector_foreach.
+* Any vector modification may move the elements, invalidating pointers to them.
+*/
+typedef struct av_vector
+{
+	/*! Elements storage */
+	void* data;
+
+	/*! Number of elements */
+	unsigned int size;
+
+	/*! Number of elements the storage can hold without reallocation */
+	unsigned int capacity;
+
+	/*! Element size in bytes */
+	unsigned int elemsize;
+
+	/*!
+	* \brief Adds element after the last vector element
+	*
+	* \param self is a reference to this object
+	* \param elem points the element value to copy
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*push_last)(struct av_vector* self, const void* elem);
+
+	/*!
+	* \brief Inserts element at given index, shifting the following elements
+	*
+	* \param self is a reference to this object
+	* \param index of the new element, between 0 and \c size
+	* \param elem points the element value to copy
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EARG index is out of range
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*insert)   (struct av_vector* self, unsigned int index, const void* elem);
+
+	/*!
+	* \brief Removes the last element
+	*
+	* \param self is a reference to this object
+	* \param elem if not AV_NULL receives copy of the removed element
+	* \return AV_TRUE if an element has been removed, AV_FALSE if the vector is empty
+	*/
+	av_bool_t (*pop_last)   (struct av_vector* self, void* elem);
+
+	/*!
+	* \brief Removes element at given index, shifting the following elements
+	*
+	* \param self is a reference to this object
+	* \param index of the element to remove
+	*/
+	void (*remove)          (struct av_vector* self, unsigned int index);
+
+	/*!
+	* \brief Removes all elements keeping the allocated storage
+	*
+	* \param self is a reference to this object
+	*/
+	void (*remove_all)      (struct av_vector* self);
+
+	/*!
+	* \brief Finds element equal to the given one
+	*
+	* \param self is a reference to this object
+	* \param elem points the element value to search for
+	* \return the index of the first equal element or -1 if not found
+	*/
+	int (*index_of)         (struct av_vector* self, const void* elem);
+
+	/*!
+	* \brief Ensures the storage can hold given number of elements
+	*
+	* \param self is a reference to this object
+	* \param capacity is the requested number of elements
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*reserve)  (struct av_vector* self, unsigned int capacity);
+
+	/*!
+	* \brief Destroys this vector
+	*
+	* \param self is a reference to this object
+	*/
+	void (*destroy)         (struct av_vector* self);
+} av_vector_t, *av_vector_p;
+
+/*!
+* \brief Creates new vector
+* \param elemsize is the size of each vector element in bytes
+* \param ppvector result vector object
+* \return av_result_t
+*         - AV_OK on success
+*         - AV_EMEM on out of memory
+*/
+AV_API av_result_t av_vector_create(unsigned int elemsize, av_vector_p* ppvector);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AV_VECTOR_H */
@@ -15,6 +15,7 @@
 #define __AV_VISIBLE_H
 
 #include <av_oop.h>
+#include <av_region.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +33,58 @@ struct _av_visible_t;
 typedef void(*on_draw_t)(struct _av_visible_t* self, av_graphics_p graphics);
 typedef void(*on_destroy_t)(struct _av_visible_t* self);
 
+/*!
+* \brief Visible methods table.
+*
+* Built once on visible class registration and shared by all visibles of the same class.
+* Derived classes override methods via \c define_methods in av_oop
+*/
+typedef struct _av_visible_methods_t
+{
+	/*! Parent class window methods */
+	av_window_methods_t window;
+
+	av_result_t (*draw)   (struct _av_visible_t* self);
+	void (*render)        (struct _av_visible_t* self, av_rect_p src_rect, av_rect_p dst_rect);
+	void (*set_surface)   (struct _av_visible_t* self, av_surface_p surface);
+	av_result_t           (*create_child) (struct _av_visible_t* self, const char* classname, struct _av_visible_t **pvisible);
+
+	/*!
+	* \brief Declares the whole visible opaque
+	*
+	* The compositor skips the parts of the visibles below an opaque visible.
+	* \param self is a reference to this object
+	* \param opaque AV_TRUE if the visible pixels are all opaque, AV_FALSE also clears the opaque rects
+	*/
+	void (*set_opaque)            (struct _av_visible_t* self, av_bool_t opaque);
+
+	/*!
+	* \brief Declares part of the visible opaque
+	* \param self is a reference to this object
+	* \param rect is the opaque part in visible coordinates
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*add_opaque_rect)(struct _av_visible_t* self, av_rect_p rect);
+
+	/*!
+	* \brief Invalidates part of the visible
+	*
+	* The damage of owner drawn visibles is accumulated and repainted before
+	* the next composition by \c draw, which then repaints the backing surface
+	* clipped to the damaged part and uploads only that part to the surface.
+	* \c on_draw finds the repainted part in \c draw_rect and may skip drawing
+	* outside of it.
+	* \param self is a reference to this object
+	* \param rect in visible coordinates, AV_NULL for the whole visible
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*invalidate_rect)(struct _av_visible_t* self, av_rect_p rect);
+} av_visible_methods_t, *av_visible_methods_p;
+
 typedef struct _av_visible_t
 {
 	av_window_t window;
@@ -40,13 +93,28 @@ typedef struct _av_visible_t
 	av_surface_p surface;
 	av_bool_t is_owner_draw;
 
-	av_result_t (*draw)   (struct _av_visible_t* self);
-	void (*render)        (struct _av_visible_t* self, av_rect_p src_rect, av_rect_p dst_rect);
+	/*! Set if the visible covers its whole rect with opaque pixels, see \c set_opaque */
+	av_bool_t is_opaque;
+
+	/*! Opaque parts of the visible in visible coordinates, see \c add_opaque_rect */
+	av_region_t opaque_region;
+
+	/*! Damage to repaint by the next \c draw in visible coordinates, see \c invalidate_rect */
+	av_region_t draw_region;
+
+	/*! Part of the visible being repainted by \c on_draw in visible coordinates */
+	av_rect_t draw_rect;
+
+	/*! Owner drawn content kept between draws, uploaded to \c surface on damage */
+	av_graphics_surface_p backing_surface;
+
+	/*! Visible methods shared by the class instances */
+	av_visible_methods_p methods;
+
+	/*! Called on every step while subscribed with \c system->subscribe_tick */
 	void (*on_tick)       (struct _av_visible_t* self);
 	void (*on_draw)       (struct _av_visible_t* self, av_graphics_p graphics);
 	void (*on_destroy)    (struct _av_visible_t* self);
-	void (*set_surface)   (struct _av_visible_t* self, av_surface_p surface);
-	av_result_t           (*create_child) (struct _av_visible_t* self, const char* classname, struct _av_visible_t **pvisible);
 
 } av_visible_t, *av_visible_p;
 
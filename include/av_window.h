@@ -19,6 +19,7 @@
 #include <av_oop.h>
 #include <av_graphics.h>
 #include <av_display.h>
+#include <av_vector.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,54 +31,16 @@ typedef enum
 	AV_UPDATE_REPAINT
 } av_window_update_t;
 
-/*! \brief Definition of a window object as a part of tree of windows objects.
+struct av_window;
+
+/*!
+* \brief Window methods table.
 *
-*	A window may have a parent window to which it is attached. A window without a parent is a root window.
-*	All windows represents a rectangular areas which can overlap to each other.
-*	The windows have a z-order as they appear on the screen which by default is their creation order.
-*	The newer windows are on top of the olders. The z-order of a window can be changed via the methods
-*	\c raise_top, \c lower_bottom. A part of area occuppied by a window can be \b invalidated caused
-*	by the usage any of the following methods: \c set_window_rect, \c invalidate, \c invalidate_rect
-*	executed against a certain window. Once an area is invalidated it is registered to the system object
-*	which will make it valid when the \c av_system method \c update is invoked. The method \c update
-*	is implicitly invoked on each processed event.
-*	On \c update the windows tree is recursively tested for intersection with an invalidated region
-*	starting from bottom to top according their z-order.
-*	Once intersection is detected to a window then the method \c on_paint is executed with parameter
-*	a graphics object where the window can draw its content.
+* Built once on window class registration and shared by all windows of the same class.
+* Derived classes override methods via \c define_methods in av_oop
 */
-typedef struct av_window
+typedef struct av_window_methods
 {
-	/*! Parent class object */
-	av_object_t object;
-
-	/*! Origin X */
-	int origin_x;
-
-	/*! Origin Y */
-	int origin_y;
-
-	/*! Delay in millisecs before mouse enter event to be sent to this window  */
-	unsigned long hover_delay;
-	
-	/*! Window cursor shape */
-	av_display_cursor_shape_t cursor;
-
-	/*! Window cursor visitibility status */
-	av_bool_t cursor_visible;
-
-	/*! Are events bubbled */
-	av_bool_t bubble_events;
-	
-	/*! Are events handled */
-	av_bool_t handle_events;
-
-	/*!
-	* \brief Dispatcher object
-	* used to hook and pre-filter events
-	*/
-	av_object_p dispatcher;
-
 	/*!
 	* \brief Set a parent to the window
 	* \param self is a reference to this object
@@ -105,7 +68,12 @@ typedef struct av_window
 	*/
 	struct av_window* (*get_parent)    (struct av_window* self);
 
-	av_list_p (*get_children)          (struct av_window* self);
+	/*!
+	* \brief Returns the children of this window ordered from bottom to top
+	* \param self is a reference to this object
+	* \return vector of av_window_p, to be iterated with \c av_vector_foreach
+	*/
+	av_vector_p (*get_children)        (struct av_window* self);
 
 	/*!
 	* \brief Adds a window as a child to this window on top of the other window's children
@@ -185,6 +153,14 @@ typedef struct av_window
 	*/
 	void(*get_absolute_rect)          (struct av_window* self, av_rect_p rect);
 
+	/*!
+	* \brief Returns the window rectangle in absolute coordinates clipped by the parents
+	* clipping their children
+	* \param self is a reference to this object
+	* \return the visible part of the window rectangle, empty if entirely clipped
+	*/
+	void(*get_clip_rect)              (struct av_window* self, av_rect_p rect);
+
 	/*!
 	* \brief Converts a given rect in absolute coordinates according the root window from the tree
 	* the target window belongs to. The specified rect is assumed to be given according the
@@ -194,6 +170,12 @@ typedef struct av_window
 	*/
 	void (*rect_absolute)              (struct av_window* self, av_rect_p rect);
 	
+	/*!
+	* \brief Tests if absolute point is inside the window clip rect and inside all its parents
+	* \param self is a reference to this object
+	* \param x absolute point x position
+	* \param y absolute point y position
+	*/
 	av_bool_t (*point_inside)          (struct av_window* self, int x, int y);
 
 	/*!
@@ -240,6 +222,35 @@ typedef struct av_window
 	*/
 	struct av_window* (*get_child_xy)  (struct av_window* self, int x, int y);
 
+	/*!
+	* \brief Enables spatial index of the children
+	*
+	* Indexed children are found by \c get_child_xy and \c get_children_in_rect
+	* without testing all of them, which pays off for windows with many children
+	* like grids of tiles.
+	* \param self is a reference to this object
+	* \param indexed AV_TRUE to create the index, AV_FALSE to drop it
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*set_children_index)  (struct av_window* self, av_bool_t indexed);
+
+	/*!
+	* \brief Appends the children which or whose descendants may intersect a rectangle
+	*
+	* The children are appended from the bottom to the top. Without children index
+	* all children are appended, children not clipping their own children are
+	* always appended.
+	* \param self is a reference to this object
+	* \param rect in absolute coordinates
+	* \param children vector of av_window_p receiving the children
+	* \return av_result_t
+	*         - AV_OK on success
+	*         - AV_EMEM on out of memory
+	*/
+	av_result_t (*get_children_in_rect)(struct av_window* self, av_rect_p rect, av_vector_p children);
+
 	void (*move)                       (struct av_window* self, int x, int y);
 
 	void (*set_cursor)                 (struct av_window* self, av_display_cursor_shape_t cursor);
@@ -253,6 +264,64 @@ typedef struct av_window
 	void (*set_handle_events)          (struct av_window* self, av_bool_t handle_events);
 	av_bool_t (*is_handle_events)      (struct av_window* self);
 
+	/*!
+	* \brief Invalidate this window area
+	* \param self is a reference to this object
+	*/
+	void (*invalidate)                (struct av_window* self);
+} av_window_methods_t, *av_window_methods_p;
+
+/*! \brief Definition of a window object as a part of tree of windows objects.
+*
+*	A window may have a parent window to which it is attached. A window without a parent is a root window.
+*	All windows represents a rectangular areas which can overlap to each other.
+*	The windows have a z-order as they appear on the screen which by default is their creation order.
+*	The newer windows are on top of the olders. The z-order of a window can be changed via the methods
+*	\c raise_top, \c lower_bottom. A part of area occuppied by a window can be \b invalidated caused
+*	by the usage any of the following methods: \c set_window_rect, \c invalidate, \c invalidate_rect
+*	executed against a certain window. Once an area is invalidated it is registered to the system object
+*	which will make it valid when the \c av_system method \c update is invoked. The method \c update
+*	is implicitly invoked on each processed event.
+*	On \c update the windows tree is recursively tested for intersection with an invalidated region
+*	starting from bottom to top according their z-order.
+*	Once intersection is detected to a window then the method \c on_paint is executed with parameter
+*	a graphics object where the window can draw its content.
+*/
+typedef struct av_window
+{
+	/*! Parent class object */
+	av_object_t object;
+
+	/*! Origin X of the children, changed with \c move */
+	int origin_x;
+
+	/*! Origin Y of the children, changed with \c move */
+	int origin_y;
+
+	/*! Delay in millisecs before mouse enter event to be sent to this window  */
+	unsigned long hover_delay;
+	
+	/*! Window cursor shape */
+	av_display_cursor_shape_t cursor;
+
+	/*! Window cursor visitibility status */
+	av_bool_t cursor_visible;
+
+	/*! Are events bubbled */
+	av_bool_t bubble_events;
+	
+	/*! Are events handled */
+	av_bool_t handle_events;
+
+	/*!
+	* \brief Dispatcher object
+	* used to hook and pre-filter events
+	*/
+	av_object_p dispatcher;
+
+	/*! Methods shared by all windows of this class */
+	av_window_methods_p methods;
+
 	/*!
 	* \brief Event handler for all system events
 	* Do not override this method, but the methods on_mouse_XXX, on_key_XXX and on_paint
@@ -389,13 +458,6 @@ typedef struct av_window
 	* \param rect an invalidated rect in absolute coordinates
 	*/
 	void (*on_invalidate)             (struct av_window* self, av_rect_p rect);
-
-	/*!
-	* \brief Invalidate this window area
-	* \param self is a reference to this object
-	*/
-	void (*invalidate)                (struct av_window* self);
-
 } av_window_t, *av_window_p;
 
 /*!
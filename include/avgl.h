@@ -16,9 +16,12 @@
 
 #include <av.h>
 #include <av_audio.h>
+#include <av_cache.h>
 #include <av_event.h>
 #include <av_graphics.h>
+#include <av_grid.h>
 #include <av_hash.h>
+#include <av_image_cache.h>
 #include <av_input.h>
 #include <av_keys.h>
 #include <av_list.h>
@@ -27,6 +30,7 @@
 #include <av_player.h>
 #include <av_prefs.h>
 #include <av_rect.h>
+#include <av_region.h>
 #include <av_scripting.h>
 #include <av_surface.h>
 #include <av_system.h>
@@ -34,6 +38,7 @@
 #include <av_timer.h>
 #include <av_oop.h>
 #include <av_tree.h>
+#include <av_vector.h>
 #include <av_display.h>
 #include <av_window.h>
 #include <av_bitmap.h>
@@ -48,11 +53,16 @@ AV_API void avgl_capture_visible(av_visible_p visible);
 AV_API av_result_t avgl_last_error();
 AV_API void avgl_loop();
 AV_API av_bool_t avgl_step();
+AV_API void avgl_set_loop_mode(av_loop_mode_t mode);
 AV_API void avgl_destroy();
 AV_API unsigned long avgl_time_now();
 AV_API void avgl_event_push(av_event_p event);
 AV_API av_bool_t avgl_event_poll(av_event_p event);
+AV_API void avgl_event_stats(av_event_stats_p stats);
 AV_API av_bitmap_p avgl_load_bitmap(const char* filename);
 AV_API av_surface_p avgl_load_surface(const char* filename);
+AV_API unsigned int avgl_load_surface_async(av_visible_p visible, const char* filename, av_surface_p placeholder,
+											av_surface_loaded_t on_loaded, void* arg);
+AV_API void avgl_cancel_load(unsigned int id);
 
 #endif /* __AVGL_H */
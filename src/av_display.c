@@ -105,6 +105,12 @@ static void av_display_render(struct av_display* self)
 	AV_UNUSED(self);
 }
 
+static av_bool_t av_display_is_present_forced(struct av_display* self)
+{
+	AV_UNUSED(self);
+	return AV_FALSE;
+}
+
 /* Initializes memory given by the input pointer with the display's class information */
 static av_result_t av_display_constructor(av_object_p object)
 {
@@ -121,6 +127,7 @@ static av_result_t av_display_constructor(av_object_p object)
 	self->set_mouse_position    = av_display_set_mouse_position;
 	self->get_mouse_position    = av_display_get_mouse_position;
 	self->render                = av_display_render;
+	self->is_present_forced     = av_display_is_present_forced;
 	return AV_OK;
 }
 
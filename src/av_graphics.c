@@ -12,6 +12,7 @@
 #include <av_display.h>
 #include <av_graphics.h>
 #include <av_prefs.h>
+#include <av_stdc.h>
 
 /* Create graphics surface */
 static av_result_t av_graphics_create_surface(av_graphics_p self, int width, int height, av_graphics_surface_p *ppsurface)
@@ -433,6 +434,18 @@ static av_result_t av_graphics_set_font_size(av_graphics_p self, int size)
 	return AV_ESUPPORTED;
 }
 
+static void av_graphics_set_text_cache_budget(av_graphics_p self, unsigned int budget)
+{
+	AV_UNUSED(self);
+	AV_UNUSED(budget);
+}
+
+static void av_graphics_get_text_cache_stats(av_graphics_p self, av_cache_stats_p stats)
+{
+	AV_UNUSED(self);
+	av_memset(stats, 0, sizeof(av_cache_stats_t));
+}
+
 static void av_graphics_destructor(av_object_t* pobject)
 {
 	AV_UNUSED(pobject);
@@ -482,6 +495,8 @@ static av_result_t av_graphics_constructor(av_object_p pobject)
 	self->get_text_extents    = av_graphics_get_text_extents;
 	self->set_font_face       = av_graphics_set_font_face;
 	self->set_font_size       = av_graphics_set_font_size;
+	self->set_text_cache_budget = av_graphics_set_text_cache_budget;
+	self->get_text_cache_stats  = av_graphics_get_text_cache_stats;
 
 	return AV_OK;
 }
@@ -0,0 +1,320 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_grid.c                                          */
+/* Description:   Uniform grid spatial index                         */
+/*                                                                   */
+/*********************************************************************/
+
+#include <av_grid.h>
+#include <av_hash.h>
+#include <av_stdc.h>
+
+typedef struct _grid_entry_t
+{
+	void*        item;
+	av_rect_t    rect;
+	av_bool_t    has_rect;
+	av_bool_t    is_large;   /* kept in the list tested by every query */
+	unsigned int stamp;      /* last query visiting the entry */
+} grid_entry_t, *grid_entry_p;
+
+typedef struct _grid_ctx_t
+{
+	av_hash_p    entries;    /* item -> grid_entry_p */
+	av_hash_p    cells;      /* cell key -> av_vector_p of grid_entry_p */
+	av_vector_p  large;      /* large entries */
+	unsigned int stamp;
+} grid_ctx_t, *grid_ctx_p;
+
+/* cell coordinates are packed in the key, the cells sharing key are filtered by the rects test */
+#define GRID_CELL_KEY(cx, cy) AV_HASH_INT_KEY((((intptr_t)(cy) & 0xffff) << 16) | ((intptr_t)(cx) & 0xffff))
+
+/* rounds division toward negative infinity */
+static int grid_floor_div(int a, int b)
+{
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+/* returns the range of cells overlapped by rect, AV_FALSE for empty rect */
+static av_bool_t grid_cells_range(av_grid_p self, av_rect_p rect, int* cx0, int* cy0, int* cx1, int* cy1)
+{
+	if (rect->w <= 0 || rect->h <= 0)
+		return AV_FALSE;
+	*cx0 = grid_floor_div(rect->x, self->cell_size);
+	*cy0 = grid_floor_div(rect->y, self->cell_size);
+	*cx1 = grid_floor_div(rect->x + rect->w - 1, self->cell_size);
+	*cy1 = grid_floor_div(rect->y + rect->h - 1, self->cell_size);
+	return AV_TRUE;
+}
+
+static av_bool_t grid_rects_intersect(av_rect_p a, av_rect_p b)
+{
+	return a->x < b->x + b->w && b->x < a->x + a->w &&
+		   a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static av_result_t grid_register(av_grid_p self, grid_entry_p entry)
+{
+	grid_ctx_p ctx = (grid_ctx_p)self->context;
+	int cx0, cy0, cx1, cy1, cx, cy;
+	av_result_t rc;
+
+	entry->is_large = AV_FALSE;
+	if (!entry->has_rect || (grid_cells_range(self, &entry->rect, &cx0, &cy0, &cx1, &cy1)
+		&& (cx1 - cx0 + 1) * (cy1 - cy0 + 1) > AV_GRID_MAX_ITEM_CELLS))
+	{
+		entry->is_large = AV_TRUE;
+		return ctx->large->push_last(ctx->large, &entry);
+	}
+
+	if (!grid_cells_range(self, &entry->rect, &cx0, &cy0, &cx1, &cy1))
+		return AV_OK;
+
+	for (cy = cy0; cy <= cy1; cy++)
+	{
+		for (cx = cx0; cx <= cx1; cx++)
+		{
+			av_vector_p cell = (av_vector_p)ctx->cells->get_key(ctx->cells, GRID_CELL_KEY(cx, cy));
+			if (!cell)
+			{
+				if (AV_OK != (rc = av_vector_create(sizeof(grid_entry_p), &cell)))
+					return rc;
+				if (AV_OK != (rc = ctx->cells->add_key(ctx->cells, GRID_CELL_KEY(cx, cy), cell)))
+				{
+					cell->destroy(cell);
+					return rc;
+				}
+			}
+			if (AV_OK != (rc = cell->push_last(cell, &entry)))
+				return rc;
+		}
+	}
+	return AV_OK;
+}
+
+static void grid_unregister(av_grid_p self, grid_entry_p entry)
+{
+	grid_ctx_p ctx = (grid_ctx_p)self->context;
+	int cx0, cy0, cx1, cy1, cx, cy, index;
+
+	if (entry->is_large)
+	{
+		if (0 <= (index = ctx->large->index_of(ctx->large, &entry)))
+			ctx->large->remove(ctx->large, (unsigned int)index);
+		return;
+	}
+
+	if (!grid_cells_range(self, &entry->rect, &cx0, &cy0, &cx1, &cy1))
+		return;
+
+	for (cy = cy0; cy <= cy1; cy++)
+	{
+		for (cx = cx0; cx <= cx1; cx++)
+		{
+			av_vector_p cell = (av_vector_p)ctx->cells->get_key(ctx->cells, GRID_CELL_KEY(cx, cy));
+			if (cell && 0 <= (index = cell->index_of(cell, &entry)))
+				cell->remove(cell, (unsigned int)index);
+		}
+	}
+}
+
+static av_result_t av_grid_add(av_grid_p self, void* item, av_rect_p rect)
+{
+	grid_ctx_p ctx = (grid_ctx_p)self->context;
+	grid_entry_p entry = (grid_entry_p)ctx->entries->get_key(ctx->entries, item);
+	av_result_t rc;
+
+	if (entry)
+	{
+		grid_unregister(self, entry);
+	}
+	else
+	{
+		if (0 == (entry = (grid_entry_p)av_calloc(1, sizeof(grid_entry_t))))
+			return AV_EMEM;
+		entry->item = item;
+		if (AV_OK != (rc = ctx->entries->add_key(ctx->entries, item, entry)))
+		{
+			av_free(entry);
+			return rc;
+		}
+		self->size++;
+	}
+
+	entry->has_rect = (AV_NULL != rect);
+	if (rect)
+		av_rect_copy(&entry->rect, rect);
+
+	if (AV_OK != (rc = grid_register(self, entry)))
+	{
+		/* partially registered entry is dropped */
+		grid_unregister(self, entry);
+		ctx->entries->remove_key(ctx->entries, item);
+		av_free(entry);
+		self->size--;
+	}
+	return rc;
+}
+
+static av_bool_t av_grid_remove(av_grid_p self, void* item)
+{
+	grid_ctx_p ctx = (grid_ctx_p)self->context;
+	grid_entry_p entry = (grid_entry_p)ctx->entries->remove_key(ctx->entries, item);
+
+	if (!entry)
+		return AV_FALSE;
+	grid_unregister(self, entry);
+	av_free(entry);
+	self->size--;
+	return AV_TRUE;
+}
+
+/* starts new query, entries visited by the previous queries are not marked with the new stamp */
+static unsigned int grid_next_stamp(grid_ctx_p ctx)
+{
+	if (0 == ++ctx->stamp)
+	{
+		av_hash_cursor_t cursor;
+		const void* key;
+		void* value;
+		for (ctx->entries->cursor_first(ctx->entries, &cursor); ctx->entries->cursor_next(ctx->entries, &cursor, &key, &value);)
+			((grid_entry_p)value)->stamp = 0;
+		ctx->stamp = 1;
+	}
+	return ctx->stamp;
+}
+
+static av_result_t av_grid_query_rect(av_grid_p self, av_rect_p rect, av_vector_p items)
+{
+	grid_ctx_p ctx = (grid_ctx_p)self->context;
+	grid_entry_p* pentry;
+	int cx0, cy0, cx1, cy1, cx, cy;
+	unsigned int stamp;
+	av_result_t rc;
+
+	if (!grid_cells_range(self, rect, &cx0, &cy0, &cx1, &cy1))
+		return AV_OK;
+
+	av_vector_foreach(ctx->large, grid_entry_p, pentry)
+	{
+		if (!(*pentry)->has_rect || grid_rects_intersect(&(*pentry)->rect, rect))
+			if (AV_OK != (rc = items->push_last(items, &(*pentry)->item)))
+				return rc;
+	}
+
+	stamp = grid_next_stamp(ctx);
+	for (cy = cy0; cy <= cy1; cy++)
+	{
+		for (cx = cx0; cx <= cx1; cx++)
+		{
+			av_vector_p cell = (av_vector_p)ctx->cells->get_key(ctx->cells, GRID_CELL_KEY(cx, cy));
+			if (!cell)
+				continue;
+
+			/* items overlapping several queried cells are reported once */
+			av_vector_foreach(cell, grid_entry_p, pentry)
+			{
+				grid_entry_p entry = *pentry;
+				if (entry->stamp == stamp)
+					continue;
+				entry->stamp = stamp;
+				if (grid_rects_intersect(&entry->rect, rect))
+					if (AV_OK != (rc = items->push_last(items, &entry->item)))
+						return rc;
+			}
+		}
+	}
+	return AV_OK;
+}
+
+static av_result_t av_grid_query_point(av_grid_p self, int x, int y, av_vector_p items)
+{
+	grid_ctx_p ctx = (grid_ctx_p)self->context;
+	grid_entry_p* pentry;
+	av_vector_p cell;
+	av_result_t rc;
+
+	av_vector_foreach(ctx->large, grid_entry_p, pentry)
+	{
+		if (!(*pentry)->has_rect || av_rect_point_inside(&(*pentry)->rect, x, y))
+			if (AV_OK != (rc = items->push_last(items, &(*pentry)->item)))
+				return rc;
+	}
+
+	cell = (av_vector_p)ctx->cells->get_key(ctx->cells,
+		GRID_CELL_KEY(grid_floor_div(x, self->cell_size), grid_floor_div(y, self->cell_size)));
+	if (cell)
+	{
+		av_vector_foreach(cell, grid_entry_p, pentry)
+		{
+			if (av_rect_point_inside(&(*pentry)->rect, x, y))
+				if (AV_OK != (rc = items->push_last(items, &(*pentry)->item)))
+					return rc;
+		}
+	}
+	return AV_OK;
+}
+
+static void av_grid_destroy(av_grid_p self)
+{
+	grid_ctx_p ctx = (grid_ctx_p)self->context;
+	av_hash_cursor_t cursor;
+	const void* key;
+	void* value;
+
+	if (ctx->cells)
+	{
+		for (ctx->cells->cursor_first(ctx->cells, &cursor); ctx->cells->cursor_next(ctx->cells, &cursor, &key, &value);)
+			((av_vector_p)value)->destroy((av_vector_p)value);
+		ctx->cells->destroy(ctx->cells);
+	}
+	if (ctx->entries)
+	{
+		for (ctx->entries->cursor_first(ctx->entries, &cursor); ctx->entries->cursor_next(ctx->entries, &cursor, &key, &value);)
+			av_free(value);
+		ctx->entries->destroy(ctx->entries);
+	}
+	if (ctx->large)
+		ctx->large->destroy(ctx->large);
+	av_free(ctx);
+	av_free(self);
+}
+
+av_result_t av_grid_create(int cell_size, av_grid_p* ppgrid)
+{
+	av_grid_p self;
+	grid_ctx_p ctx;
+	av_result_t rc;
+	av_assert(cell_size >= 0, "grid cell size must not be negative");
+
+	if (0 == (self = (av_grid_p)av_calloc(1, sizeof(av_grid_t))))
+		return AV_EMEM;
+	if (0 == (ctx = (grid_ctx_p)av_calloc(1, sizeof(grid_ctx_t))))
+	{
+		av_free(self);
+		return AV_EMEM;
+	}
+
+	self->context     = ctx;
+	self->cell_size   = cell_size ? cell_size : AV_GRID_CELL_SIZE;
+	self->size        = 0;
+	self->add         = av_grid_add;
+	self->remove      = av_grid_remove;
+	self->query_rect  = av_grid_query_rect;
+	self->query_point = av_grid_query_point;
+	self->destroy     = av_grid_destroy;
+
+	if (AV_OK != (rc = av_hash_create_ex(AV_HASH_CAPACITY_SMALL, AV_HASH_KEY_POINTER, AV_HASH_UNSYNCHRONIZED, &ctx->entries))
+	 || AV_OK != (rc = av_hash_create_ex(AV_HASH_CAPACITY_SMALL, AV_HASH_KEY_INTEGER, AV_HASH_UNSYNCHRONIZED, &ctx->cells))
+	 || AV_OK != (rc = av_vector_create(sizeof(grid_entry_p), &ctx->large)))
+	{
+		av_grid_destroy(self);
+		return rc;
+	}
+
+	*ppgrid = self;
+	return AV_OK;
+}
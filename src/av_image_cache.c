@@ -0,0 +1,221 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_image_cache.c                                   */
+/* Description:   Process wide cache of decoded images               */
+/*                                                                   */
+/*********************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <av_image_cache.h>
+#include <av_cache.h>
+#include <av_thread.h>
+#include <av_stdc.h>
+
+/* cached image with its type */
+typedef struct _image_entry_t
+{
+	av_image_type_p type;
+	void*           image;
+} image_entry_t, *image_entry_p;
+
+typedef struct _image_cache_t
+{
+	av_mutex_p    mutex;
+	av_cache_p    cache;      /* image key -> image_entry_p */
+	unsigned int  hits;
+	unsigned int  misses;
+	unsigned long decode_us;
+} image_cache_t;
+
+static image_cache_t image_cache = { AV_NULL, AV_NULL, 0, 0, 0 };
+
+static void image_entry_free(void* value)
+{
+	image_entry_p entry = (image_entry_p)value;
+	entry->type->release(entry->image);
+	av_free(entry);
+}
+
+static av_bool_t image_entry_busy(void* value)
+{
+	image_entry_p entry = (image_entry_p)value;
+	return entry->type->is_shared(entry->image);
+}
+
+/* makes the image key from type, file modification time and path, AV_FALSE if the file is not found */
+static av_bool_t image_key(av_image_type_p type, const char* filename, char* key, int keysize)
+{
+#ifdef _MSC_VER
+	struct _stat st;
+	if (0 != _stat(filename, &st))
+		return AV_FALSE;
+#else
+	struct stat st;
+	if (0 != stat(filename, &st))
+		return AV_FALSE;
+#endif
+	snprintf(key, keysize, "%s|%ld|%s", type->name, (long)st.st_mtime, filename);
+	return AV_TRUE;
+}
+
+static unsigned long image_time_us(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (unsigned long)(counter.QuadPart / frequency.QuadPart * 1000000
+						 + counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long)ts.tv_sec * 1000000UL + (unsigned long)ts.tv_nsec / 1000UL;
+#endif
+}
+
+av_result_t av_image_cache_initialize(unsigned int budget)
+{
+	av_result_t rc;
+	av_assert(!image_cache.cache, "image cache is already initialized");
+
+	if (AV_OK != (rc = av_mutex_create(&image_cache.mutex)))
+		return rc;
+	if (AV_OK != (rc = av_cache_create_ex(budget ? budget : AV_IMAGE_CACHE_BUDGET,
+										  image_entry_free, image_entry_busy, &image_cache.cache)))
+	{
+		image_cache.mutex->destroy(image_cache.mutex);
+		image_cache.mutex = AV_NULL;
+		return rc;
+	}
+	image_cache.hits = image_cache.misses = 0;
+	image_cache.decode_us = 0;
+	return AV_OK;
+}
+
+void av_image_cache_finalize(void)
+{
+	if (!image_cache.cache)
+		return;
+	image_cache.cache->destroy(image_cache.cache);
+	image_cache.mutex->destroy(image_cache.mutex);
+	image_cache.cache = AV_NULL;
+	image_cache.mutex = AV_NULL;
+}
+
+av_result_t av_image_cache_load(av_image_type_p type, void* param, const char* filename, void** ppimage)
+{
+	char key[1024];
+	image_entry_p entry;
+	void* image;
+	unsigned int bytes;
+	unsigned long start;
+	av_result_t rc;
+
+	if (!image_cache.cache || !image_key(type, filename, key, sizeof(key)))
+		return type->decode(param, filename, ppimage, &bytes);
+
+	image_cache.mutex->lock(image_cache.mutex);
+	if (0 != (entry = (image_entry_p)image_cache.cache->get(image_cache.cache, key)))
+	{
+		image_cache.hits++;
+		type->addref(entry->image);
+		*ppimage = entry->image;
+		image_cache.mutex->unlock(image_cache.mutex);
+		return AV_OK;
+	}
+	image_cache.misses++;
+	image_cache.mutex->unlock(image_cache.mutex);
+
+	/* decodes unlocked, loads of other images proceed meanwhile */
+	start = image_time_us();
+	rc = type->decode(param, filename, &image, &bytes);
+	if (AV_OK != rc)
+		return rc;
+
+	image_cache.mutex->lock(image_cache.mutex);
+	image_cache.decode_us += image_time_us() - start;
+	if (0 != (entry = (image_entry_p)image_cache.cache->get(image_cache.cache, key)))
+	{
+		/* decoded concurrently by another load */
+		type->release(image);
+		image = entry->image;
+		type->addref(image);
+	}
+	else if (0 != (entry = (image_entry_p)av_malloc(sizeof(image_entry_t))))
+	{
+		entry->type  = type;
+		entry->image = image;
+
+		/* the cache keeps the decoded reference, the caller gets another one */
+		if (AV_OK == image_cache.cache->add(image_cache.cache, key, entry, bytes))
+			type->addref(image);
+		else
+			av_free(entry);
+	}
+	*ppimage = image;
+	image_cache.mutex->unlock(image_cache.mutex);
+	return AV_OK;
+}
+
+av_result_t av_image_cache_pin(av_image_type_p type, const char* filename, av_bool_t pin)
+{
+	char key[1024];
+	av_bool_t found;
+
+	if (!image_cache.cache || !image_key(type, filename, key, sizeof(key)))
+		return AV_EFOUND;
+
+	image_cache.mutex->lock(image_cache.mutex);
+	found = image_cache.cache->pin(image_cache.cache, key, pin);
+	image_cache.mutex->unlock(image_cache.mutex);
+	return found ? AV_OK : AV_EFOUND;
+}
+
+void av_image_cache_set_budget(unsigned int budget)
+{
+	if (!image_cache.cache)
+		return;
+	image_cache.mutex->lock(image_cache.mutex);
+	image_cache.cache->set_budget(image_cache.cache, budget);
+	image_cache.mutex->unlock(image_cache.mutex);
+}
+
+void av_image_cache_clear(void)
+{
+	if (!image_cache.cache)
+		return;
+	image_cache.mutex->lock(image_cache.mutex);
+	image_cache.cache->clear(image_cache.cache);
+	image_cache.mutex->unlock(image_cache.mutex);
+}
+
+void av_image_cache_get_stats(av_image_cache_stats_p stats)
+{
+	av_cache_stats_t cache_stats;
+
+	av_memset(stats, 0, sizeof(av_image_cache_stats_t));
+	if (!image_cache.cache)
+		return;
+
+	image_cache.mutex->lock(image_cache.mutex);
+	image_cache.cache->get_stats(image_cache.cache, &cache_stats);
+	stats->hits           = image_cache.hits;
+	stats->misses         = image_cache.misses;
+	stats->decode_us      = image_cache.decode_us;
+	image_cache.mutex->unlock(image_cache.mutex);
+
+	stats->evictions      = cache_stats.evictions;
+	stats->count          = cache_stats.count;
+	stats->pinned         = cache_stats.pinned;
+	stats->resident_bytes = cache_stats.bytes;
+	stats->budget         = cache_stats.budget;
+}
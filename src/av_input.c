@@ -21,6 +21,15 @@ static av_bool_t av_input_poll_event(av_input_p self, av_event_p event)
 	return AV_FALSE;
 }
 
+/*
+* Waits for the next event, without event source returns immediately
+*/
+static av_bool_t av_input_wait_event(av_input_p self, av_event_p event, unsigned long timeout_ms)
+{
+	AV_UNUSED(timeout_ms);
+	return self->poll_event(self, event);
+}
+
 /*
 * Push event into queue
 */
@@ -45,6 +54,7 @@ static av_result_t av_input_constructor(av_object_p pobject)
 {
 	av_input_p self         = (av_input_p)pobject;
 	self->poll_event        = av_input_poll_event;
+	self->wait_event        = av_input_wait_event;
 	self->push_event        = av_input_push_event;
 	self->get_key_modifiers = av_input_get_key_modifiers;
 	return AV_OK;
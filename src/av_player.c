@@ -65,8 +65,8 @@ typedef struct av_player_ctx
 	av_thread_p thd_video_decoder;
 	av_decoder_audio_p audio_decoder;
 	av_decoder_video_p video_decoder;
-	av_sync_queue_p audio_queue;
-	av_sync_queue_p video_queue;
+	av_spsc_queue_p audio_queue;
+	av_spsc_queue_p video_queue;
 	av_audio_info_t audio_info;
 	av_video_info_t video_info;
 	av_scale_info_t scale_info;
@@ -306,7 +306,7 @@ static av_result_t av_player_open(av_player_p self, const char* url)
 	if(ctx->has_video)
 	{
 	    /* prepare video scaler*/
-		ctx->owner->get_rect(ctx->owner, &rect);
+		ctx->owner->methods->get_rect(ctx->owner, &rect);
 		if (AV_OK != (rc = ((av_surface_p)ctx->graphics_surface)->set_size((av_surface_p)ctx->graphics_surface, rect.w, rect.h)))
 		{
 			ctx->media->close(ctx->media);
@@ -424,7 +424,7 @@ static av_bool_t av_player_on_user(av_window_p self, int id, void* data)
 			/* show the picture on top of the picture queue */
 
 			/* FIXME: Refactor!!! */
-			/* ctx->owner->invalidate(ctx->owner); */
+			/* ctx->owner->methods->invalidate(ctx->owner); */
 			ctx->owner->update(ctx->owner, AV_UPDATE_REPAINT);
 
 			ctx->system->update(ctx->system);
@@ -671,7 +671,7 @@ static av_result_t av_player_constructor(av_object_p object)
 		return rc;
 	}
 
-	if (AV_OK != (rc = av_sync_queue_create(MAX_AUDIO_QUEUE_SIZE, &ctx->audio_queue)))
+	if (AV_OK != (rc = av_spsc_queue_create(MAX_AUDIO_QUEUE_SIZE, &ctx->audio_queue)))
 	{
 		ctx->cond_picture->destroy(ctx->cond_picture);
 		ctx->mtx_picture->destroy(ctx->mtx_picture);
@@ -686,7 +686,7 @@ static av_result_t av_player_constructor(av_object_p object)
 		return rc;
 	}
 
-	if (AV_OK != (rc = av_sync_queue_create(MAX_VIDEO_QUEUE_SIZE, &ctx->video_queue)))
+	if (AV_OK != (rc = av_spsc_queue_create(MAX_VIDEO_QUEUE_SIZE, &ctx->video_queue)))
 	{
 		ctx->audio_queue->destroy(ctx->audio_queue);
 		ctx->cond_picture->destroy(ctx->cond_picture);
@@ -0,0 +1,612 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_region.c                                        */
+/* Description:   Banded rectangle sets                              */
+/*                                                                   */
+/*********************************************************************/
+
+#include <av_region.h>
+#include <av_stdc.h>
+
+#define REGION_MIN_CAPACITY 8
+
+/* right and bottom rectangle edges, exclusive */
+#define X2(r) ((r)->x + (r)->w)
+#define Y2(r) ((r)->y + (r)->h)
+
+/* produces the spans of the result band [y1, y2) from overlapping bands of the operands */
+typedef av_result_t (*region_overlap_t)(av_region_p dst,
+										av_rect_p r1, av_rect_p r1_end,
+										av_rect_p r2, av_rect_p r2_end,
+										int y1, int y2);
+
+static av_result_t region_reserve(av_region_p region, unsigned int count)
+{
+	av_rect_p rects;
+	unsigned int capacity;
+	if (count <= region->capacity)
+		return AV_OK;
+
+	capacity = region->capacity ? region->capacity : REGION_MIN_CAPACITY;
+	while (capacity < count)
+		capacity *= 2;
+
+	/* storage not owned by the region is never reallocated */
+	if (0 == (rects = (av_rect_p)av_realloc(region->capacity ? region->rects : AV_NULL, capacity * sizeof(av_rect_t))))
+		return AV_EMEM;
+
+	region->rects = rects;
+	region->capacity = capacity;
+	return AV_OK;
+}
+
+static av_result_t region_append(av_region_p region, int x1, int y1, int x2, int y2)
+{
+	av_result_t rc;
+	av_rect_p rect;
+	if (AV_OK != (rc = region_reserve(region, region->count + 1)))
+		return rc;
+
+	rect = &region->rects[region->count++];
+	rect->x = x1;
+	rect->y = y1;
+	rect->w = x2 - x1;
+	rect->h = y2 - y1;
+	return AV_OK;
+}
+
+/* appends the spans of a band with new top and bottom */
+static av_result_t region_append_band(av_region_p region, av_rect_p r, av_rect_p r_end, int y1, int y2)
+{
+	av_result_t rc;
+	for (; r < r_end; r++)
+		if (AV_OK != (rc = region_append(region, r->x, y1, X2(r), y2)))
+			return rc;
+	return AV_OK;
+}
+
+static av_result_t region_append_rects(av_region_p region, av_rect_p r, av_rect_p r_end)
+{
+	av_result_t rc;
+	if (AV_OK != (rc = region_reserve(region, region->count + (unsigned int)(r_end - r))))
+		return rc;
+	av_memcpy((unsigned char*)(region->rects + region->count), (unsigned char*)r, (r_end - r) * sizeof(av_rect_t));
+	region->count += (unsigned int)(r_end - r);
+	return AV_OK;
+}
+
+/* returns the end of the band starting at r */
+static av_rect_p region_band_end(av_rect_p r, av_rect_p r_end)
+{
+	int y = r->y;
+	for (r++; r < r_end && r->y == y; r++);
+	return r;
+}
+
+/*
+* Merges the band starting at cur_band into the previous band if both have
+* the same spans and touch vertically. Returns the start of the last band.
+*/
+static unsigned int region_coalesce(av_region_p region, unsigned int prev_band, unsigned int cur_band)
+{
+	unsigned int count = cur_band - prev_band;
+	av_rect_p prev, cur;
+	unsigned int i;
+
+	if (0 == count || region->count - cur_band != count)
+		return cur_band;
+
+	prev = region->rects + prev_band;
+	cur = region->rects + cur_band;
+	if (Y2(prev) != cur->y)
+		return cur_band;
+
+	for (i = 0; i < count; i++)
+		if (prev[i].x != cur[i].x || prev[i].w != cur[i].w)
+			return cur_band;
+
+	for (i = 0; i < count; i++)
+		prev[i].h += cur->h;
+	region->count = cur_band;
+	return prev_band;
+}
+
+static void region_update_extents(av_region_p region)
+{
+	av_rect_p r;
+	int x1, x2;
+
+	if (0 == region->count)
+	{
+		av_rect_init(&region->extents, 0, 0, 0, 0);
+		return;
+	}
+
+	x1 = region->rects->x;
+	x2 = X2(region->rects);
+	for (r = region->rects + 1; r < region->rects + region->count; r++)
+	{
+		if (r->x < x1) x1 = r->x;
+		if (X2(r) > x2) x2 = X2(r);
+	}
+	region->extents.x = x1;
+	region->extents.y = region->rects->y;
+	region->extents.w = x2 - x1;
+	region->extents.h = Y2(region->rects + region->count - 1) - region->extents.y;
+}
+
+/* wraps a rectangle into a region without copying it */
+static void region_from_rect(av_region_p region, av_rect_p rect)
+{
+	region->rects = rect;
+	region->capacity = 0;
+	if (rect->w > 0 && rect->h > 0)
+	{
+		region->extents = *rect;
+		region->count = 1;
+	}
+	else
+	{
+		av_rect_init(&region->extents, 0, 0, 0, 0);
+		region->count = 0;
+	}
+}
+
+/*
+* Walks both regions band by band. Vertical ranges covered by both regions are
+* passed to the overlap function, ranges covered by a single region are copied
+* if requested by append_a or append_b.
+*/
+static av_result_t region_op(av_region_p dst, av_region_p a, av_region_p b,
+							 region_overlap_t overlap, av_bool_t append_a, av_bool_t append_b)
+{
+	av_region_t result = AV_REGION_INIT;
+	av_region_p out;
+	av_rect_p r1 = a->rects, r1_end = a->rects + a->count, r1_band_end;
+	av_rect_p r2 = b->rects, r2_end = b->rects + b->count, r2_band_end;
+	unsigned int prev_band = 0, cur_band;
+	int ytop, ybot = 0;
+	av_result_t rc = AV_OK;
+
+	/* builds into the destination storage unless it is an operand */
+	if (dst == a || dst == b)
+		out = &result;
+	else
+	{
+		out = dst;
+		out->count = 0;
+	}
+
+	if (a->count)
+		ybot = r1->y;
+	if (b->count && (!a->count || r2->y < ybot))
+		ybot = r2->y;
+
+	while (r1 != r1_end && r2 != r2_end)
+	{
+		r1_band_end = region_band_end(r1, r1_end);
+		r2_band_end = region_band_end(r2, r2_end);
+
+		if (r1->y < r2->y)
+		{
+			if (append_a)
+			{
+				int top = AV_MAX(r1->y, ybot);
+				int bot = AV_MIN(Y2(r1), r2->y);
+				if (top != bot)
+				{
+					cur_band = out->count;
+					if (AV_OK != (rc = region_append_band(out, r1, r1_band_end, top, bot)))
+						goto done;
+					prev_band = region_coalesce(out, prev_band, cur_band);
+				}
+			}
+			ytop = r2->y;
+		}
+		else if (r2->y < r1->y)
+		{
+			if (append_b)
+			{
+				int top = AV_MAX(r2->y, ybot);
+				int bot = AV_MIN(Y2(r2), r1->y);
+				if (top != bot)
+				{
+					cur_band = out->count;
+					if (AV_OK != (rc = region_append_band(out, r2, r2_band_end, top, bot)))
+						goto done;
+					prev_band = region_coalesce(out, prev_band, cur_band);
+				}
+			}
+			ytop = r1->y;
+		}
+		else
+			ytop = r1->y;
+
+		ybot = AV_MIN(Y2(r1), Y2(r2));
+		if (ybot > ytop)
+		{
+			cur_band = out->count;
+			if (AV_OK != (rc = overlap(out, r1, r1_band_end, r2, r2_band_end, ytop, ybot)))
+				goto done;
+			prev_band = region_coalesce(out, prev_band, cur_band);
+		}
+
+		if (Y2(r1) == ybot)
+			r1 = r1_band_end;
+		if (Y2(r2) == ybot)
+			r2 = r2_band_end;
+	}
+
+	/* the rest of one region, its first band may be partially consumed */
+	if (r1 != r1_end && append_a)
+	{
+		r1_band_end = region_band_end(r1, r1_end);
+		cur_band = out->count;
+		if (AV_OK != (rc = region_append_band(out, r1, r1_band_end, AV_MAX(r1->y, ybot), Y2(r1))))
+			goto done;
+		region_coalesce(out, prev_band, cur_band);
+		if (AV_OK != (rc = region_append_rects(out, r1_band_end, r1_end)))
+			goto done;
+	}
+	else if (r2 != r2_end && append_b)
+	{
+		r2_band_end = region_band_end(r2, r2_end);
+		cur_band = out->count;
+		if (AV_OK != (rc = region_append_band(out, r2, r2_band_end, AV_MAX(r2->y, ybot), Y2(r2))))
+			goto done;
+		region_coalesce(out, prev_band, cur_band);
+		if (AV_OK != (rc = region_append_rects(out, r2_band_end, r2_end)))
+			goto done;
+	}
+
+done:
+	if (AV_OK != rc)
+		out->count = 0;
+	region_update_extents(out);
+
+	if (out == &result)
+	{
+		if (AV_OK != rc)
+		{
+			av_region_free(&result);
+			av_region_clear(dst);
+			return rc;
+		}
+		av_region_free(dst);
+		*dst = result;
+	}
+	return rc;
+}
+
+static av_result_t region_union_overlap(av_region_p dst,
+										av_rect_p r1, av_rect_p r1_end,
+										av_rect_p r2, av_rect_p r2_end,
+										int y1, int y2)
+{
+	av_result_t rc;
+	av_rect_p r;
+	int x1, x2;
+
+	/* starts from the leftmost span */
+	if (r1->x < r2->x)
+		r = r1++;
+	else
+		r = r2++;
+	x1 = r->x;
+	x2 = X2(r);
+
+	while (r1 != r1_end || r2 != r2_end)
+	{
+		if (r2 == r2_end || (r1 != r1_end && r1->x < r2->x))
+			r = r1++;
+		else
+			r = r2++;
+
+		/* overlapping or touching spans are merged */
+		if (r->x <= x2)
+		{
+			if (X2(r) > x2)
+				x2 = X2(r);
+		}
+		else
+		{
+			if (AV_OK != (rc = region_append(dst, x1, y1, x2, y2)))
+				return rc;
+			x1 = r->x;
+			x2 = X2(r);
+		}
+	}
+	return region_append(dst, x1, y1, x2, y2);
+}
+
+static av_result_t region_intersect_overlap(av_region_p dst,
+											av_rect_p r1, av_rect_p r1_end,
+											av_rect_p r2, av_rect_p r2_end,
+											int y1, int y2)
+{
+	av_result_t rc;
+	while (r1 != r1_end && r2 != r2_end)
+	{
+		int x1 = AV_MAX(r1->x, r2->x);
+		int x2 = AV_MIN(X2(r1), X2(r2));
+		if (x1 < x2)
+			if (AV_OK != (rc = region_append(dst, x1, y1, x2, y2)))
+				return rc;
+
+		/* advances the span ending first */
+		if (X2(r1) < X2(r2))
+			r1++;
+		else if (X2(r2) < X2(r1))
+			r2++;
+		else
+		{
+			r1++;
+			r2++;
+		}
+	}
+	return AV_OK;
+}
+
+static av_result_t region_subtract_overlap(av_region_p dst,
+										   av_rect_p r1, av_rect_p r1_end,
+										   av_rect_p r2, av_rect_p r2_end,
+										   int y1, int y2)
+{
+	av_result_t rc;
+	int x1 = r1->x;
+
+	while (r1 != r1_end && r2 != r2_end)
+	{
+		if (X2(r2) <= x1)
+		{
+			/* subtrahend is left of the minuend */
+			r2++;
+		}
+		else if (r2->x <= x1)
+		{
+			/* subtrahend covers the left part of the minuend */
+			x1 = X2(r2);
+			if (x1 >= X2(r1))
+			{
+				if (++r1 != r1_end)
+					x1 = r1->x;
+			}
+			else
+				r2++;
+		}
+		else if (r2->x < X2(r1))
+		{
+			/* subtrahend splits the minuend */
+			if (AV_OK != (rc = region_append(dst, x1, y1, r2->x, y2)))
+				return rc;
+			x1 = X2(r2);
+			if (x1 >= X2(r1))
+			{
+				if (++r1 != r1_end)
+					x1 = r1->x;
+			}
+			else
+				r2++;
+		}
+		else
+		{
+			/* subtrahend is right of the minuend */
+			if (X2(r1) > x1)
+				if (AV_OK != (rc = region_append(dst, x1, y1, X2(r1), y2)))
+					return rc;
+			if (++r1 != r1_end)
+				x1 = r1->x;
+		}
+	}
+
+	while (r1 != r1_end)
+	{
+		if (AV_OK != (rc = region_append(dst, x1, y1, X2(r1), y2)))
+			return rc;
+		if (++r1 != r1_end)
+			x1 = r1->x;
+	}
+	return AV_OK;
+}
+
+void av_region_init(av_region_p region)
+{
+	av_rect_init(&region->extents, 0, 0, 0, 0);
+	region->rects    = AV_NULL;
+	region->count    = 0;
+	region->capacity = 0;
+}
+
+void av_region_free(av_region_p region)
+{
+	if (region->capacity)
+		av_free(region->rects);
+	av_region_init(region);
+}
+
+void av_region_clear(av_region_p region)
+{
+	region->count = 0;
+	av_rect_init(&region->extents, 0, 0, 0, 0);
+}
+
+av_result_t av_region_set_rect(av_region_p region, av_rect_p rect)
+{
+	av_rect_t r = *rect;
+	av_result_t rc;
+	av_region_clear(region);
+	if (r.w <= 0 || r.h <= 0)
+		return AV_OK;
+
+	if (AV_OK != (rc = region_append_rects(region, &r, &r + 1)))
+		return rc;
+	region->extents = r;
+	return AV_OK;
+}
+
+av_result_t av_region_copy(av_region_p dst, av_region_p src)
+{
+	av_result_t rc;
+	if (dst == src)
+		return AV_OK;
+
+	av_region_clear(dst);
+	if (AV_OK != (rc = region_append_rects(dst, src->rects, src->rects + src->count)))
+		return rc;
+	dst->extents = src->extents;
+	return AV_OK;
+}
+
+av_result_t av_region_union(av_region_p dst, av_region_p a, av_region_p b)
+{
+	/* adding a region covering the other one is a copy */
+	if (0 == b->count || (1 == a->count && av_rect_contains(&a->extents, &b->extents)))
+		return av_region_copy(dst, a);
+	if (0 == a->count || (1 == b->count && av_rect_contains(&b->extents, &a->extents)))
+		return av_region_copy(dst, b);
+	return region_op(dst, a, b, region_union_overlap, AV_TRUE, AV_TRUE);
+}
+
+av_result_t av_region_union_rect(av_region_p dst, av_region_p src, av_rect_p rect)
+{
+	av_rect_t r = *rect;
+	av_region_t region;
+	region_from_rect(&region, &r);
+	return av_region_union(dst, src, &region);
+}
+
+av_result_t av_region_intersect(av_region_p dst, av_region_p a, av_region_p b)
+{
+	av_rect_t inter;
+	if (!a->count || !b->count || !av_rect_intersect(&a->extents, &b->extents, &inter))
+	{
+		av_region_clear(dst);
+		return AV_OK;
+	}
+	if (1 == a->count && 1 == b->count)
+		return av_region_set_rect(dst, &inter);
+	return region_op(dst, a, b, region_intersect_overlap, AV_FALSE, AV_FALSE);
+}
+
+av_result_t av_region_intersect_rect(av_region_p dst, av_region_p src, av_rect_p rect)
+{
+	av_rect_t r = *rect;
+	av_region_t region;
+	region_from_rect(&region, &r);
+	return av_region_intersect(dst, src, &region);
+}
+
+av_result_t av_region_subtract(av_region_p dst, av_region_p a, av_region_p b)
+{
+	av_rect_t inter;
+	if (!a->count || !b->count || !av_rect_intersect(&a->extents, &b->extents, &inter))
+		return av_region_copy(dst, a);
+	return region_op(dst, a, b, region_subtract_overlap, AV_TRUE, AV_FALSE);
+}
+
+av_result_t av_region_subtract_rect(av_region_p dst, av_region_p src, av_rect_p rect)
+{
+	av_rect_t r = *rect;
+	av_region_t region;
+	region_from_rect(&region, &r);
+	return av_region_subtract(dst, src, &region);
+}
+
+void av_region_translate(av_region_p region, int dx, int dy)
+{
+	av_rect_p r;
+	if (0 == region->count)
+		return;
+
+	av_region_foreach(region, r)
+	{
+		r->x += dx;
+		r->y += dy;
+	}
+	region->extents.x += dx;
+	region->extents.y += dy;
+}
+
+av_bool_t av_region_is_empty(av_region_p region)
+{
+	return (0 == region->count);
+}
+
+unsigned long av_region_area(av_region_p region)
+{
+	unsigned long area = 0;
+	av_rect_p r;
+	av_region_foreach(region, r)
+		area += (unsigned long)r->w * (unsigned long)r->h;
+	return area;
+}
+
+av_bool_t av_region_contains_point(av_region_p region, int x, int y)
+{
+	av_rect_p r;
+	if (!region->count || !av_rect_point_inside(&region->extents, x, y))
+		return AV_FALSE;
+
+	av_region_foreach(region, r)
+	{
+		/* rects are sorted by top */
+		if (r->y > y)
+			break;
+		if (av_rect_point_inside(r, x, y))
+			return AV_TRUE;
+	}
+	return AV_FALSE;
+}
+
+av_bool_t av_region_contains_rect(av_region_p region, av_rect_p rect)
+{
+	av_rect_p band, band_end, r;
+	av_rect_p end = region->rects + region->count;
+	int y = rect->y;
+
+	if (rect->w <= 0 || rect->h <= 0)
+		return AV_TRUE;
+	if (!region->count || !av_rect_contains(&region->extents, rect))
+		return AV_FALSE;
+
+	for (band = region->rects; band < end && y < Y2(rect); band = band_end)
+	{
+		int x = rect->x;
+		band_end = region_band_end(band, end);
+		if (Y2(band) <= y)
+			continue;
+
+		/* vertical gap */
+		if (band->y > y)
+			return AV_FALSE;
+
+		/* the band spans must cover the rect without a gap */
+		for (r = band; r < band_end && r->x <= x; r++)
+			if (X2(r) > x)
+				x = X2(r);
+		if (x < X2(rect))
+			return AV_FALSE;
+		y = Y2(band);
+	}
+	return (y >= Y2(rect));
+}
+
+av_bool_t av_region_intersects_rect(av_region_p region, av_rect_p rect)
+{
+	av_rect_t inter;
+	av_rect_p r;
+	if (!region->count || !av_rect_intersect(&region->extents, rect, &inter))
+		return AV_FALSE;
+
+	av_region_foreach(region, r)
+	{
+		if (r->y >= Y2(rect))
+			break;
+		if (av_rect_intersect(r, rect, &inter))
+			return AV_TRUE;
+	}
+	return AV_FALSE;
+}
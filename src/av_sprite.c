@@ -22,8 +22,9 @@ typedef struct _sprite_ctx_t
 	unsigned long seq_start_time;
 } sprite_ctx_t, *sprite_ctx_p;
 
-static const char* context_name = "sprite_ctx_p";
-#define O_context(o) (sprite_ctx_p)O_attr(o, context_name)
+/* sprite context slot assigned on class registration */
+static int context_slot = 0;
+#define O_context(o) ((sprite_ctx_p)O_context_slot(o, context_slot))
 
 void av_sprite_set_size(struct _av_sprite_t* _self, int frame_width, int frame_height)
 {
@@ -32,10 +33,10 @@ void av_sprite_set_size(struct _av_sprite_t* _self, int frame_width, int frame_h
 	ctx->frame_width = frame_width;
 	ctx->frame_height = frame_height;
 
-	((av_window_p)_self)->get_rect((av_window_p)_self, &rect);
+	((av_window_p)_self)->methods->get_rect((av_window_p)_self, &rect);
 	rect.w = frame_width;
 	rect.h = frame_height;
-	((av_window_p)_self)->set_rect((av_window_p)_self, &rect);
+	((av_window_p)_self)->methods->set_rect((av_window_p)_self, &rect);
 }
 
 void av_sprite_get_size(struct _av_sprite_t* _self, int* frame_width, int* frame_height)
@@ -64,7 +65,7 @@ void av_sprite_set_current_frame(struct _av_sprite_t* _self, int frame)
 {
 	sprite_ctx_p ctx = O_context(_self);
 	ctx->current_frame = frame;
-	((av_window_p)_self)->invalidate((av_window_p)_self);
+	((av_window_p)_self)->methods->invalidate((av_window_p)_self);
 
 	// av_dbg("av_sprite_set_current_frame: frame = %d\n", frame);
 }
@@ -83,10 +84,12 @@ void av_sprite_set_sequence(struct _av_sprite_t* _self, int* sequence, int count
 	ctx->is_loop = is_loop;
 	ctx->sequence = (int*)av_malloc(sizeof(int) * count);
 	av_memcpy((unsigned char*)ctx->sequence, (unsigned char*)sequence, sizeof(int) * count);
-	((av_sprite_p)_self)->set_current_frame((av_sprite_p)_self, 0);
+	((av_sprite_p)_self)->methods->set_current_frame((av_sprite_p)_self, 0);
 	ctx->sequence_count = count;
 	ctx->duration = duration;
 	ctx->seq_start_time = ((av_visible_p)_self)->system->timer->now();
+	((av_visible_p)_self)->system->subscribe_tick(((av_visible_p)_self)->system, (av_visible_p)_self);
+	((av_visible_p)_self)->system->request_tick(((av_visible_p)_self)->system, ctx->seq_start_time);
 }
 
 static void av_sprite_render(struct _av_visible_t* _self, av_rect_p src_rect, av_rect_p dst_rect)
@@ -100,7 +103,7 @@ static void av_sprite_render(struct _av_visible_t* _self, av_rect_p src_rect, av
 	int row, col;
 	av_rect_t frame_rect;
 	int frames_per_row;
-	int nframes = self->get_frames_count(self);
+	int nframes = self->methods->get_frames_count(self);
 	if (nframes == 0)
 		return;
 	if (ctx->sequence_count > 0)
@@ -124,16 +127,27 @@ static void av_sprite_on_tick(struct _av_visible_t* _self)
 	unsigned long now = ((av_visible_p)_self)->system->timer->now();
 	unsigned long passed = AV_MIN(ctx->duration, now - ctx->seq_start_time);
 	int next_frame = (int)(ctx->sequence_count * (float)passed / ctx->duration);
+	av_system_p system = ((av_visible_p)_self)->system;
 	if (next_frame < ctx->sequence_count)
 	{
 		if (ctx->current_frame != next_frame)
-			((av_sprite_p)_self)->set_current_frame((av_sprite_p)_self, next_frame);
+			((av_sprite_p)_self)->methods->set_current_frame((av_sprite_p)_self, next_frame);
+
+		/* wake up for the following frame */
+		system->request_tick(system, ctx->seq_start_time +
+			(ctx->duration * (next_frame + 1) + ctx->sequence_count - 1) / ctx->sequence_count);
 	}
 	else
 	{
 		if (ctx->is_loop)
 		{
 			ctx->seq_start_time = now;
+			system->request_tick(system, now);
+		}
+		else
+		{
+			/* idle until the next sequence */
+			system->unsubscribe_tick(system, (av_visible_p)_self);
 		}
 	}
 }
@@ -145,26 +159,40 @@ static void av_sprite_destructor(av_object_t* _self)
 	av_free(ctx);
 }
 
+/* Overrides visible methods and sets the sprite methods in the sprite class methods table */
+static void av_sprite_methods_initializer(void* pmethods)
+{
+	av_sprite_methods_p methods = (av_sprite_methods_p)pmethods;
+	methods->visible.render     = av_sprite_render;
+	methods->set_size           = av_sprite_set_size;
+	methods->get_size           = av_sprite_get_size;
+	methods->get_frames_count   = av_sprite_get_frames_count;
+	methods->set_current_frame  = av_sprite_set_current_frame;
+	methods->get_current_frame  = av_sprite_get_current_frame;
+	methods->set_sequence       = av_sprite_set_sequence;
+}
+
 /* constructor */
 static av_result_t av_sprite_constructor(av_object_p pobject)
 {
 	av_sprite_p self = (av_sprite_p)pobject;
 	sprite_ctx_p ctx = (sprite_ctx_p)av_calloc(1, sizeof(sprite_ctx_t));
 	if (!ctx) return AV_EMEM;
-	O_set_attr(self, context_name, ctx);
+	O_set_context_slot(self, context_slot, ctx);
 
-	((av_visible_p)self)->render = av_sprite_render;
+	self->methods = (av_sprite_methods_p)O_methods(self);
 	((av_visible_p)self)->on_tick = av_sprite_on_tick;
-	self->set_size          = av_sprite_set_size;
-	self->get_size          = av_sprite_get_size;
-	self->get_frames_count  = av_sprite_get_frames_count;
-	self->set_current_frame = av_sprite_set_current_frame;
-	self->get_current_frame = av_sprite_get_current_frame;
-	self->set_sequence = av_sprite_set_sequence;
 	return AV_OK;
 }
 
 av_result_t av_sprite_register_oop(av_oop_p oop)
 {
-	return oop->define_class(oop, "sprite", "visible", sizeof(av_sprite_t), av_sprite_constructor, av_sprite_destructor);
+	av_result_t rc;
+	if (AV_OK != (rc = oop->define_class(oop, "sprite", "visible", sizeof(av_sprite_t), av_sprite_constructor, av_sprite_destructor)))
+		return rc;
+
+	if (AV_OK != (rc = oop->define_methods(oop, "sprite", sizeof(av_sprite_methods_t), av_sprite_methods_initializer)))
+		return rc;
+
+	return oop->get_context_slot(oop, "sprite", &context_slot);
 }
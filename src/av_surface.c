@@ -37,6 +37,16 @@ static av_result_t av_surface_lock(av_surface_p self, av_pixel_p* ppixels, int*
 	return AV_ESUPPORTED;
 }
 
+/* lock part of the surface memory */
+static av_result_t av_surface_lock_rect(av_surface_p self, av_rect_p rect, av_pixel_p* ppixels, int* ppitch)
+{
+	AV_UNUSED(self);
+	AV_UNUSED(rect);
+	AV_UNUSED(ppixels);
+	AV_UNUSED(ppitch);
+	return AV_ESUPPORTED;
+}
+
 /* unlock surface memory */
 static av_result_t av_surface_unlock(av_surface_p self)
 {
@@ -66,6 +76,7 @@ static av_result_t av_surface_constructor(av_object_p object)
 	self->set_size    = av_surface_set_size;
 	self->get_size    = av_surface_get_size;
 	self->lock        = av_surface_lock;
+	self->lock_rect   = av_surface_lock_rect;
 	self->unlock      = av_surface_unlock;
 	self->set_bitmap  = av_surface_set_bitmap;
 	self->render      = av_surface_render;
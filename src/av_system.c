@@ -9,14 +9,40 @@
 /*********************************************************************/
 
 #include <avgl.h>
+#include <av_prefs.h>
+
+typedef struct _render_item_t
+{
+	av_visible_p visible;
+
+	/*! Part of the damage where the visible is not hidden by opaque visibles above it */
+	av_region_t clip;
+} render_item_t, *render_item_p;
 
 typedef struct _system_ctx_t
 {
 	/*! Root visible */
 	av_visible_p root;
 
-	/*! List of invalid rects */
-	av_list_p invalid_rects;
+	/*! Damaged area to be composited on the next step */
+	av_region_t dirty;
+
+	/*! Storage for the next damage, swapped with dirty to avoid allocations */
+	av_region_t dirty_next;
+
+	/*! Visibles to render back to front with their clipped damage */
+	av_vector_p render_items;
+	unsigned int render_count;
+
+	/* Children found by the tree traversals, each level appending after its parent's ones */
+	av_vector_p candidates;
+
+	/*! Opaque area above the currently culled visible */
+	av_region_t covered;
+	av_region_t covered_next;
+
+	/*! Presents the next frame even if there is no damage */
+	av_bool_t present_forced;
 
 	/*! Hovered windows */
 	av_list_p hover_windows;
@@ -26,10 +52,77 @@ typedef struct _system_ctx_t
 
 	/*! Focus window */
 	av_window_p focus;
+
+	/*! Shared task pool, created on demand */
+	av_task_pool_p task_pool;
+
+	/*! How the main loop waits for events */
+	av_loop_mode_t loop_mode;
+
+	/*! Dirty rects statistics */
+	av_dirty_stats_t dirty_stats;
+
+	/*! Input statistics */
+	av_event_stats_t event_stats;
+
+	/*! Visibles subscribed to ticks, AV_NULL for the ones unsubscribed while ticking */
+	av_vector_p tick_visibles;
+	av_bool_t ticking;
+	unsigned int tick_removed;
+
+	/*! Set if a tick has been requested until tick_deadline */
+	av_bool_t tick_requested;
+	unsigned long tick_deadline;
+
+	/*! Asynchronous loads not yet completed on the main loop */
+	av_list_p loads;
+
+	/*! Loads decoded by the workers in completion order, guarded by loads_mutex */
+	struct _surface_load_t* loads_done;
+	struct _surface_load_t* loads_done_last;
+	av_mutex_p loads_mutex;
+
+	/*! Group of the submitted load tasks */
+	av_task_group_t loads_group;
+
+	/*! Last assigned load id */
+	unsigned int load_id;
 } system_ctx_t, *system_ctx_p;
 
-static const char* context = "system_ctx_p";
-#define O_context(o) (system_ctx_p)O_attr(o, context)
+typedef struct _surface_load_t
+{
+	unsigned int        id;
+	av_system_p         system;
+	av_visible_p        visible;
+	char*               filename;
+	av_surface_loaded_t on_loaded;
+	void*               arg;
+
+	/*! Node of the load in loads, AV_NULL once completed or cancelled */
+	av_list_item_p      item;
+
+	/*! Set by the main loop, the worker skips decoding cancelled loads */
+	av_bool_t           cancelled;
+
+	/*! Decoding result set by the worker */
+	av_bitmap_p         bitmap;
+	av_result_t         rc;
+
+	/*! Next decoded load */
+	struct _surface_load_t* next_done;
+} surface_load_t, *surface_load_p;
+
+/* upper bound of input events processed before rendering a frame */
+#define SYSTEM_MAX_EVENTS_PER_STEP 256
+
+#define RECT_AREA(r) ((unsigned long)(r)->w * (unsigned long)(r)->h)
+
+/* number of dirty rects above which the damage is replaced by its bounding box */
+#define SYSTEM_MAX_DIRTY_RECTS 32
+
+/* system context slot assigned on class registration */
+static int context_slot = 0;
+#define O_context(o) ((system_ctx_p)O_context_slot(o, context_slot))
 
 typedef struct _hover_info_t
 {
@@ -40,6 +133,149 @@ typedef struct _hover_info_t
 	av_bool_t hovered;
 } hover_info_t, *hover_info_p;
 
+static av_result_t bitmap_decode(void* param, const char* filename, void** ppimage, unsigned int* pbytes)
+{
+	av_result_t rc;
+	av_system_p system = (av_system_p)param;
+	av_bitmap_p bitmap;
+	int width, height;
+
+	if (AV_OK != (rc = system->create_bitmap(system, &bitmap)))
+		return rc;
+
+	if (AV_OK != (rc = bitmap->load(bitmap, filename)))
+	{
+		O_release(bitmap);
+		return rc;
+	}
+
+	bitmap->get_size(bitmap, &width, &height);
+	*pbytes = (unsigned int)(width * height) * sizeof(av_pixel_t);
+	*ppimage = bitmap;
+	return AV_OK;
+}
+
+static void bitmap_addref(void* image)
+{
+	O_addref(image);
+}
+
+static void bitmap_release(void* image)
+{
+	O_release(image);
+}
+
+static av_bool_t bitmap_is_shared(void* image)
+{
+	return ((av_object_p)image)->refcnt > 1;
+}
+
+/* bitmaps decoded through the image cache */
+static av_image_type_t bitmap_image_type =
+{
+	"bitmap", bitmap_decode, bitmap_addref, bitmap_release, bitmap_is_shared
+};
+
+static void surface_load_free(surface_load_p load)
+{
+	if (load->bitmap)
+		O_release(load->bitmap);
+	av_free(load->filename);
+	av_free(load);
+}
+
+/* decodes on a worker and hands the load back to the main loop */
+static void surface_load_task(void* arg)
+{
+	surface_load_p load = (surface_load_p)arg;
+	av_system_p system = load->system;
+	system_ctx_p ctx = O_context(system);
+	av_bool_t cancelled;
+	av_event_t event;
+
+	ctx->loads_mutex->lock(ctx->loads_mutex);
+	cancelled = load->cancelled;
+	ctx->loads_mutex->unlock(ctx->loads_mutex);
+
+	if (!cancelled)
+		load->rc = system->load_bitmap(system, load->filename, &load->bitmap);
+
+	/* the main loop may free the load once published, it is not touched after */
+	ctx->loads_mutex->lock(ctx->loads_mutex);
+	if (ctx->loads_done_last)
+		ctx->loads_done_last->next_done = load;
+	else
+		ctx->loads_done = load;
+	ctx->loads_done_last = load;
+	ctx->loads_mutex->unlock(ctx->loads_mutex);
+
+	/* wakes the main loop waiting for events */
+	if (!cancelled)
+	{
+		av_memset(&event, 0, sizeof(av_event_t));
+		event.type = AV_EVENT_UPDATE;
+		system->input->push_event(system->input, &event);
+	}
+}
+
+/* takes the first decoded load, AV_NULL if none */
+static surface_load_p pop_load_done(system_ctx_p ctx)
+{
+	surface_load_p load;
+	ctx->loads_mutex->lock(ctx->loads_mutex);
+	if (0 != (load = ctx->loads_done))
+	{
+		ctx->loads_done = load->next_done;
+		if (!ctx->loads_done)
+			ctx->loads_done_last = AV_NULL;
+	}
+	ctx->loads_mutex->unlock(ctx->loads_mutex);
+	return load;
+}
+
+/* creates the surfaces of the decoded loads and passes them to their visibles */
+static void complete_loads(av_system_p self)
+{
+	system_ctx_p ctx = O_context(self);
+	surface_load_p load;
+
+	for (;;)
+	{
+		av_surface_p surface = AV_NULL;
+		av_result_t rc;
+
+		if (!(load = pop_load_done(ctx)))
+			break;
+
+		if (load->cancelled)
+		{
+			surface_load_free(load);
+			continue;
+		}
+		ctx->loads->remove_item(ctx->loads, load->item);
+		load->item = AV_NULL;
+
+		/* display surfaces are created on the main thread only */
+		if (AV_OK == (rc = load->rc))
+		{
+			if (AV_OK == (rc = self->display->create_surface(self->display, &surface)))
+			{
+				if (AV_OK != (rc = surface->set_bitmap(surface, load->bitmap)))
+				{
+					O_release(surface);
+					surface = AV_NULL;
+				}
+			}
+		}
+
+		if (load->on_loaded)
+			load->on_loaded(load->arg, load->visible, surface, rc);
+		else if (surface)
+			load->visible->methods->set_surface(load->visible, surface);
+		surface_load_free(load);
+	}
+}
+
 static void av_visible_root_on_draw(struct _av_visible_t* self, av_graphics_p graphics)
 {
 	av_rect_t rect;
@@ -78,76 +314,202 @@ static void av_visible_root_on_destroy(struct _av_visible_t* self)
 	ctx->root = AV_NULL;
 }
 
-static void tick_recurse(av_visible_p visible)
+/* ticks the subscribed visibles, the ones subscribed by the tick handlers are ticked on the next step */
+static void tick_visibles(system_ctx_p ctx)
 {
-	av_list_p children;
-	if (visible->on_tick)
-		visible->on_tick(visible);
+	av_vector_p visibles = ctx->tick_visibles;
+	unsigned int count = visibles->size;
+	unsigned int i;
+
+	ctx->ticking = AV_TRUE;
+	for (i = 0; i < count; i++)
+	{
+		av_visible_p visible = av_vector_at(visibles, av_visible_p, i);
+
+		/* hidden visibles stay subscribed without being ticked */
+		if (visible && visible->on_tick && ((av_window_p)visible)->methods->is_visible((av_window_p)visible))
+			visible->on_tick(visible);
+	}
+	ctx->ticking = AV_FALSE;
 
-	children = ((av_window_p)visible)->get_children((av_window_p)visible);
-	for (children->first(children); children->has_more(children); children->next(children))
+	/* drops the visibles unsubscribed by the tick handlers */
+	if (ctx->tick_removed)
 	{
-		tick_recurse((av_visible_p)children->get(children));
+		for (i = visibles->size; i-- > 0;)
+			if (!av_vector_at(visibles, av_visible_p, i))
+				visibles->remove(visibles, i);
+		ctx->tick_removed = 0;
 	}
 }
 
 static void draw_recurse(av_visible_p visible)
 {
-	av_list_p children;
+	av_vector_p children;
+	unsigned int i;
 	if (!visible)
 		return;
 	if (visible->on_draw && visible->is_owner_draw)
 	{
-		visible->draw(visible);
+		visible->methods->draw(visible);
 	}
 
-	children = ((av_window_p)visible)->get_children((av_window_p)visible);
-	for (children->first(children); children->has_more(children); children->next(children))
+	/* iterates by index since draw handlers may add or remove children */
+	children = ((av_window_p)visible)->methods->get_children((av_window_p)visible);
+	for (i = 0; i < children->size; i++)
 	{
-		draw_recurse((av_visible_p)children->get(children));
+		draw_recurse(av_vector_at(children, av_visible_p, i));
 	}
 }
 
-static void render_recurse(av_system_p self, av_visible_p visible)
+/* drops the windows appended to the candidates after first */
+static void candidates_truncate(av_vector_p candidates, unsigned int first)
+{
+	while (candidates->size > first)
+		candidates->pop_last(candidates, AV_NULL);
+}
+
+/* lists the shown visibles which may intersect the damage back to front */
+static av_result_t render_collect(system_ctx_p ctx, av_visible_p visible)
 {
 	av_window_p window = (av_window_p)visible;
-	av_rect_t src_rect;
-	av_list_p children;
-	av_display_config_t display_config;
+	av_vector_p candidates = ctx->candidates;
+	unsigned int first = candidates->size;
+	render_item_p item;
+	av_result_t rc;
+	unsigned int i;
+
+	if (!window->methods->is_visible(window))
+		return AV_OK;
+
+	/* items beyond the used ones keep their region storage for reuse */
+	if (ctx->render_count == ctx->render_items->size)
+	{
+		render_item_t new_item;
+		av_region_init(&new_item.clip);
+		if (AV_OK != (rc = ctx->render_items->push_last(ctx->render_items, &new_item)))
+			return rc;
+	}
+	item = &av_vector_at(ctx->render_items, render_item_t, ctx->render_count++);
+	item->visible = visible;
+
+	/* the candidates vector grows while recursing, the children are accessed by index */
+	rc = window->methods->get_children_in_rect(window, &ctx->dirty.extents, candidates);
+	for (i = first; AV_OK == rc && i < candidates->size; i++)
+		rc = render_collect(ctx, av_vector_at(candidates, av_visible_p, i));
+	candidates_truncate(candidates, first);
+	return rc;
+}
+
+/* swaps region contents, keeping both storages */
+static void region_swap(av_region_p a, av_region_p b)
+{
+	av_region_t region = *a;
+	*a = *b;
+	*b = region;
+}
+
+/*
+* Walks the visibles front to back clipping the damage of each one by the opaque
+* area above it, then renders the remaining parts back to front.
+*/
+static av_result_t render_visibles(av_system_p self)
+{
 	system_ctx_p ctx = O_context(self);
-	av_list_p invrects = ctx->invalid_rects;
+	av_region_p dirty = &ctx->dirty;
+	av_region_p covered = &ctx->covered;
+	av_region_p scratch = &ctx->covered_next;
+	av_display_config_t display_config;
+	av_result_t rc;
+	unsigned int i;
 
-	self->display->get_configuration(self->display, &display_config);
+	ctx->render_count = 0;
+	if (AV_OK != (rc = render_collect(ctx, ctx->root)))
+		return rc;
+
+	av_region_clear(covered);
+	for (i = ctx->render_count; i-- > 0;)
+	{
+		render_item_p item = &av_vector_at(ctx->render_items, render_item_t, i);
+		av_visible_p visible = item->visible;
+		av_window_p window = (av_window_p)visible;
+		av_rect_t winrect;
+		av_rect_t cliprect;
+		unsigned long damaged;
+
+		/* the parts outside the parents clipping their children are neither painted nor hiding */
+		window->methods->get_clip_rect(window, &cliprect);
+		if (AV_OK != (rc = av_region_intersect_rect(&item->clip, dirty, &cliprect)))
+			return rc;
+		if (av_region_is_empty(&item->clip))
+			continue;
+
+		if (!av_region_is_empty(covered))
+		{
+			damaged = av_region_area(&item->clip);
+			if (AV_OK != (rc = av_region_subtract(scratch, &item->clip, covered)))
+				return rc;
+			region_swap(scratch, &item->clip);
+			ctx->dirty_stats.culled_pixels += damaged - av_region_area(&item->clip);
+			if (av_region_is_empty(&item->clip))
+				ctx->dirty_stats.culled_visibles++;
+		}
+
+		/* hides the visibles below */
+		if (visible->is_opaque)
+		{
+			if (AV_OK != (rc = av_region_union_rect(scratch, covered, &cliprect)))
+				return rc;
+			region_swap(scratch, covered);
+		}
+		else if (!av_region_is_empty(&visible->opaque_region))
+		{
+			av_region_t opaque;
+			av_region_init(&opaque);
+			if (AV_OK != (rc = av_region_copy(&opaque, &visible->opaque_region)))
+				return rc;
+			window->methods->get_absolute_rect(window, &winrect);
+			av_region_translate(&opaque, winrect.x, winrect.y);
+			if (AV_OK == (rc = av_region_intersect_rect(&opaque, &opaque, &cliprect)))
+				rc = av_region_union(scratch, covered, &opaque);
+			av_region_free(&opaque);
+			if (AV_OK != rc)
+				return rc;
+			region_swap(scratch, covered);
+		}
+	}
 
-	for (invrects->first(invrects); invrects->has_more(invrects); invrects->next(invrects))
+	self->display->get_configuration(self->display, &display_config);
+	for (i = 0; i < ctx->render_count; i++)
 	{
-		av_rect_p rect = invrects->get(invrects);
+		render_item_p item = &av_vector_at(ctx->render_items, render_item_t, i);
+		av_window_p window = (av_window_p)item->visible;
 		av_rect_t winrect;
-		av_rect_t irect;
-		window->get_absolute_rect(window, &winrect);
-		if (av_rect_intersect(rect, &winrect, &irect))
+		av_rect_p rect;
+
+		/* culled visibles keep their draw_region pending until shown again */
+		if (av_region_is_empty(&item->clip))
+			continue;
+
+		/* repaints the local damage of visibles not culled */
+		if (item->visible->is_owner_draw && item->visible->on_draw
+			&& !av_region_is_empty(&item->visible->draw_region))
+			item->visible->methods->draw(item->visible);
+
+		window->methods->get_absolute_rect(window, &winrect);
+		av_region_foreach(&item->clip, rect)
 		{
-			//av_dbg("inv = %d %d %d %d, x=%d, y=%d\n", irect.x, irect.y, irect.w, irect.h, winrect.x, winrect.y);
-			src_rect = irect;
+			av_rect_t src_rect = *rect;
+			av_rect_t dst_rect = *rect;
 			src_rect.x -= winrect.x;
 			src_rect.y -= winrect.y;
 
 			av_rect_scale(&src_rect, (float)display_config.scale_x, (float)display_config.scale_y);
-			av_rect_scale(&irect, (float)display_config.scale_x, (float)display_config.scale_y);
-			/*av_dbg("render_scaled %p: %d %d %d %d -> %d %d %d %d\n",
-					visible->surface,
-					src_rect.x, src_rect.y, src_rect.w, src_rect.h,
-					irect.x, irect.y, irect.w, irect.h);
-					*/
-
-			visible->render(visible, &src_rect, &irect);
+			av_rect_scale(&dst_rect, (float)display_config.scale_x, (float)display_config.scale_y);
+			item->visible->methods->render(item->visible, &src_rect, &dst_rect);
 		}
+		ctx->dirty_stats.blits += item->clip.count;
 	}
-	children = window->get_children(window);
-	for (children->first(children); children->has_more(children); children->next(children))
-	{
-		render_recurse(self, (av_visible_p)children->get(children));
-	}
+	return AV_OK;
 }
 
 static av_bool_t bubble_event(av_window_p window, av_event_p event)
@@ -156,30 +518,43 @@ static av_bool_t bubble_event(av_window_p window, av_event_p event)
 	while (window)
 	{
 		/* if event catch is final, then stop bubbling */
-		if ((window->is_handle_events(window) && window->on_event && window->on_event(window, event)) ||
-		   (!window->is_bubble_events(window))) return AV_TRUE;
-		window = window->get_parent(window);
+		if ((window->methods->is_handle_events(window) && window->on_event && window->on_event(window, event)) ||
+		   (!window->methods->is_bubble_events(window))) return AV_TRUE;
+		window = window->methods->get_parent(window);
 	}
 	return AV_FALSE;
 }
 
-static av_window_p find_window_xy(av_window_p window, int x, int y)
+/*
+* Finds the topmost visible window holding a point. The children of a window
+* hold points inside their parent only, so a window not holding the point is
+* not descended into.
+*/
+static av_window_p find_window_xy(system_ctx_p ctx, av_window_p window, int x, int y)
 {
 	av_window_p result = AV_NULL;
-	if (window->is_visible(window))
+	if (window->methods->is_visible(window) && window->methods->point_inside(window, x, y))
 	{
-		av_list_p children = window->get_children(window);
-		if (window->point_inside(window, x, y))
-			result = window;
-
-		for (children->first(children); children->has_more(children); children->next(children))
+		av_vector_p candidates = ctx->candidates;
+		unsigned int first = candidates->size;
+		unsigned int i;
+		av_rect_t rect;
+
+		result = window;
+		av_rect_init(&rect, x, y, 1, 1);
+		if (AV_OK == window->methods->get_children_in_rect(window, &rect, candidates))
 		{
-			av_window_p child = (av_window_p)children->get(children);
-			if ((child = find_window_xy(child, x, y)))
+			for (i = candidates->size; i-- > first;)
 			{
-				result = child;
- 			}
+				av_window_p child = av_vector_at(candidates, av_window_p, i);
+				if (child->methods->is_visible(child) && child->methods->point_inside(child, x, y))
+				{
+					result = find_window_xy(ctx, child, x, y);
+					break;
+				}
+			}
 		}
+		candidates_truncate(candidates, first);
 	}
 	return result;
 }
@@ -188,16 +563,15 @@ static av_result_t add_hover_info(av_system_p system, av_window_p window, int x,
 {
 	av_result_t rc;
 	hover_info_p hover_info;
+	av_list_item_p item;
 	system_ctx_p ctx = O_context(system);
 
-	if (!window->is_handle_events(window))
+	if (!window->methods->is_handle_events(window))
 		return AV_FALSE;
 
-	for (ctx->hover_windows->first(ctx->hover_windows);
-		ctx->hover_windows->has_more(ctx->hover_windows);
-		ctx->hover_windows->next(ctx->hover_windows))
+	for (item = ctx->hover_windows->first_item(ctx->hover_windows); item; item = item->next)
 	{
-		hover_info = (hover_info_p)ctx->hover_windows->get(ctx->hover_windows);
+		hover_info = (hover_info_p)item->value;
 		if (hover_info->window == window)
 		{
 			/* already added, do nothing */
@@ -229,175 +603,344 @@ static av_bool_t av_system_inject_event(av_system_p self, av_event_p event)
 	/* FIXME: implement this */
 }
 
-static av_bool_t av_system_step(av_system_p self)
+/* returns milliseconds until the nearest hover or tick deadline, timers wake the wait with an update event */
+static unsigned long system_wait_timeout(av_system_p self, unsigned long now)
 {
-	unsigned long now;
-	av_event_t event;
 	system_ctx_p ctx = O_context(self);
-	av_list_p invrects = ctx->invalid_rects;
+	av_list_item_p item;
+	av_bool_t has_deadline = ctx->tick_requested;
+	unsigned long deadline = ctx->tick_deadline;
 
-	now = self->timer->now();
-	for (ctx->hover_windows->first(ctx->hover_windows);
-		ctx->hover_windows->has_more(ctx->hover_windows);
-		ctx->hover_windows->next(ctx->hover_windows))
+	/* pending repaint is rendered without waiting */
+	if (!av_region_is_empty(&ctx->dirty) || ctx->present_forced)
+		return 0;
+
+	for (item = ctx->hover_windows->first_item(ctx->hover_windows); item; item = item->next)
 	{
-		hover_info_p hover_info = (hover_info_p)ctx->hover_windows->get(ctx->hover_windows);
-		if (!hover_info->hovered && (now - hover_info->hover_time > hover_info->window->hover_delay))
+		hover_info_p hover_info = (hover_info_p)item->value;
+		if (!hover_info->hovered)
 		{
-			if (hover_info->window->is_visible(hover_info->window))
-			{
-				event.type = AV_EVENT_MOUSE_HOVER;
-				event.mouse_x = hover_info->mouse_x;
-				event.mouse_y = hover_info->mouse_y;
-				event.window = hover_info->window;
-				bubble_event(hover_info->window, &event);
-			}
-			hover_info->hovered = AV_TRUE;
+			unsigned long hover_deadline = hover_info->hover_time + hover_info->window->hover_delay + 1;
+			if (!has_deadline || (long)(hover_deadline - deadline) < 0)
+				deadline = hover_deadline;
+			has_deadline = AV_TRUE;
 		}
 	}
 
-	tick_recurse(ctx->root);
+	if (!has_deadline)
+		return AV_INPUT_WAIT_FOREVER;
+	return ((long)(deadline - now) > 0) ? deadline - now : 0;
+}
 
-	if (!self->input->poll_event(self->input, &event))
-	{
-		self->timer->sleep_ms(10);
-	}
-	else
+/* delivers input event to the target window */
+static av_result_t system_dispatch_event(av_system_p self, av_event_p event)
+{
+	system_ctx_p ctx = O_context(self);
+	av_list_item_p item;
+
+	event->mouse_x /= self->display->display_config.scale_x;
+	event->mouse_y /= self->display->display_config.scale_y;
+	ctx->event_stats.dispatched++;
+
+	av_window_p target = AV_NULL;
+	switch (event->type)
 	{
-		event.mouse_x /= self->display->display_config.scale_x;
-		event.mouse_y /= self->display->display_config.scale_y;
-		av_window_p target = AV_NULL;
-		switch (event.type)
+		case AV_EVENT_MOUSE_BUTTON:
+			av_assert(AV_MASK_ENABLED(event->flags, AV_EVENT_FLAGS_MOUSE_BUTTON), "invalid mouse event");
+		case AV_EVENT_MOUSE_MOTION:
+			av_assert(AV_MASK_ENABLED(event->flags, AV_EVENT_FLAGS_MOUSE_XY), "invalid mouse event");
 		{
-			case AV_EVENT_MOUSE_BUTTON:
-				av_assert(AV_MASK_ENABLED(event.flags, AV_EVENT_FLAGS_MOUSE_BUTTON), "invalid mouse event");
-			case AV_EVENT_MOUSE_MOTION:
-				av_assert(AV_MASK_ENABLED(event.flags, AV_EVENT_FLAGS_MOUSE_XY), "invalid mouse event");
+			if (ctx->capture)
+				target = ctx->capture;
+			else
+			if (ctx->root)
 			{
-				if (ctx->capture)
-					target = ctx->capture;
-				else
-				if (ctx->root)
-				{
-					av_event_type_t event_type = event.type;
-					av_window_p hovered = AV_NULL;
+				av_event_type_t event_type = event->type;
+				av_window_p hovered = AV_NULL;
+				av_list_item_p next;
 
-					target = find_window_xy((av_window_p)ctx->root, event.mouse_x, event.mouse_y);
-					/*if (event.type == AV_EVENT_MOUSE_MOTION)*/
+				target = find_window_xy(ctx, (av_window_p)ctx->root, event->mouse_x, event->mouse_y);
+				/*if (event->type == AV_EVENT_MOUSE_MOTION)*/
+				{
+					if (target)
 					{
-						if (target)
+						if (self->display->is_cursor_visible(self->display))
 						{
-							if (self->display->is_cursor_visible(self->display))
-							{
-								if (!target->cursor_visible)
-									self->display->set_cursor_visible(self->display, AV_FALSE);
-							}
-							else
-							{
-								if (target->cursor_visible)
-								{
-									self->display->set_cursor_visible(self->display, AV_TRUE);
-									self->display->set_mouse_position(self->display, event.mouse_x, event.mouse_y);
-								}
-							}
-							self->display->set_cursor_shape(self->display, target->cursor);
+							if (!target->cursor_visible)
+								self->display->set_cursor_visible(self->display, AV_FALSE);
 						}
-						for (ctx->hover_windows->first(ctx->hover_windows);
-							ctx->hover_windows->has_more(ctx->hover_windows);
-							ctx->hover_windows->next(ctx->hover_windows))
+						else
 						{
-							hover_info_p hover_info = (hover_info_p)ctx->hover_windows->get(ctx->hover_windows);
-							if (hover_info->window == target)
-								hovered = target;
-							else
-							if (!hover_info->window->point_inside(hover_info->window, event.mouse_x, event.mouse_y))
+							if (target->cursor_visible)
 							{
-								event.type = AV_EVENT_MOUSE_LEAVE;
-								bubble_event(hover_info->window, &event);
-								av_free(hover_info);
-								ctx->hover_windows->remove(ctx->hover_windows);
+								self->display->set_cursor_visible(self->display, AV_TRUE);
+								self->display->set_mouse_position(self->display, event->mouse_x, event->mouse_y);
 							}
 						}
-						if (!hovered)
+						self->display->set_cursor_shape(self->display, target->cursor);
+					}
+					for (item = ctx->hover_windows->first_item(ctx->hover_windows); item; item = next)
+					{
+						hover_info_p hover_info = (hover_info_p)item->value;
+						next = item->next;
+						if (hover_info->window == target)
+							hovered = target;
+						else
+						if (!hover_info->window->methods->point_inside(hover_info->window, event->mouse_x, event->mouse_y))
+						{
+							event->type = AV_EVENT_MOUSE_LEAVE;
+							bubble_event(hover_info->window, event);
+							av_free(hover_info);
+							ctx->hover_windows->remove_item(ctx->hover_windows, item);
+						}
+					}
+					if (!hovered)
+					{
+						av_window_p target_parent = target;
+						while (target_parent)
 						{
-							av_window_p target_parent = target;
-							while (target_parent)
+							av_bool_t is_added;
+							av_result_t rc;
+							if (AV_OK != (rc = add_hover_info(self, target_parent, event->mouse_x, event->mouse_y, &is_added)))
 							{
-								av_bool_t is_added;
-								av_result_t rc;
-								if (AV_OK != (rc = add_hover_info(self, target_parent, event.mouse_x, event.mouse_y, &is_added)))
-								{
-									// FIXME: log error
-									return AV_FALSE;
-								}
-								else
+								event->type = event_type;
+								return rc;
+							}
+							else
+							{
+								if (is_added)
 								{
-									if (is_added)
-									{
-										event.type = AV_EVENT_MOUSE_ENTER;
-										bubble_event(target_parent, &event);
-									}
+									event->type = AV_EVENT_MOUSE_ENTER;
+									bubble_event(target_parent, event);
 								}
-								target_parent = target_parent->get_parent(target_parent);
 							}
+							target_parent = target_parent->methods->get_parent(target_parent);
 						}
-						/*target = AV_NULL; */ /* skip event bubble */
-						event.type = event_type;
 					}
+					/*target = AV_NULL; */ /* skip event bubble */
+					event->type = event_type;
 				}
 			}
-			break;
-			case AV_EVENT_KEYBOARD:
-			{
-				target = ctx->focus;
-			}
-			break;
+		}
+		break;
+		case AV_EVENT_KEYBOARD:
+		{
+			target = ctx->focus;
+		}
+		break;
 //			case AV_EVENT_UPDATE:
-//				if (event.flags != AV_EVENT_FLAGS_NONE)
+//				if (event->flags != AV_EVENT_FLAGS_NONE)
 //				{
-//					/* FIXME: use event.data pointer or not */
+//					/* FIXME: use event->data pointer or not */
 //				}
 //				self->update(self);
 //				return AV_TRUE;
 //			break;
 //			case AV_EVENT_USER:
-//				target = (av_window_p)event.window;
+//				target = (av_window_p)event->window;
 //			break;
-			default:
-				break;
+		default:
+			break;
+	}
+
+	if (target/* && (!self->modal || self->modal == target ||
+				   target->methods->is_parent(target, self->modal))*/)
+	{
+		event->window = target;
+		bubble_event(target, event);
+	}
+	return AV_OK;
+}
+
+/* processes one step, waiting for event until the nearest deadline if wait is set */
+static av_bool_t system_step(av_system_p self, av_bool_t wait)
+{
+	unsigned long now;
+	av_event_t event;
+	av_event_t motion;
+	av_bool_t has_event;
+	av_bool_t has_motion = AV_FALSE;
+	av_bool_t quit = AV_FALSE;
+	unsigned int count;
+	system_ctx_p ctx = O_context(self);
+	av_region_p dirty = &ctx->dirty;
+	av_list_item_p item;
+	av_oop_p oop = O_oop(self);
+
+	/* destroys objects released by other threads */
+	oop->destroy_deferred(oop);
+
+	now = self->timer->now();
+	for (item = ctx->hover_windows->first_item(ctx->hover_windows); item; item = item->next)
+	{
+		hover_info_p hover_info = (hover_info_p)item->value;
+		if (!hover_info->hovered && (now - hover_info->hover_time > hover_info->window->hover_delay))
+		{
+			if (hover_info->window->methods->is_visible(hover_info->window))
+			{
+				event.type = AV_EVENT_MOUSE_HOVER;
+				event.mouse_x = hover_info->mouse_x;
+				event.mouse_y = hover_info->mouse_y;
+				event.window = hover_info->window;
+				bubble_event(hover_info->window, &event);
+			}
+			hover_info->hovered = AV_TRUE;
 		}
+	}
+
+	/* tick handlers renew their requests */
+	ctx->tick_requested = AV_FALSE;
+	tick_visibles(ctx);
+
+	ctx->event_stats.received   = 0;
+	ctx->event_stats.dispatched = 0;
+	ctx->event_stats.coalesced  = 0;
+
+	if (wait)
+		has_event = self->input->wait_event(self->input, &event, system_wait_timeout(self, self->timer->now()));
+	else
+		has_event = self->input->poll_event(self->input, &event);
+
+	if (!has_event && !wait)
+		self->timer->sleep_ms(10);
+
+	/* drains the pending events so a burst of input costs a single frame */
+	for (count = 0; has_event; count++)
+	{
+		ctx->event_stats.received++;
+		av_event_dbg(&event);
 
-		if (target/* && (!self->modal || self->modal == target ||
-					   target->is_parent(target, self->modal))*/)
+		if (AV_EVENT_MOUSE_MOTION == event.type)
 		{
-			event.window = target;
-			bubble_event(target, &event);
+			/* only the last of consecutive mouse motions is hit tested */
+			if (has_motion)
+				ctx->event_stats.coalesced++;
+			motion = event;
+			has_motion = AV_TRUE;
+		}
+		else
+		{
+			if (has_motion)
+			{
+				has_motion = AV_FALSE;
+				if (AV_OK != system_dispatch_event(self, &motion))
+					return AV_FALSE;
+			}
+			if (AV_EVENT_QUIT == event.type)
+				quit = AV_TRUE;
+			if (AV_OK != system_dispatch_event(self, &event))
+				return AV_FALSE;
 		}
+
+		if (quit || count + 1 >= SYSTEM_MAX_EVENTS_PER_STEP)
+			break;
+		has_event = self->input->poll_event(self->input, &event);
 	}
+	if (has_motion && AV_OK != system_dispatch_event(self, &motion))
+		return AV_FALSE;
 
-	av_event_dbg(&event);
+	complete_loads(self);
 
-	if (ctx->root)
-		render_recurse(self, ctx->root);
+	ctx->event_stats.steps++;
+	ctx->event_stats.total_received   += ctx->event_stats.received;
+	ctx->event_stats.total_dispatched += ctx->event_stats.dispatched;
+	ctx->event_stats.total_coalesced  += ctx->event_stats.coalesced;
+
+	/* static screen is neither composited nor presented */
+	if (av_region_is_empty(dirty) && !ctx->present_forced
+		&& !self->display->is_present_forced(self->display))
+	{
+		ctx->dirty_stats.skipped_frames++;
+		return !quit;
+	}
+
+	if (ctx->root && !av_region_is_empty(dirty))
+		render_visibles(self);
 
 /*
-	for (invrects->first(invrects); invrects->has_more(invrects); invrects->next(invrects))
 	{
-		av_rect_p rect = invrects->get(invrects);
-		av_dbg("invrect = %d %d %d %d\n", rect->x, rect->y, rect->w, rect->h);
+		av_rect_p rect;
+		av_region_foreach(dirty, rect)
+			av_dbg("invrect = %d %d %d %d\n", rect->x, rect->y, rect->w, rect->h);
 	}
 */
-	invrects->remove_all(invrects, av_free);
+	ctx->dirty_stats.painted_pixels += av_region_area(dirty);
+	ctx->dirty_stats.painted_rects += dirty->count;
+	ctx->dirty_stats.frames++;
+	av_region_clear(dirty);
+	ctx->present_forced = AV_FALSE;
 
 	self->display->render(self->display);
-	return AV_EVENT_QUIT != event.type;
+	return !quit;
+}
+
+static av_bool_t av_system_step(av_system_p self)
+{
+	return system_step(self, AV_FALSE);
 }
 
 static void av_system_loop(av_system_p self)
 {
+	system_ctx_p ctx = O_context(self);
 	draw_recurse(self->get_root_visible(self));
-	while (self->step(self))
-		self->timer->sleep_ms(10);
+	if (AV_LOOP_MODE_WAIT == ctx->loop_mode)
+	{
+		while (system_step(self, AV_TRUE));
+	}
+	else
+	{
+		while (self->step(self))
+			self->timer->sleep_ms(10);
+	}
+}
+
+static void av_system_get_event_stats(av_system_p self, av_event_stats_p stats)
+{
+	system_ctx_p ctx = O_context(self);
+	*stats = ctx->event_stats;
+}
+
+static void av_system_set_loop_mode(av_system_p self, av_loop_mode_t mode)
+{
+	system_ctx_p ctx = O_context(self);
+	ctx->loop_mode = mode;
+}
+
+static void av_system_request_tick(av_system_p self, unsigned long time_ms)
+{
+	system_ctx_p ctx = O_context(self);
+	if (!ctx->tick_requested || (long)(time_ms - ctx->tick_deadline) < 0)
+	{
+		ctx->tick_deadline = time_ms;
+		ctx->tick_requested = AV_TRUE;
+	}
+}
+
+static av_result_t av_system_subscribe_tick(av_system_p self, av_visible_p visible)
+{
+	system_ctx_p ctx = O_context(self);
+	if (0 <= ctx->tick_visibles->index_of(ctx->tick_visibles, &visible))
+		return AV_OK;
+	return ctx->tick_visibles->push_last(ctx->tick_visibles, &visible);
+}
+
+static void av_system_unsubscribe_tick(av_system_p self, av_visible_p visible)
+{
+	system_ctx_p ctx = O_context(self);
+	int index = ctx->tick_visibles->index_of(ctx->tick_visibles, &visible);
+	if (index < 0)
+		return;
+
+	/* keeps the indices of the visibles being ticked */
+	if (ctx->ticking)
+	{
+		av_vector_at(ctx->tick_visibles, av_visible_p, index) = AV_NULL;
+		ctx->tick_removed++;
+	}
+	else
+	{
+		ctx->tick_visibles->remove(ctx->tick_visibles, (unsigned int)index);
+	}
 }
 
 static av_visible_p av_system_get_root_visible(struct _av_system_t* self)
@@ -412,6 +955,10 @@ static void av_system_set_root_visible(struct _av_system_t* self, av_visible_p r
 	if (ctx->root)
 		O_release(ctx->root);
 	ctx->root = (av_visible_p)O_addref(root);
+
+	/* new root is composited in full on the next step */
+	if (ctx->root)
+		((av_window_p)ctx->root)->methods->invalidate((av_window_p)ctx->root);
 }
 
 static av_result_t av_system_create_bitmap(struct _av_system_t* self, av_bitmap_p* pbitmap)
@@ -430,22 +977,208 @@ static void av_system_set_capture(struct _av_system_t* self, av_window_p window)
 static av_result_t av_system_invalidate_rect(struct _av_system_t* self, av_rect_p rect)
 {
 	system_ctx_p ctx = O_context(self);
+	av_region_t dirty;
+	av_rect_t screen;
 	av_rect_t arect;
-	if (rect)
-		av_rect_copy(&arect, rect);
-	else
+	av_result_t rc;
+
+	screen.x = screen.y = 0;
+	screen.w = self->display->display_config.width;
+	screen.h = self->display->display_config.height;
+	if (!rect)
+		rect = &screen;
+
+	/* only the visible part is composited */
+	if (!av_rect_intersect(rect, &screen, &arect))
+		return AV_OK;
+
+	ctx->dirty_stats.requested_rects++;
+	ctx->dirty_stats.requested_pixels += RECT_AREA(&arect);
+	if (AV_OK != (rc = av_region_union_rect(&ctx->dirty_next, &ctx->dirty, &arect)))
+		return rc;
+	dirty = ctx->dirty;
+	ctx->dirty = ctx->dirty_next;
+	ctx->dirty_next = dirty;
+
+	/* heavily fragmented damage is composited as a whole */
+	if (ctx->dirty.count > SYSTEM_MAX_DIRTY_RECTS)
 	{
-		arect.x = arect.y = 0;
-		arect.w =self->display->display_config.width;
-		arect.h = self->display->display_config.height;
+		ctx->dirty_stats.fallbacks++;
+		return av_region_set_rect(&ctx->dirty, &ctx->dirty.extents);
 	}
-	return ctx->invalid_rects->push_last(ctx->invalid_rects, av_rect_clone(&arect));
+	return AV_OK;
 }
 
 static av_result_t av_system_invalidate_rects(struct _av_system_t* self, av_list_p rects)
+{
+	av_result_t rc;
+	for (rects->first(rects); rects->has_more(rects); rects->next(rects))
+	{
+		if (AV_OK != (rc = self->invalidate_rect(self, (av_rect_p)rects->get(rects))))
+			return rc;
+	}
+	return AV_OK;
+}
+
+static void av_system_force_present(av_system_p self)
+{
+	system_ctx_p ctx = O_context(self);
+	ctx->present_forced = AV_TRUE;
+}
+
+static void av_system_get_dirty_stats(av_system_p self, av_dirty_stats_p stats)
+{
+	system_ctx_p ctx = O_context(self);
+	*stats = ctx->dirty_stats;
+}
+
+static av_result_t av_system_get_task_pool(struct _av_system_t* self, av_task_pool_p* pppool)
+{
+	av_result_t rc;
+	system_ctx_p ctx = O_context(self);
+
+	if (!ctx->task_pool)
+	{
+		av_oop_p oop = O_oop(self);
+		av_prefs_p prefs;
+		int workers = 0;
+
+		/* the service reference is borrowed from the registry */
+		if (AV_OK == oop->get_service(oop, "prefs", (av_service_p*)&prefs))
+			prefs->get_int(prefs, "system.task_pool.workers", 0, &workers);
+
+		if (AV_OK != (rc = av_task_pool_create(workers > 0 ? (unsigned int)workers : 0, &ctx->task_pool)))
+			return rc;
+	}
+	*pppool = ctx->task_pool;
+	return AV_OK;
+}
+
+static av_result_t av_system_load_bitmap(struct _av_system_t* self, const char* filename, av_bitmap_p* ppbitmap)
+{
+	return av_image_cache_load(&bitmap_image_type, self, filename, (void**)ppbitmap);
+}
+
+static av_result_t av_system_load_surface(struct _av_system_t* self, const char* filename, av_surface_p* ppsurface)
+{
+	av_result_t rc;
+	av_bitmap_p bitmap;
+	av_surface_p surface;
+
+	if (AV_OK != (rc = self->load_bitmap(self, filename, &bitmap)))
+		return rc;
+
+	if (AV_OK != (rc = self->display->create_surface(self->display, &surface)))
+	{
+		O_release(bitmap);
+		return rc;
+	}
+
+	rc = surface->set_bitmap(surface, bitmap);
+	O_release(bitmap);
+	if (AV_OK != rc)
+	{
+		O_release(surface);
+		return rc;
+	}
+
+	*ppsurface = surface;
+	return AV_OK;
+}
+
+static av_result_t av_system_load_surface_async(struct _av_system_t* self, av_visible_p visible, const char* filename,
+												av_surface_p placeholder, av_surface_loaded_t on_loaded, void* arg,
+												unsigned int* pid)
+{
+	av_result_t rc;
+	av_task_pool_p pool;
+	surface_load_p load;
+	system_ctx_p ctx = O_context(self);
+
+	if (AV_OK != (rc = self->get_task_pool(self, &pool)))
+		return rc;
+
+	if (0 == (load = (surface_load_p)av_calloc(1, sizeof(surface_load_t))))
+		return AV_EMEM;
+	if (0 == (load->filename = av_strdup(filename)))
+	{
+		av_free(load);
+		return AV_EMEM;
+	}
+
+	/* 0 is never a valid id */
+	if (0 == ++ctx->load_id)
+		ctx->load_id = 1;
+	load->id        = ctx->load_id;
+	load->system    = self;
+	load->visible   = visible;
+	load->on_loaded = on_loaded;
+	load->arg       = arg;
+
+	if (AV_OK != (rc = ctx->loads->push_last(ctx->loads, load)))
+	{
+		surface_load_free(load);
+		return rc;
+	}
+	load->item = ctx->loads->last_item(ctx->loads);
+	if (AV_OK != (rc = pool->submit(pool, &ctx->loads_group, surface_load_task, load)))
+	{
+		ctx->loads->remove_item(ctx->loads, load->item);
+		surface_load_free(load);
+		return rc;
+	}
+
+	if (placeholder)
+		visible->methods->set_surface(visible, placeholder);
+	if (pid)
+		*pid = load->id;
+	return AV_OK;
+}
+
+/* marks the load cancelled and forgets it, the worker still owns it */
+static void system_cancel_load(system_ctx_p ctx, surface_load_p load)
+{
+	ctx->loads->remove_item(ctx->loads, load->item);
+	load->item = AV_NULL;
+	ctx->loads_mutex->lock(ctx->loads_mutex);
+	load->cancelled = AV_TRUE;
+	ctx->loads_mutex->unlock(ctx->loads_mutex);
+}
+
+static void av_system_cancel_load(struct _av_system_t* self, unsigned int id)
+{
+	system_ctx_p ctx = O_context(self);
+	av_list_item_p item;
+
+	for (item = ctx->loads->first_item(ctx->loads); item; item = item->next)
+		if (id == ((surface_load_p)item->value)->id)
+		{
+			system_cancel_load(ctx, (surface_load_p)item->value);
+			break;
+		}
+}
+
+static void av_system_cancel_loads(struct _av_system_t* self, av_visible_p visible)
 {
 	system_ctx_p ctx = O_context(self);
-	return ctx->invalid_rects->push_all(ctx->invalid_rects, rects);
+	av_list_item_p item;
+	av_list_item_p next;
+
+	for (item = ctx->loads->first_item(ctx->loads); item; item = next)
+	{
+		surface_load_p load = (surface_load_p)item->value;
+		next = item->next;
+		if (!visible || visible == load->visible)
+			system_cancel_load(ctx, load);
+	}
+
+	if (!visible && ctx->task_pool)
+	{
+		surface_load_p load;
+		ctx->task_pool->wait(ctx->task_pool, &ctx->loads_group);
+		while (0 != (load = pop_load_done(ctx)))
+			surface_load_free(load);
+	}
 }
 
 static av_result_t av_system_initialize(struct _av_system_t* _self, av_display_config_p pdc)
@@ -479,7 +1212,7 @@ static av_result_t av_system_initialize(struct _av_system_t* _self, av_display_c
 		return rc;
 	}
 
-	if (AV_OK != (rc = ((av_window_p)ctx->root)->set_rect((av_window_p)ctx->root, &root_rect)))
+	if (AV_OK != (rc = ((av_window_p)ctx->root)->methods->set_rect((av_window_p)ctx->root, &root_rect)))
 	{
 		O_release(ctx->root);
 		return rc;
@@ -495,8 +1228,34 @@ static void av_system_destructor(void* psystem)
 	if (ctx->root)
 		O_release(ctx->root);
 
-	ctx->invalid_rects->remove_all(ctx->invalid_rects, av_free);
-	ctx->invalid_rects->destroy(ctx->invalid_rects);
+	if (ctx->task_pool)
+		ctx->task_pool->destroy(ctx->task_pool);
+	if (ctx->loads_mutex)
+	{
+		/* the workers have completed all loads */
+		surface_load_p load;
+		while (0 != (load = pop_load_done(ctx)))
+			surface_load_free(load);
+		ctx->loads_mutex->destroy(ctx->loads_mutex);
+	}
+	if (ctx->loads)
+		ctx->loads->destroy(ctx->loads);
+
+	av_region_free(&ctx->dirty);
+	av_region_free(&ctx->dirty_next);
+	av_region_free(&ctx->covered);
+	av_region_free(&ctx->covered_next);
+	if (ctx->render_items)
+	{
+		render_item_p item;
+		av_vector_foreach(ctx->render_items, render_item_t, item)
+			av_region_free(&item->clip);
+		ctx->render_items->destroy(ctx->render_items);
+	}
+	if (ctx->candidates)
+		ctx->candidates->destroy(ctx->candidates);
+	if (ctx->tick_visibles)
+		ctx->tick_visibles->destroy(ctx->tick_visibles);
 	ctx->hover_windows->remove_all(ctx->hover_windows, av_free);
 	ctx->hover_windows->destroy(ctx->hover_windows);
 
@@ -517,14 +1276,30 @@ static av_result_t av_system_constructor(av_object_p object)
 
 	ctx = (system_ctx_p)av_calloc(1, sizeof(system_ctx_t));
 	if (!ctx) return AV_EMEM;
-	O_set_attr(self, context, ctx);
+	O_set_context_slot(self, context_slot, ctx);
 
-	if (AV_OK != (rc = av_list_create(&ctx->invalid_rects)))
+	av_region_init(&ctx->dirty);
+	av_region_init(&ctx->dirty_next);
+	av_region_init(&ctx->covered);
+	av_region_init(&ctx->covered_next);
+
+	if (AV_OK != (rc = av_vector_create(sizeof(render_item_t), &ctx->render_items)))
+		return rc;
+	if (AV_OK != (rc = av_vector_create(sizeof(av_window_p), &ctx->candidates)))
+		return rc;
+	if (AV_OK != (rc = av_vector_create(sizeof(av_visible_p), &ctx->tick_visibles)))
 		return rc;
 
 	if (AV_OK != (rc = av_list_create(&ctx->hover_windows)))
 		return rc;
 
+	if (AV_OK != (rc = av_list_create(&ctx->loads)))
+		return rc;
+	if (AV_OK != (rc = av_mutex_create(&ctx->loads_mutex)))
+		return rc;
+
+	ctx->loop_mode          = AV_LOOP_MODE_POLL;
+
 	self->audio             = AV_NULL; // FIXME: 
 
 	oop = object->classref->oop;
@@ -543,6 +1318,13 @@ static av_result_t av_system_constructor(av_object_p object)
 
 	self->step              = av_system_step;
 	self->loop              = av_system_loop;
+	self->set_loop_mode     = av_system_set_loop_mode;
+	self->request_tick      = av_system_request_tick;
+	self->subscribe_tick    = av_system_subscribe_tick;
+	self->unsubscribe_tick  = av_system_unsubscribe_tick;
+	self->get_event_stats   = av_system_get_event_stats;
+	self->get_dirty_stats   = av_system_get_dirty_stats;
+	self->force_present     = av_system_force_present;
 	self->get_root_visible  = av_system_get_root_visible;
 	self->set_root_visible  = av_system_set_root_visible;
 	self->create_bitmap     = av_system_create_bitmap;
@@ -550,6 +1332,12 @@ static av_result_t av_system_constructor(av_object_p object)
 	self->invalidate_rect   = av_system_invalidate_rect;
 	self->invalidate_rects  = av_system_invalidate_rects;
 	self->initialize        = av_system_initialize;
+	self->get_task_pool     = av_system_get_task_pool;
+	self->load_bitmap       = av_system_load_bitmap;
+	self->load_surface      = av_system_load_surface;
+	self->load_surface_async = av_system_load_surface_async;
+	self->cancel_load       = av_system_cancel_load;
+	self->cancel_loads      = av_system_cancel_loads;
 
 	return AV_OK;
 }
@@ -583,7 +1371,10 @@ av_result_t av_system_register_oop(av_oop_p oop)
 	if (AV_OK != (rc = av_audio_register_oop(oop)))
 		return rc;
 	*/
-	return oop->define_class(oop, "system", "service",
+	if (AV_OK != (rc = oop->define_class(oop, "system", "service",
 								  sizeof(av_system_t),
-								  av_system_constructor, av_system_destructor);
+								  av_system_constructor, av_system_destructor)))
+		return rc;
+
+	return oop->get_context_slot(oop, "system", &context_slot);
 }
@@ -12,6 +12,9 @@
 
 av_result_t av_window_set_rect(av_window_p self, av_rect_p newrect);
 
+/* visible class depth assigned on class registration */
+static int visible_slot = 0;
+
 static av_result_t av_visible_set_rect(struct av_window* pwindow, av_rect_p rect)
 {
 	av_result_t rc;
@@ -20,11 +23,10 @@ static av_result_t av_visible_set_rect(struct av_window* pwindow, av_rect_p rect
 	av_system_p system = (av_system_p)self->system;
 	av_rect_t old_rect;
 	av_rect_t new_rect;
-	av_list_p inv_list;
 
-	window->get_absolute_rect(window, &old_rect);
+	window->methods->get_absolute_rect(window, &old_rect);
 	av_window_set_rect(window, rect);
-	window->get_absolute_rect(window, &new_rect);
+	window->methods->get_absolute_rect(window, &new_rect);
 
 	if (self->is_owner_draw && self->surface && (old_rect.w != rect->w || old_rect.h != rect->h))
 	{
@@ -34,16 +36,16 @@ static av_result_t av_visible_set_rect(struct av_window* pwindow, av_rect_p rect
 		if (AV_OK != (rc = self->surface->set_size(self->surface, rect->w * sx, rect->h * sy)))
 			return rc;
 
-		self->draw(self);
+		/* the resized surface content is undefined */
+		av_region_clear(&self->draw_region);
+		self->methods->draw(self);
 	}
 
 	if (system)
 	{
+		/* the system damage region merges the overlapping parts */
+		system->invalidate_rect(system, &old_rect);
 		system->invalidate_rect(system, &new_rect);
-		if (AV_OK == av_rect_substract(&old_rect, &new_rect, &inv_list))
-		{
-			system->invalidate_rects(system, inv_list);
-		}
 	}
 
 	return AV_OK;
@@ -70,31 +72,80 @@ static void av_visible_set_surface(av_visible_t* visible, av_surface_p surface)
 	}
 
 	/* change visible rect according to the new surface */
-	window->get_rect(window, &rect);
+	window->methods->get_rect(window, &rect);
 	surface->get_size(surface, &rect.w, &rect.h);
-	window->set_rect(window, &rect);
+	window->methods->set_rect(window, &rect);
 	self->surface = surface;
 	if (system)
 	{ 
-		window->get_absolute_rect(window, &rect);
+		window->methods->get_absolute_rect(window, &rect);
 		system->invalidate_rect(system, &rect);
 	}
 	self->is_owner_draw = AV_FALSE;
 }
 
+/*
+* Copies rect in surface pixels from the backing surface to the visible surface.
+* Surfaces locking as whole lose their content on lock and receive the whole backing.
+*/
+static av_result_t av_visible_upload(av_visible_p self, av_rect_p rect)
+{
+	av_pixel_p src;
+	av_pixel_p dst;
+	int src_pitch, dst_pitch;
+	av_rect_t upload_rect;
+	av_result_t rc;
+	av_surface_p backing = (av_surface_p)self->backing_surface;
+
+	av_rect_copy(&upload_rect, rect);
+	rc = self->surface->lock_rect(self->surface, &upload_rect, &dst, &dst_pitch);
+	if (AV_ESUPPORTED == rc)
+	{
+		upload_rect.x = upload_rect.y = 0;
+		backing->get_size(backing, &upload_rect.w, &upload_rect.h);
+		rc = self->surface->lock(self->surface, &dst, &dst_pitch);
+	}
+	if (AV_OK != rc)
+		return rc;
+
+	if (AV_OK == (rc = backing->lock(backing, &src, &src_pitch)))
+	{
+		int y;
+		unsigned char* psrc = (unsigned char*)src + upload_rect.y * src_pitch + upload_rect.x * sizeof(av_pixel_t);
+		unsigned char* pdst = (unsigned char*)dst;
+		for (y = 0; y < upload_rect.h; y++)
+		{
+			av_memcpy(pdst, psrc, upload_rect.w * sizeof(av_pixel_t));
+			psrc += src_pitch;
+			pdst += dst_pitch;
+		}
+		backing->unlock(backing);
+	}
+	self->surface->unlock(self->surface);
+	return rc;
+}
+
+/*
+* Repaints the accumulated damage or the whole visible if there is none.
+* The visible is painted into its backing surface, kept with its graphics
+* context between draws, with the clip set to the damage bounding box which
+* is then uploaded to the visible surface.
+*/
 static av_result_t av_visible_draw(struct _av_visible_t* visible)
 {
-	av_graphics_surface_p graphics_surace;
-	av_pixel_p pixels;
-	int pitch;
 	av_result_t rc;
 	av_visible_p self = (av_visible_p)visible;
 	av_system_p system = (av_system_p)self->system;
+	av_graphics_p graphics = system->graphics;
 	av_rect_t rect;
+	av_rect_t paint_rect;
 	int sx = system->display->display_config.scale_x;
 	int sy = system->display->display_config.scale_y;
+	int width, height;
 
-	((av_window_p)self)->get_rect((av_window_p)self, &rect);
+	((av_window_p)self)->methods->get_rect((av_window_p)self, &rect);
+	rect.x = rect.y = 0;
+	av_rect_copy(&self->draw_rect, &rect);
 
 	if (!self->surface)
 	{
@@ -103,17 +154,67 @@ static av_result_t av_visible_draw(struct _av_visible_t* visible)
 			return rc;
 	}
 
-	if (AV_OK != (rc = self->surface->lock(self->surface, &pixels, &pitch)))
+	if (!self->backing_surface)
+	{
+		if (AV_OK != (rc = graphics->create_surface(graphics, rect.w * sx, rect.h * sy, &self->backing_surface)))
+			return rc;
+		av_region_clear(&self->draw_region);
+	}
+	else
+	{
+		((av_surface_p)self->backing_surface)->get_size((av_surface_p)self->backing_surface, &width, &height);
+		if (width != rect.w * sx || height != rect.h * sy)
+		{
+			/* resized backing content is lost */
+			if (AV_OK != (rc = ((av_surface_p)self->backing_surface)->set_size((av_surface_p)self->backing_surface, rect.w * sx, rect.h * sy)))
+				return rc;
+			av_region_clear(&self->draw_region);
+		}
+	}
+
+	if (!av_region_is_empty(&self->draw_region)
+		&& !av_rect_intersect(&self->draw_region.extents, &rect, &self->draw_rect))
+	{
+		/* damage outside of the visible */
+		av_region_clear(&self->draw_region);
+		return AV_OK;
+	}
+	av_region_clear(&self->draw_region);
+
+	av_rect_copy(&paint_rect, &self->draw_rect);
+	av_rect_scale(&paint_rect, (float)sx, (float)sy);
+
+	if (AV_OK != (rc = graphics->begin(graphics, self->backing_surface)))
 		return rc;
+	graphics->scale_x = sx;
+	graphics->scale_y = sy;
+	graphics->set_clip(graphics, &paint_rect);
+	self->on_draw(self, graphics);
+	graphics->end(graphics);
 
-	system->graphics->create_surface_from_data(system->graphics, rect.w * sx, rect.h * sy, pixels, pitch, &graphics_surace);
-	system->graphics->begin(system->graphics, graphics_surace);
-	system->graphics->scale_x = sx;
-	system->graphics->scale_y = sy;
-	self->on_draw(self, system->graphics);
-	system->graphics->end(system->graphics);
-	self->surface->unlock(self->surface);
-	O_destroy(graphics_surace);
+	return av_visible_upload(self, &paint_rect);
+}
+
+static av_result_t av_visible_invalidate_rect(struct _av_visible_t* self, av_rect_p rect)
+{
+	av_result_t rc;
+	av_window_p window = (av_window_p)self;
+	av_rect_t vrect;
+	av_rect_t arect;
+
+	window->methods->get_rect(window, &vrect);
+	vrect.x = vrect.y = 0;
+	if (rect && !av_rect_intersect(rect, &vrect, &vrect))
+		return AV_OK;
+
+	if (self->is_owner_draw && self->on_draw)
+		if (AV_OK != (rc = av_region_union_rect(&self->draw_region, &self->draw_region, &vrect)))
+			return rc;
+
+	av_rect_copy(&arect, &vrect);
+	window->methods->rect_absolute(window, &arect);
+	if (self->system)
+		return self->system->invalidate_rect(self->system, &arect);
 	return AV_OK;
 }
 
@@ -122,19 +223,20 @@ av_result_t av_visible_create_child(struct _av_visible_t* _self, const char* cla
 	av_visible_p self = (av_visible_p)_self;
 	av_oop_p oop = ((av_object_p)self)->classref->oop;
 	av_visible_p visible;
+	av_class_p visible_class = ((av_object_p)self)->classref->ancestors[visible_slot];
 	av_result_t rc;
 	
 	if (AV_OK != (rc = oop->new(oop, classname, (av_object_p*)&visible)))
 		return rc;
 
-	if ( !O_is_a(visible, "visible"))
+	if ( !O_is_a_class(visible, visible_class))
 	{
 		O_release(visible);
 		return AV_EARG;
 	}
 
 	visible->system = (av_system_p)O_addref(self->system);
-	if (AV_OK != (rc = ((av_window_p)visible)->set_parent((av_window_p)visible, (av_window_p)self)))
+	if (AV_OK != (rc = ((av_window_p)visible)->methods->set_parent((av_window_p)visible, (av_window_p)self)))
 	{
 		O_release(visible);
 		return rc;
@@ -142,7 +244,7 @@ av_result_t av_visible_create_child(struct _av_visible_t* _self, const char* cla
 	if (visible->surface)
 	{
 		visible->is_owner_draw = AV_FALSE;
-		visible->set_surface(visible, visible->surface);
+		visible->methods->set_surface(visible, visible->surface);
 	}
 	*pvisible = visible;
 	return AV_OK;
@@ -155,27 +257,71 @@ void av_visible_render(struct _av_visible_t* _self, av_rect_p src_rect, av_rect_
 		visible->surface->render(visible->surface, src_rect, dst_rect);
 }
 
+static void av_visible_set_opaque(struct _av_visible_t* self, av_bool_t opaque)
+{
+	self->is_opaque = opaque;
+	if (!opaque)
+		av_region_clear(&self->opaque_region);
+
+	/* the visibles below are no longer or newly hidden */
+	((av_window_p)self)->methods->invalidate((av_window_p)self);
+}
+
+static av_result_t av_visible_add_opaque_rect(struct _av_visible_t* self, av_rect_p rect)
+{
+	av_result_t rc;
+	if (AV_OK != (rc = av_region_union_rect(&self->opaque_region, &self->opaque_region, rect)))
+		return rc;
+	((av_window_p)self)->methods->invalidate((av_window_p)self);
+	return AV_OK;
+}
+
 static void av_visible_destructor(struct _av_object_t* pvisible)
 {
 	av_visible_p self = (av_visible_p)pvisible;
 
+	av_region_free(&self->opaque_region);
+	av_region_free(&self->draw_region);
+
+	if (self->system)
+	{
+		self->system->unsubscribe_tick(self->system, self);
+		self->system->cancel_loads(self->system, self);
+	}
+
 	if (self->surface && self->is_owner_draw)
 		O_destroy(self->surface);
 
+	if (self->backing_surface)
+		O_release(self->backing_surface);
+
 	if (self->on_destroy)
 		self->on_destroy(self);
 }
 
+/* Overrides window methods and sets the visible methods in the visible class methods table */
+static void av_visible_methods_initializer(void* pmethods)
+{
+	av_visible_methods_p methods = (av_visible_methods_p)pmethods;
+	methods->window.set_rect  = av_visible_set_rect;
+	methods->draw             = av_visible_draw;
+	methods->render           = av_visible_render;
+	methods->set_surface      = av_visible_set_surface;
+	methods->create_child     = av_visible_create_child;
+	methods->set_opaque       = av_visible_set_opaque;
+	methods->add_opaque_rect  = av_visible_add_opaque_rect;
+	methods->invalidate_rect  = av_visible_invalidate_rect;
+}
+
 static av_result_t av_visible_constructor(av_object_p object)
 {
 	av_visible_p self = (av_visible_p)object;
-	((av_window_p)object)->set_rect = av_visible_set_rect;
 	((av_window_p)object)->on_invalidate = av_visible_on_invalidate;
+	self->methods = (av_visible_methods_p)O_methods(self);
 	self->is_owner_draw = AV_TRUE;
-	self->draw = av_visible_draw;
-	self->set_surface = av_visible_set_surface;
-	self->create_child = av_visible_create_child;
-	self->render = av_visible_render;
+	self->is_opaque = AV_FALSE;
+	av_region_init(&self->opaque_region);
+	av_region_init(&self->draw_region);
 	return AV_OK;
 }
 
@@ -194,5 +340,16 @@ av_result_t av_visible_register_oop(av_oop_p oop)
 		return rc;
 	}
 
+	if (AV_OK != (rc = oop->define_methods(oop, "visible", sizeof(av_visible_methods_t),
+		av_visible_methods_initializer)))
+	{
+		return rc;
+	}
+
+	if (AV_OK != (rc = oop->get_context_slot(oop, "visible", &visible_slot)))
+	{
+		return rc;
+	}
+
 	return AV_OK;
 }
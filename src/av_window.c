@@ -10,37 +10,140 @@
 /*********************************************************************/
 
 #include <avgl.h>
+#include <av_grid.h>
+#include <stdlib.h>
 
 typedef struct _window_ctx_t
 {
 	av_rect_t             rect;
-	av_list_p             children;
+	av_vector_p           children;
 	av_window_p           parent;
 	av_bool_t             visible;
 	av_bool_t             clip_children;
 	av_bool_t             painted;
+
+	/* absolute geometry cached until the window or a parent is changed */
+	av_bool_t             geometry_valid;
+	av_rect_t             absolute_rect;  /* window rect in absolute coordinates */
+	av_rect_t             clip_rect;      /* absolute rect clipped by the parents clipping their children */
+	av_rect_t             hit_rect;       /* clip rect restricted by the parents' hit rects */
+	av_bool_t             has_children_clip;
+	av_rect_t             children_clip;  /* clipping applied to the children */
+
+	/* z-order key among the siblings, the children order follows it */
+	long                  z;
+	long                  top_z;
+	long                  bottom_z;
+
+	/* optional spatial index of the children rects */
+	av_grid_p             children_index;
+	av_vector_p           children_found;
 } window_ctx_t, *window_ctx_p;
 
-static const char* context = "window_ctx_p";
-#define O_context(o) (window_ctx_p)O_attr(o, context)
+/* window context slot assigned on class registration */
+static int context_slot = 0;
+#define O_context(o) ((window_ctx_p)O_context_slot(o, context_slot))
+
+/* Marks the cached geometry of the window and its descendants as outdated */
+static void window_invalidate_geometry(av_window_p self)
+{
+	window_ctx_p ctx = O_context(self);
+	av_window_p* pchild;
+
+	/* descendants of a window with outdated geometry are outdated as well */
+	if (!ctx->geometry_valid)
+		return;
+	ctx->geometry_valid = AV_FALSE;
+	av_vector_foreach(ctx->children, av_window_p, pchild)
+		window_invalidate_geometry(*pchild);
+}
+
+static void window_clip_rect(av_rect_p rect, av_rect_p cliprect)
+{
+	if (!av_rect_intersect(rect, cliprect, rect))
+		rect->w = rect->h = 0;
+}
+
+/* Returns the window context with the cached geometry recomputed from the parents if outdated */
+static window_ctx_p window_update_geometry(av_window_p self)
+{
+	window_ctx_p ctx = O_context(self);
+	av_assert(ctx, "window is not properly initialized");
+
+	if (!ctx->geometry_valid)
+	{
+		av_rect_copy(&ctx->absolute_rect, &ctx->rect);
+		if (ctx->parent)
+		{
+			window_ctx_p pctx = window_update_geometry(ctx->parent);
+			av_rect_move(&ctx->absolute_rect,
+						 pctx->absolute_rect.x + ctx->parent->origin_x,
+						 pctx->absolute_rect.y + ctx->parent->origin_y);
+
+			av_rect_copy(&ctx->clip_rect, &ctx->absolute_rect);
+			if (pctx->has_children_clip)
+				window_clip_rect(&ctx->clip_rect, &pctx->children_clip);
+
+			av_rect_copy(&ctx->hit_rect, &ctx->clip_rect);
+			window_clip_rect(&ctx->hit_rect, &pctx->hit_rect);
+
+			ctx->has_children_clip = pctx->has_children_clip;
+			av_rect_copy(&ctx->children_clip, &pctx->children_clip);
+		}
+		else
+		{
+			av_rect_copy(&ctx->clip_rect, &ctx->absolute_rect);
+			av_rect_copy(&ctx->hit_rect, &ctx->absolute_rect);
+			ctx->has_children_clip = AV_FALSE;
+		}
+
+		if (ctx->clip_children)
+		{
+			ctx->has_children_clip = AV_TRUE;
+			av_rect_copy(&ctx->children_clip, &ctx->clip_rect);
+		}
+		ctx->geometry_valid = AV_TRUE;
+	}
+	return ctx;
+}
+
+/* Updates the child rect in the parent's children index */
+static av_result_t window_index_child(av_window_p self, av_window_p child)
+{
+	window_ctx_p ctx = O_context(self);
+	window_ctx_p cctx = O_context(child);
+	if (!ctx->children_index)
+		return AV_OK;
+
+	/* descendants of a child not clipping them may be anywhere */
+	return ctx->children_index->add(ctx->children_index, child, cctx->clip_children ? &cctx->rect : AV_NULL);
+}
+
+/* orders windows by z-order */
+static int window_compare_z(const void* a, const void* b)
+{
+	long za = O_context(*(av_window_p*)a)->z;
+	long zb = O_context(*(av_window_p*)b)->z;
+	return (za > zb) - (za < zb);
+}
 
 /* Set a parent to the window */
 static av_result_t av_window_set_parent(av_window_p self, av_window_p parent)
 {
 	window_ctx_p ctx = O_context(self);
 	av_assert(ctx, "window is not properly initialized");
-	av_assert(!(parent && parent->is_parent(parent, self)), "cyclic window inheritance");
+	av_assert(!(parent && parent->methods->is_parent(parent, self)), "cyclic window inheritance");
 
 	if (ctx->parent) /* not a root window */
 	{
 		/* remove this window from parent's children */
-		ctx->parent->remove_child(ctx->parent, self);
+		ctx->parent->methods->remove_child(ctx->parent, self);
 	}
 
 	if (parent)
 	{
 		/* add window to parent's children */
-		return parent->add_child_top(parent, self);
+		return parent->methods->add_child_top(parent, self);
 	}
 
 	return AV_OK;
@@ -54,7 +157,7 @@ static av_bool_t av_window_is_parent(av_window_p self, av_window_p parent)
 	{
 		if (aparent == parent)
 			return AV_TRUE;
-		aparent = aparent->get_parent(aparent);
+		aparent = aparent->methods->get_parent(aparent);
 	}
 	return AV_FALSE;
 }
@@ -68,7 +171,7 @@ static av_window_p av_window_get_parent(av_window_p self)
 	return ctx->parent;
 }
 
-static av_list_p av_window_get_children(av_window_p self)
+static av_vector_p av_window_get_children(av_window_p self)
 {
 	window_ctx_p ctx = O_context(self);
 	av_assert(ctx, "window is not properly initialized");
@@ -85,11 +188,11 @@ static av_result_t av_window_add_child(av_window_p self, av_window_p child, av_b
 	av_assert(child, "NULL child is not allowed");
 
 	/* detach child from its parent */
-	child->detach(child);
+	child->methods->detach(child);
 
 	/* add child to self children */
-	rc = (istop ? ctx->children->push_last(ctx->children, child)
-				: ctx->children->push_first(ctx->children, child));
+	rc = (istop ? ctx->children->push_last(ctx->children, &child)
+				: ctx->children->insert(ctx->children, 0, &child));
 	O_addref(child);
 
 	if (AV_OK == rc)
@@ -98,6 +201,9 @@ static av_result_t av_window_add_child(av_window_p self, av_window_p child, av_b
 
 		/* set self parent to the new child */
 		cctx->parent = self;
+		cctx->z = istop ? ++ctx->top_z : --ctx->bottom_z;
+		window_invalidate_geometry(child);
+		rc = window_index_child(self, child);
 	}
 
 	return rc;
@@ -124,24 +230,23 @@ static av_bool_t av_window_remove_child(av_window_p self, av_window_p child)
 {
 	window_ctx_p ctx = O_context(self);
 	window_ctx_p cctx;
+	int index;
 	av_assert(ctx && ctx->children, "window is not properly initialized");
 	av_assert(child, "NULL child is not allowed");
 	cctx = O_context(child);
 
-	if (child->get_parent(child) != self) return AV_FALSE; /* self is not direct parent of the child */
+	if (child->methods->get_parent(child) != self) return AV_FALSE; /* self is not direct parent of the child */
 
 	/* search child in self children */
-	for (ctx->children->first(ctx->children);
-		 ctx->children->has_more(ctx->children);
-		 ctx->children->next(ctx->children))
-	{
-		if (child == ctx->children->get(ctx->children)) break; /* child found in self children */
-	}
-	av_assert(child == ctx->children->get(ctx->children), "child is not found between children of its parent");
+	index = ctx->children->index_of(ctx->children, &child);
+	av_assert(index >= 0, "child is not found between children of its parent");
 
-	ctx->children->remove(ctx->children);
+	ctx->children->remove(ctx->children, (unsigned int)index);
 	O_release(child);
 	cctx->parent = AV_NULL; /* removed child has no parent */
+	window_invalidate_geometry(child);
+	if (ctx->children_index)
+		ctx->children_index->remove(ctx->children_index, child);
 	return AV_TRUE;
 }
 
@@ -152,13 +257,13 @@ static void av_window_set_visible(av_window_p self, av_bool_t visible)
 	av_bool_t prevvisible;
 
 	av_assert(ctx, "window is not properly initialized");
-	prevvisible = self->is_visible(self);
+	prevvisible = self->methods->is_visible(self);
 	ctx->visible = visible;
 	
-	if (self->is_visible(self) != prevvisible)
+	if (self->methods->is_visible(self) != prevvisible)
 	{
 		av_rect_t rect;
-		self->get_absolute_rect(self, &rect);
+		self->methods->get_absolute_rect(self, &rect);
 		if (self->on_invalidate && rect.w && rect.h)
 			self->on_invalidate(self, &rect);
 	}
@@ -172,7 +277,7 @@ static av_bool_t av_window_is_visible(av_window_p self)
 
 	/* a window is visible if all its parents are visible */
 	if (ctx->parent)
-		return ctx->visible && ctx->parent->is_visible(ctx->parent);
+		return ctx->visible && ctx->parent->methods->is_visible(ctx->parent);
 	else
 		return ctx->visible;
 }
@@ -183,6 +288,9 @@ static void av_window_set_clip_children(av_window_p self, av_bool_t clipped)
 	window_ctx_p ctx = O_context(self);
 	av_assert(ctx, "window is not properly initialized");
 	ctx->clip_children = clipped;
+	window_invalidate_geometry(self);
+	if (ctx->parent)
+		window_index_child(ctx->parent, self);
 }
 
 /* Return AV_TRUE if the window is clipping its children, AV_FALSE otherwise */
@@ -213,16 +321,16 @@ static av_result_t av_window_raise_lower(av_window_p self, av_bool_t israise)
 	if (parent)
 	{
 		/* reattach the window on top or on the bottom */
-		self->detach(self);
+		self->methods->detach(self);
 		if (israise)
-			rc = parent->add_child_top(parent, self);
+			rc = parent->methods->add_child_top(parent, self);
 		else
-			rc = parent->add_child_bottom(parent, self);
+			rc = parent->methods->add_child_bottom(parent, self);
 
 		if (AV_OK == rc)
 		{
 			av_rect_t rect;
-			self->get_absolute_rect(self, &rect);
+			self->methods->get_absolute_rect(self, &rect);
 			if (self->on_invalidate && rect.w && rect.h)
 				self->on_invalidate(self, &rect);
 		}
@@ -248,11 +356,11 @@ static void av_window_detach(av_window_p self)
 {
 	av_window_p parent;
 
-	parent = self->get_parent(self);
+	parent = self->methods->get_parent(self);
 	if (parent)
 	{
 		/* self window is no longer child to his parent  */
-		parent->remove_child(parent, self);
+		parent->methods->remove_child(parent, self);
 	}
 }
 
@@ -261,21 +369,20 @@ static void av_window_destructor(struct _av_object_t* pobject)
 {
 	av_window_p self = (av_window_p)pobject;
 	window_ctx_p ctx = O_context(self);
-	av_list_p children;
+	av_vector_p children;
 	av_rect_t rect;
 	av_assert(ctx && ctx->children, "window is not properly initialized");
-	self->get_absolute_rect(self, &rect);
+	self->methods->get_absolute_rect(self, &rect);
 	if (self->on_invalidate)
 		self->on_invalidate(self, &rect);
 	children = ctx->children;
-	self->detach(self);
-	while (children->size(children) > 0)
+	self->methods->detach(self);
+	while (children->size > 0)
 	{
-		av_window_p child;
-		children->last(children);
-		child = (av_window_p)children->get(children);
+		av_window_p child = av_vector_at(children, av_window_p, children->size - 1);
 		O_release(child);
 	}
+	self->methods->set_children_index(self, AV_FALSE);
 	children->destroy(children);
 	av_free(ctx);
 }
@@ -287,8 +394,8 @@ static void av_window_destructor(struct _av_object_t* pobject)
 /* FIXME: unused
 static av_window_p av_window_get_root(av_window_p self)
 {
-	if (self->get_parent(self))
-		return av_window_get_root(self->get_parent(self));
+	if (self->methods->get_parent(self))
+		return av_window_get_root(self->methods->get_parent(self));
 	else
 		return self;
 }
@@ -300,9 +407,15 @@ static av_window_p av_window_get_root(av_window_p self)
 */
 static void av_window_get_absolute_rect(av_window_p self, av_rect_p rect)
 {
-	self->get_rect(self, rect);
-	rect->x = rect->y = 0;
-	self->rect_absolute(self, rect);
+	av_rect_copy(rect, &window_update_geometry(self)->absolute_rect);
+}
+
+/*
+* Returns the window rectangle in absolute coordinates clipped by the parents clipping their children
+*/
+static void av_window_get_clip_rect(av_window_p self, av_rect_p rect)
+{
+	av_rect_copy(rect, &window_update_geometry(self)->clip_rect);
 }
 
 /*
@@ -312,74 +425,31 @@ static void av_window_get_absolute_rect(av_window_p self, av_rect_p rect)
 */
 static void av_window_rect_absolute(av_window_p self, av_rect_p rect)
 {
-	av_window_p parent = self->get_parent(self);
-	av_rect_t arect;
-	self->get_rect(self, &arect);
-	av_rect_move(rect, arect.x, arect.y);
-	while (parent)
-	{
-		parent->get_rect(parent, &arect);
-		av_rect_move(rect, arect.x + parent->origin_x, arect.y + parent->origin_y);
-		parent = parent->get_parent(parent);
-	}
+	window_ctx_p ctx = window_update_geometry(self);
+	av_rect_move(rect, ctx->absolute_rect.x, ctx->absolute_rect.y);
 }
 
 /*
-* Clip rect with all parents storing the result to cliprect
-* Returns AV_TRUE if the output cliprect is valid rectangle, AV_FALSE otherwise
-* Rectangles must be given according to a same origine (e.g. in absolute coordinates)
+* Tests if absolute point is inside the window and all its parents,
+* the window area outside the parents clipping their children excluded
 */
-static av_bool_t av_window_clip_with_parents(av_window_p parent, av_rect_p rect, av_rect_p cliprect)
-{
-	av_assert(parent && rect && cliprect, "Invalid arguments passed to av_system_clip_with_parents");
-	av_rect_copy(cliprect, rect);
-	while (parent)
-	{
-		if (parent->are_children_clipped(parent))
-		{
-			av_rect_t prect;
-			parent->get_rect(parent, &prect);
-			prect.x = prect.y = 0;
-			parent->rect_absolute(parent, &prect);
-
-			if (!av_rect_intersect(&prect, cliprect, cliprect))
-				return AV_FALSE; /* No intersection, the result cliprect is invalid */
-		}
-		parent = parent->get_parent(parent);
-	}
-	return AV_TRUE;
-}
-
 static av_bool_t av_window_point_inside(av_window_p self, int x, int y)
 {
-	av_window_p parent;
-	av_rect_t rect;
-	self->get_rect(self, &rect);
-	rect.x = rect.y = 0;
-	self->rect_absolute(self, &rect);
-	
-	if ((parent = self->get_parent(self)))
-	{
-		if (parent->point_inside(parent, x, y))
-			av_window_clip_with_parents(parent, &rect, &rect);
-		else
-			return AV_FALSE;
-	}
-
-	return av_rect_point_inside(&rect, x, y);
+	return av_rect_point_inside(&window_update_geometry(self)->hit_rect, x, y);
 }
 
 /* Sets new window rectangle */
 av_result_t av_window_set_rect(av_window_p self, av_rect_p newrect)
 {
+	av_result_t rc;
 	av_rect_t invrect;
 	av_rect_t oldrect;
 	window_ctx_p ctx = O_context(self);
-	av_list_p children = self->get_children(self);
+	av_vector_p children = self->methods->get_children(self);
 	av_window_p parent =          /* parent window */
-		self->get_parent(self);
+		self->methods->get_parent(self);
 
-	self->get_rect(self, &oldrect);
+	self->methods->get_rect(self, &oldrect);
 	if (av_rect_compare(newrect, &oldrect))
 	{
 		/* window position is not changed. nothing happens */
@@ -390,9 +460,10 @@ av_result_t av_window_set_rect(av_window_p self, av_rect_p newrect)
 	{
 		/* set newrect to the root window */
 		av_rect_copy(&ctx->rect, newrect);
+		window_invalidate_geometry(self);
 		if (self->on_invalidate)
 		{
-			self->get_absolute_rect(self, &invrect);
+			self->methods->get_absolute_rect(self, &invrect);
 			self->on_invalidate(self, &invrect);
 		}
 		return AV_OK;
@@ -401,30 +472,34 @@ av_result_t av_window_set_rect(av_window_p self, av_rect_p newrect)
 	/* invalidate old window rect */
 	if (self->on_invalidate)
 	{
-		self->get_absolute_rect(self, &invrect);
+		self->methods->get_absolute_rect(self, &invrect);
 		self->on_invalidate(self, &invrect);
 	}
 
 	/* if children not clipped, change their positions */
-	if (AV_FALSE == self->are_children_clipped(self))
+	if (AV_FALSE == self->methods->are_children_clipped(self))
 	{
 		/* move children to keep their absolute coordinates unchanged */
-		for (children->first(children); children->has_more(children); children->next(children))
+		av_window_p* pchild;
+		av_vector_foreach(children, av_window_p, pchild)
 		{
 			av_rect_t newcrect;
-			av_window_p child = (av_window_p)children->get(children);
-			child->get_rect(child, &newcrect);
+			av_window_p child = *pchild;
+			child->methods->get_rect(child, &newcrect);
 			newcrect.x -= (newrect->x - oldrect.x);
 			newcrect.y -= (newrect->y - oldrect.y);
-			child->set_rect(child, &newcrect);
+			child->methods->set_rect(child, &newcrect);
 		}
 	}
 
 	/* invalidate new window rect */
 	av_rect_copy(&ctx->rect, newrect);
+	window_invalidate_geometry(self);
+	if (AV_OK != (rc = window_index_child(parent, self)))
+		return rc;
 	if (self->on_invalidate && (oldrect.w != newrect->w || oldrect.h != newrect->h))
 	{
-		self->get_absolute_rect(self, &invrect);
+		self->methods->get_absolute_rect(self, &invrect);
 		self->on_invalidate(self, &invrect);
 	}
 
@@ -433,18 +508,39 @@ av_result_t av_window_set_rect(av_window_p self, av_rect_p newrect)
 
 static av_window_p av_window_get_child_xy(av_window_p self, int x, int y)
 {
-	av_list_p children;
+	av_vector_p children;
+	av_window_p* pchild;
 	window_ctx_p ctx = O_context(self);
 	av_assert(ctx && ctx->children, "window is not properly initialized");
 	children = ctx->children;
-	
-	for (children->last(children); children->has_more(children); children->prev(children))
+
+	if (ctx->children_index)
 	{
-		av_window_p child = (av_window_p)children->get(children);
-		if (child->is_visible(child))
+		/* the topmost of the indexed children holding the point */
+		av_window_p result = AV_NULL;
+		children = ctx->children_found;
+		children->remove_all(children);
+		if (AV_OK != ctx->children_index->query_point(ctx->children_index, x, y, children))
+			return AV_NULL;
+		av_vector_foreach(children, av_window_p, pchild)
 		{
+			av_window_p child = *pchild;
 			av_rect_t crect;
-			child->get_rect(child, &crect);
+			child->methods->get_rect(child, &crect);
+			if ((!result || O_context(child)->z > O_context(result)->z)
+				&& av_rect_point_inside(&crect, x, y) && child->methods->is_visible(child))
+				result = child;
+		}
+		return result;
+	}
+
+	av_vector_foreach_reverse(children, av_window_p, pchild)
+	{
+		av_window_p child = *pchild;
+		if (child->methods->is_visible(child))
+		{
+			av_rect_t crect;
+			child->methods->get_rect(child, &crect);
 			if (av_rect_point_inside(&crect, x, y))
 				return child;
 		}
@@ -452,12 +548,80 @@ static av_window_p av_window_get_child_xy(av_window_p self, int x, int y)
 	return AV_NULL;
 }
 
+static av_result_t av_window_set_children_index(av_window_p self, av_bool_t indexed)
+{
+	av_result_t rc;
+	av_window_p* pchild;
+	window_ctx_p ctx = O_context(self);
+	av_assert(ctx && ctx->children, "window is not properly initialized");
+
+	if (!indexed || ctx->children_index)
+	{
+		if (!indexed && ctx->children_index)
+		{
+			ctx->children_index->destroy(ctx->children_index);
+			ctx->children_found->destroy(ctx->children_found);
+			ctx->children_index = AV_NULL;
+			ctx->children_found = AV_NULL;
+		}
+		return AV_OK;
+	}
+
+	if (AV_OK != (rc = av_grid_create(AV_GRID_CELL_SIZE, &ctx->children_index)))
+		return rc;
+	if (AV_OK != (rc = av_vector_create(sizeof(av_window_p), &ctx->children_found)))
+	{
+		ctx->children_index->destroy(ctx->children_index);
+		ctx->children_index = AV_NULL;
+		return rc;
+	}
+
+	av_vector_foreach(ctx->children, av_window_p, pchild)
+	{
+		if (AV_OK != (rc = window_index_child(self, *pchild)))
+		{
+			av_window_set_children_index(self, AV_FALSE);
+			return rc;
+		}
+	}
+	return AV_OK;
+}
+
+static av_result_t av_window_get_children_in_rect(av_window_p self, av_rect_p rect, av_vector_p children)
+{
+	av_result_t rc;
+	av_window_p* pchild;
+	av_rect_t crect;
+	unsigned int first = children->size;
+	window_ctx_p ctx = window_update_geometry(self);
+
+	if (!ctx->children_index)
+	{
+		av_vector_foreach(ctx->children, av_window_p, pchild)
+			if (AV_OK != (rc = children->push_last(children, pchild)))
+				return rc;
+		return AV_OK;
+	}
+
+	/* the index holds the children rects relative to the parent */
+	av_rect_copy(&crect, rect);
+	av_rect_move(&crect, -(ctx->absolute_rect.x + self->origin_x), -(ctx->absolute_rect.y + self->origin_y));
+	if (AV_OK != (rc = ctx->children_index->query_rect(ctx->children_index, &crect, children)))
+		return rc;
+
+	if (children->size - first > 1)
+		qsort(&av_vector_at(children, av_window_p, first), children->size - first,
+			  sizeof(av_window_p), window_compare_z);
+	return AV_OK;
+}
+
 static void av_window_move(av_window_p self, int x, int y)
 {
 	av_rect_t invrect;
 	self->origin_x = x;
 	self->origin_y = y;
-	self->get_absolute_rect(self, &invrect);
+	window_invalidate_geometry(self);
+	self->methods->get_absolute_rect(self, &invrect);
 	self->on_invalidate(self, &invrect);
 }
 
@@ -567,7 +731,7 @@ static av_bool_t av_window_on_invalidate(av_window_p self, av_rect_p rect)
 static void av_window_invalidate(av_window_p self)
 {
 	av_rect_t rect;
-	self->get_absolute_rect(self, &rect);
+	self->methods->get_absolute_rect(self, &rect);
 	if (self->on_invalidate)
 		self->on_invalidate(self, &rect);
 }
@@ -613,6 +777,47 @@ static av_bool_t av_window_on_event(av_window_p self, av_event_p event)
 	return AV_FALSE;
 }
 
+/* Sets window methods into the class methods table */
+static void av_window_methods_initializer(void* pmethods)
+{
+	av_window_methods_p methods = (av_window_methods_p)pmethods;
+	methods->set_parent            = av_window_set_parent;
+	methods->get_parent            = av_window_get_parent;
+	methods->get_children          = av_window_get_children;
+	methods->is_parent             = av_window_is_parent;
+	methods->add_child_top         = av_window_add_child_top;
+	methods->add_child_bottom      = av_window_add_child_bottom;
+	methods->remove_child          = av_window_remove_child;
+	methods->set_visible           = av_window_set_visible;
+	methods->is_visible            = av_window_is_visible;
+	methods->set_clip_children     = av_window_set_clip_children;
+	methods->are_children_clipped  = av_window_are_children_clipped;
+	methods->get_rect              = av_window_get_rect;
+	methods->set_rect              = av_window_set_rect;
+	methods->get_absolute_rect     = av_window_get_absolute_rect;
+	methods->get_clip_rect         = av_window_get_clip_rect;
+	methods->rect_absolute         = av_window_rect_absolute;
+	methods->point_inside          = av_window_point_inside;
+	methods->raise_top             = av_window_raise_top;
+	methods->lower_bottom          = av_window_lower_bottom;
+	methods->detach                = av_window_detach;
+	methods->get_child_xy          = av_window_get_child_xy;
+	methods->set_children_index    = av_window_set_children_index;
+	methods->get_children_in_rect  = av_window_get_children_in_rect;
+	methods->move                  = av_window_move;
+	methods->set_cursor            = av_window_set_cursor;
+	methods->get_cursor            = av_window_get_cursor;
+	methods->set_cursor_visible    = av_window_set_cursor_visible;
+	methods->is_cursor_visible     = av_window_is_cursor_visible;
+	methods->set_hover_delay       = av_window_set_hover_delay;
+	methods->get_hover_delay       = av_window_get_hover_delay;
+	methods->set_bubble_events     = av_window_set_bubble_events;
+	methods->is_bubble_events      = av_window_is_bubble_events;
+	methods->set_handle_events     = av_window_set_handle_events;
+	methods->is_handle_events      = av_window_is_handle_events;
+	methods->invalidate            = av_window_invalidate;
+}
+
 /* Initializes memory given by the input pointer with the window's class information */
 static av_result_t av_window_constructor(av_object_p object)
 {
@@ -623,8 +828,8 @@ static av_result_t av_window_constructor(av_object_p object)
 	/* initializes self */
 	ctx = (window_ctx_p)av_calloc(1, sizeof(window_ctx_t));
 	if (!ctx) return AV_EMEM;
-	O_set_attr(self, context, ctx);
-	if (AV_OK != (rc = av_list_create(&ctx->children)))
+	O_set_context_slot(self, context_slot, ctx);
+	if (AV_OK != (rc = av_vector_create(sizeof(av_window_p), &ctx->children)))
 	{
 		free(ctx);
 		return AV_EMEM;
@@ -638,37 +843,7 @@ static av_result_t av_window_constructor(av_object_p object)
 	self->bubble_events         = AV_TRUE;
 	self->handle_events         = AV_TRUE;
 	self->dispatcher            = AV_NULL;
-	self->set_parent            = av_window_set_parent;
-	self->get_parent            = av_window_get_parent;
-	self->get_children          = av_window_get_children;
-	self->is_parent             = av_window_is_parent;
-	self->add_child_top         = av_window_add_child_top;
-	self->add_child_bottom      = av_window_add_child_bottom;
-	self->remove_child          = av_window_remove_child;
-	self->set_visible           = av_window_set_visible;
-	self->is_visible            = av_window_is_visible;
-	self->set_clip_children     = av_window_set_clip_children;
-	self->are_children_clipped  = av_window_are_children_clipped;
-	self->get_rect              = av_window_get_rect;
-	self->set_rect              = av_window_set_rect;
-	self->get_absolute_rect     = av_window_get_absolute_rect;
-	self->rect_absolute         = av_window_rect_absolute;
-	self->point_inside          = av_window_point_inside;
-	self->raise_top             = av_window_raise_top;
-	self->lower_bottom          = av_window_lower_bottom;
-	self->detach                = av_window_detach;
-	self->get_child_xy          = av_window_get_child_xy;
-	self->move                  = av_window_move;
-	self->set_cursor            = av_window_set_cursor;
-	self->get_cursor            = av_window_get_cursor;
-	self->set_cursor_visible    = av_window_set_cursor_visible;
-	self->is_cursor_visible     = av_window_is_cursor_visible;
-	self->set_hover_delay       = av_window_set_hover_delay;
-	self->get_hover_delay       = av_window_get_hover_delay;
-	self->set_bubble_events     = av_window_set_bubble_events;
-	self->is_bubble_events      = av_window_is_bubble_events;
-	self->set_handle_events     = av_window_set_handle_events;
-	self->is_handle_events      = av_window_is_handle_events;
+	self->methods               = (av_window_methods_p)O_methods(self);
 	self->on_event              = av_window_on_event;
 	self->on_mouse_move         = av_window_on_mouse;
 	self->on_mouse_enter        = av_window_on_mouse;
@@ -682,12 +857,19 @@ static av_result_t av_window_constructor(av_object_p object)
 	self->on_user               = av_window_on_user;
 	self->on_paint              = av_window_on_paint;
 	self->on_invalidate         = av_window_on_invalidate;
-	self->invalidate            = av_window_invalidate;
 	return AV_OK;
 }
 
 av_result_t av_window_register_oop(av_oop_p oop)
 {
-	return oop->define_class(oop, "window", AV_NULL, sizeof(av_window_t),
-								  av_window_constructor, av_window_destructor);
+	av_result_t rc;
+	if (AV_OK != (rc = oop->define_class(oop, "window", AV_NULL, sizeof(av_window_t),
+								  av_window_constructor, av_window_destructor)))
+		return rc;
+
+	if (AV_OK != (rc = oop->define_methods(oop, "window", sizeof(av_window_methods_t),
+								  av_window_methods_initializer)))
+		return rc;
+
+	return oop->get_context_slot(oop, "window", &context_slot);
 }
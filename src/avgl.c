@@ -22,6 +22,9 @@ typedef struct _avgl_t
 	/* reference to log service */
 	av_log_p log;
 
+	/* reference to prefs service */
+	av_prefs_p prefs;
+
 	/* reference to system service */
 	av_system_p system;
 
@@ -39,14 +42,18 @@ av_bool_t avgl_step()
 	return avgl.system->step(avgl.system);
 }
 
+void avgl_set_loop_mode(av_loop_mode_t mode)
+{
+	avgl.system->set_loop_mode(avgl.system, mode);
+}
+
 void avgl_destroy()
 {
 	av_visible_p main_visible;
-	for (avgl.oop->services->first(avgl.oop->services);
-		avgl.oop->services->has_more(avgl.oop->services);
-		avgl.oop->services->next(avgl.oop->services))
+	av_list_item_p item;
+	for (item = avgl.oop->services->first_item(avgl.oop->services); item; item = item->next)
 	{
-		char* name = avgl.oop->services->get(avgl.oop->services);
+		char* name = (char*)item->value;
 		av_service_p service = avgl.oop->servicemap->get(avgl.oop->servicemap, name);
 		if (((av_object_p)service)->refcnt > 1)
 			avgl.log->warn(avgl.log, "Service %s have %d unreleased references", name, ((av_object_p)service)->refcnt - 1);
@@ -55,7 +62,12 @@ void avgl_destroy()
 	main_visible = avgl.system->get_root_visible(avgl.system);
 	if (main_visible)
 		O_release(main_visible);
+
+	/* no worker may decode through the image cache after finalization */
+	avgl.system->cancel_loads(avgl.system, AV_NULL);
+	av_image_cache_finalize();
 	O_release(avgl.system);
+	O_release(avgl.prefs);
 	O_release(avgl.log);
 	avgl.oop->destroy(avgl.oop);
 }
@@ -81,6 +93,20 @@ av_visible_p avgl_create(av_display_config_p pdc)
 	avgl.log->add_console_logger(avgl.log, LOG_VERBOSITY_DEBUG, "console");
 	avgl.log->info(avgl.log, "AVGL is initializing...");
 
+	/* Initialize preferences, read by the services on demand */
+	if (AV_OK != (rc = av_prefs_register_oop(avgl.oop)))
+	{
+		avgl.last_error = rc;
+		return AV_NULL;
+	}
+	avgl.oop->get_service(avgl.oop, "prefs", (av_service_p*)&avgl.prefs);
+
+	if (AV_OK != (rc = av_image_cache_initialize(AV_IMAGE_CACHE_BUDGET)))
+	{
+		avgl.last_error = rc;
+		return AV_NULL;
+	}
+
 	/* Initialize system */
 	av_graphics_cairo_register_oop(avgl.oop);
 	av_system_sdl_register_oop(avgl.oop);
@@ -130,24 +156,22 @@ av_bool_t avgl_event_poll(av_event_p event)
 	return avgl.system->input->poll_event(avgl.system->input, event);
 }
 
+void avgl_event_stats(av_event_stats_p stats)
+{
+	avgl.system->get_event_stats(avgl.system, stats);
+}
+
 av_bitmap_p avgl_load_bitmap(const char* filename)
 {
 	av_result_t rc;
 	av_bitmap_p bitmap;
 
-	if (AV_OK != (rc = avgl.system->create_bitmap(avgl.system, &bitmap)))
+	if (AV_OK != (rc = avgl.system->load_bitmap(avgl.system, filename, &bitmap)))
 	{
 		avgl.last_error = rc;
 		return AV_NULL;
 	}
 
-	if (AV_OK != (rc = bitmap->load(bitmap, filename)))
-	{
-		O_release(bitmap);
-		avgl.last_error = rc;
-		return AV_NULL;
-	}
-
 	return bitmap;
 }
 
@@ -155,24 +179,33 @@ av_surface_p avgl_load_surface(const char* filename)
 {
 	av_result_t rc;
 	av_surface_p surface;
-	av_bitmap_p bitmap = avgl_load_bitmap(filename);
-	if (!bitmap)
-		return AV_NULL;
 
-	if (AV_OK != (rc = avgl.system->display->create_surface(avgl.system->display, &surface)))
+	if (AV_OK != (rc = avgl.system->load_surface(avgl.system, filename, &surface)))
 	{
-		O_release(bitmap);
 		avgl.last_error = rc;
 		return AV_NULL;
 	}
 
-	if (AV_OK != (rc = surface->set_bitmap(surface, bitmap)))
+	return surface;
+}
+
+unsigned int avgl_load_surface_async(av_visible_p visible, const char* filename, av_surface_p placeholder,
+									 av_surface_loaded_t on_loaded, void* arg)
+{
+	av_result_t rc;
+	unsigned int id;
+
+	if (AV_OK != (rc = avgl.system->load_surface_async(avgl.system, visible, filename, placeholder,
+													   on_loaded, arg, &id)))
 	{
-		O_release(surface);
-		O_release(bitmap);
 		avgl.last_error = rc;
-		return AV_NULL;
+		return 0;
 	}
 
-	return surface;
+	return id;
+}
+
+void avgl_cancel_load(unsigned int id)
+{
+	avgl.system->cancel_load(avgl.system, id);
 }
@@ -13,18 +13,21 @@
 
 #include <malloc.h>
 #include <math.h>
+#include <stdio.h>
 #include <av_display.h>
 #include <av_graphics.h>
+#include <av_image_cache.h>
 #include <av_log.h>
+#include <av_stdc.h>
 #include <cairo.h>
 #include <cairo-features.h>
 #include "av_graphics_cairo.h"
 #include "av_graphics_surface_cairo.h"
 
-#define CONTEXT "graphics_cairo_ctx"
-#define O_context(o)            O_attr(o, CONTEXT)
-#define O_context_surface(o)    O_attr(o, CONTEXT_GRAPHICS_SURFACE)
-#define O_context_pattern(o)    O_attr(o, CONTEXT_GRAPHICS_PATTERN)
+#define CONTEXT                 context_slot
+#define O_context(o)            O_context_slot(o, CONTEXT)
+#define O_context_surface(o)    O_context_slot(o, CONTEXT_GRAPHICS_SURFACE)
+#define O_context_pattern(o)    O_context_slot(o, CONTEXT_GRAPHICS_PATTERN)
 
 #define PITAGOR(x, y)           sqrt((x)*(x) + (y)*(y))
 #define SCALE_X(g, x)           (x)*(((av_graphics_p)(g))->scale_x)
@@ -44,6 +47,13 @@ AV_API av_result_t av_graphics_cairo_register_oop(av_oop_p);
 
 static av_log_p _log = AV_NULL;
 
+/* cairo graphics and pattern context slots assigned on class registration */
+static int context_slot = 0;
+
+/* cairo graphics surface class resolved on the first surface check */
+static av_class_cache_t graphics_surface_cairo_class = AV_CLASS_CACHE_INIT;
+int av_graphics_pattern_cairo_context_slot = 0;
+
 /* Error messages */
 static const char* _err_mem              = "out of memory";
 static const char* _err_arg              = "invalid argument";
@@ -153,33 +163,84 @@ static av_result_t av_graphics_cairo_create_surface_from_data(av_graphics_p self
 		return rc;
 	}
 
-	O_set_attr(surface, CONTEXT_GRAPHICS_SURFACE, image);
+	O_set_context_slot(surface, CONTEXT_GRAPHICS_SURFACE, image);
 	surface->graphics = (av_graphics_p)O_addref(self);
 	*ppsurface = surface;
 	return AV_OK;
 }
 
-/* Create cairo graphics surface from file */
-static av_result_t av_graphics_cairo_create_surface_from_file(av_graphics_p self, const char* filename, av_graphics_surface_p* ppsurface)
+static av_result_t cairo_image_decode(void* param, const char* filename, void** ppimage, unsigned int* pbytes)
 {
 	av_result_t rc;
-	av_graphics_surface_p surface;
 	cairo_surface_t* image;
-	av_oop_p oop = O_oop(self);
+	AV_UNUSED(param);
 
 	/* FIXME: Detect file format */
 	image = cairo_image_surface_create_from_png(filename);
 	if (!image)
 		return AV_EFOUND;
 
-	rc = av_cairo_error_check("cairo_image_surface_create_from_png", cairo_surface_status(image));
-	if (AV_OK != rc || AV_OK != (rc = oop->new(oop, "graphics_surface_cairo", (av_object_p*)&surface)))
+	if (AV_OK != (rc = av_cairo_error_check("cairo_image_surface_create_from_png", cairo_surface_status(image))))
+	{
+		cairo_surface_destroy(image);
+		return rc;
+	}
+
+	/* surfaces writing to the image make a private copy first */
+	if (AV_OK != (rc = av_cairo_error_check("cairo_surface_set_user_data",
+		cairo_surface_set_user_data(image, &av_graphics_surface_cairo_cached_key, image, AV_NULL))))
 	{
 		cairo_surface_destroy(image);
 		return rc;
 	}
 
-	O_set_attr(surface, CONTEXT_GRAPHICS_SURFACE, image);
+	*pbytes = cairo_image_surface_get_stride(image) * cairo_image_surface_get_height(image);
+	*ppimage = image;
+	return AV_OK;
+}
+
+static void cairo_image_addref(void* image)
+{
+	cairo_surface_reference((cairo_surface_t*)image);
+}
+
+static void cairo_image_release(void* image)
+{
+	cairo_surface_destroy((cairo_surface_t*)image);
+}
+
+static av_bool_t cairo_image_is_shared(void* image)
+{
+	return cairo_surface_get_reference_count((cairo_surface_t*)image) > 1;
+}
+
+/* cairo images decoded through the image cache */
+static av_image_type_t cairo_image_type =
+{
+	"cairo", cairo_image_decode, cairo_image_addref, cairo_image_release, cairo_image_is_shared
+};
+
+/*
+*	Create cairo graphics surface from file, the decoded image is shared through the image cache
+*	until the surface is written by begin or lock
+*/
+static av_result_t av_graphics_cairo_create_surface_from_file(av_graphics_p self, const char* filename, av_graphics_surface_p* ppsurface)
+{
+	av_result_t rc;
+	av_graphics_surface_p surface;
+	cairo_surface_t* image;
+	av_oop_p oop = O_oop(self);
+
+	if (AV_OK != (rc = av_image_cache_load(&cairo_image_type, AV_NULL, filename, (void**)&image)))
+		return rc;
+
+	if (AV_OK != (rc = oop->new(oop, "graphics_surface_cairo", (av_object_p*)&surface)))
+	{
+		cairo_surface_destroy(image);
+		return rc;
+	}
+
+	O_set_context_slot(surface, CONTEXT_GRAPHICS_SURFACE, image);
 
 	surface->graphics = (av_graphics_p)O_addref(self);
 	*ppsurface = surface;
@@ -187,23 +248,44 @@ static av_result_t av_graphics_cairo_create_surface_from_file(av_graphics_p self
 }
 
 /*
-*	Setup drawing environment on a target surface
+*	Setup drawing environment on a target surface.
+*	The cairo context is created on the first begin and kept with the surface,
+*	the drawing state is saved here and restored by end.
 */
 static av_result_t av_graphics_cairo_begin(av_graphics_p self, av_graphics_surface_p surface)
 {
+	av_result_t rc;
 	cairo_t* cairo;
 	cairo_surface_t* cairo_surface;
 	av_assert(surface, "surface argument is missing");
-	if (!(O_is_a(surface, "graphics_surface_cairo")))
+	if (!O_is_a_named(surface, "graphics_surface_cairo", &graphics_surface_cairo_class))
 		return AV_EARG;
+	/* never draws on the image shared through the image cache */
+	if (AV_OK != (rc = av_graphics_surface_cairo_detach(surface)))
+		return rc;
 	cairo_surface = O_context_surface(surface);
-	av_assert(cairo_surface, "cairo surface is not initialized properly");
 
-	cairo = cairo_create(cairo_surface);
+	cairo = (cairo_t*)cairo_surface_get_user_data(cairo_surface, &av_graphics_surface_cairo_context_key);
 	if (!cairo)
-		return AV_EMEM;
+	{
+		cairo = cairo_create(cairo_surface);
+		if (!cairo)
+			return AV_EMEM;
+		if (AV_OK != (rc = av_cairo_error_check("cairo_create", cairo_status(cairo))))
+		{
+			cairo_destroy(cairo);
+			return rc;
+		}
+		if (AV_OK != (rc = av_cairo_error_check("cairo_surface_set_user_data",
+			cairo_surface_set_user_data(cairo_surface, &av_graphics_surface_cairo_context_key, cairo, AV_NULL))))
+		{
+			cairo_destroy(cairo);
+			return rc;
+		}
+	}
+	cairo_save(cairo);
 
-	O_set_attr(self, CONTEXT, cairo);
+	O_set_context_slot(self, CONTEXT, cairo);
 
 	self->graphics_surface = (av_graphics_surface_p)O_addref(surface);
 	return AV_OK;
@@ -223,8 +305,18 @@ static void av_graphics_cairo_end(av_graphics_p self)
 {
 	cairo_t* cairo = O_context(self);
 	av_assert(cairo, "calling `end' method before `begin'");
-	cairo_destroy(cairo);
-	O_set_attr(self, CONTEXT, 0);
+	if (CAIRO_STATUS_SUCCESS == cairo_status(cairo))
+	{
+		/* the path is not part of the saved state */
+		cairo_new_path(cairo);
+		cairo_restore(cairo);
+	}
+	else
+	{
+		/* cairo context errors are permanent */
+		av_graphics_surface_cairo_drop_context(cairo_get_target(cairo));
+	}
+	O_set_context_slot(self, CONTEXT, 0);
 	O_release(self->graphics_surface);
 	self->graphics_surface = AV_NULL;
 }
@@ -263,7 +355,7 @@ static av_result_t av_graphics_cairo_pop_group(av_graphics_p self,
 		return rc;
 
 	p = cairo_pop_group(cairo);
-	O_set_attr(pattern, CONTEXT_GRAPHICS_PATTERN, p);
+	O_set_context_slot(pattern, CONTEXT_GRAPHICS_PATTERN, p);
 
 	if (AV_OK != (rc = av_cairo_error_check("cairo_pop_group", cairo_pattern_status(p))))
 	{
@@ -291,7 +383,7 @@ static av_result_t av_graphics_cairo_create_pattern_rgba(av_graphics_p self,
 		cairo_pattern_destroy(p);
 		return rc;
 	}
-	O_set_attr(pattern, CONTEXT_GRAPHICS_PATTERN, p);
+	O_set_context_slot(pattern, CONTEXT_GRAPHICS_PATTERN, p);
 
 	*ppattern = pattern;
 	return AV_OK;
@@ -314,7 +406,7 @@ static av_result_t av_graphics_cairo_create_pattern_linear
 		cairo_pattern_destroy(p);
 		return rc;
 	}
-	O_set_attr(pattern, CONTEXT_GRAPHICS_PATTERN, p);
+	O_set_context_slot(pattern, CONTEXT_GRAPHICS_PATTERN, p);
 
 	*ppattern = pattern;
 	return AV_OK;
@@ -341,7 +433,7 @@ static av_result_t av_graphics_cairo_create_pattern_radial
 		cairo_pattern_destroy(p);
 		return rc;
 	}
-	O_set_attr(pattern, CONTEXT_GRAPHICS_PATTERN, p);
+	O_set_context_slot(pattern, CONTEXT_GRAPHICS_PATTERN, p);
 
 	*ppattern = pattern;
 	return AV_OK;
@@ -838,27 +930,228 @@ static void av_graphics_cairo_set_color_rgba(av_graphics_p self, double r, doubl
 	cairo_set_source_rgba(cairo, r, g, b, a);
 }
 
+/*
+*	Text cache.
+*	Font faces are resolved once per family, slant and weight and carry
+*	their cache key as user data. Strings drawn with these faces are
+*	converted to glyphs once per face, font matrix and transformation and
+*	replayed with cairo_show_glyphs. The caches are shared by the cairo
+*	graphics objects, as the graphics service is used from a single thread.
+*/
+
+/* number of resolved font faces kept, each face costs 1 of the cache budget */
+#define FONT_FACE_CACHE_SIZE    32
+
+/* glyph run of a string positioned at the origin */
+typedef struct _text_run_t
+{
+	cairo_text_extents_t extents;
+	double               end_x;      /* current point after the run */
+	double               end_y;
+	int                  num_glyphs;
+	cairo_glyph_t        glyphs[1];
+} text_run_t, *text_run_p;
+
+static int _text_cache_refs = 0;
+static av_cache_p _font_faces = AV_NULL;   /* face key -> cairo_font_face_t* */
+static av_cache_p _text_runs = AV_NULL;    /* run key -> text_run_p */
+static cairo_user_data_key_t _font_face_key;
+
+/* scratch buffers reused between calls */
+static char* _run_key = AV_NULL;
+static int _run_key_size = 0;
+static cairo_glyph_t* _glyphs = AV_NULL;
+static int _glyphs_size = 0;
+
+static void font_face_free(void* value)
+{
+	cairo_font_face_destroy((cairo_font_face_t*)value);
+}
+
+static av_result_t text_cache_create(void)
+{
+	av_result_t rc;
+	if (_text_cache_refs++)
+		return AV_OK;
+
+	if (AV_OK != (rc = av_cache_create(FONT_FACE_CACHE_SIZE, font_face_free, &_font_faces)))
+	{
+		_text_cache_refs--;
+		return rc;
+	}
+	if (AV_OK != (rc = av_cache_create(AV_GRAPHICS_TEXT_CACHE_BUDGET, av_free, &_text_runs)))
+	{
+		_font_faces->destroy(_font_faces);
+		_font_faces = AV_NULL;
+		_text_cache_refs--;
+		return rc;
+	}
+	return AV_OK;
+}
+
+static void text_cache_destroy(void)
+{
+	if (--_text_cache_refs)
+		return;
+
+	_text_runs->destroy(_text_runs);
+	_font_faces->destroy(_font_faces);
+	_text_runs = AV_NULL;
+	_font_faces = AV_NULL;
+	av_free(_run_key);
+	av_free(_glyphs);
+	_run_key = AV_NULL;
+	_glyphs = AV_NULL;
+	_run_key_size = _glyphs_size = 0;
+}
+
+/* returns the text run key of string drawn with the current font or AV_NULL if not cacheable */
+static const char* text_run_key(cairo_t* cairo, const char* utf8)
+{
+	const char* face_key;
+	cairo_matrix_t font_matrix;
+	cairo_matrix_t ctm;
+	int size;
+
+	if (!utf8 || !*utf8)
+		return AV_NULL;
+
+	/* only faces resolved by set_font_face are known */
+	face_key = (const char*)cairo_font_face_get_user_data(cairo_get_font_face(cairo), &_font_face_key);
+	if (!face_key)
+		return AV_NULL;
+
+	cairo_get_font_matrix(cairo, &font_matrix);
+	cairo_get_matrix(cairo, &ctm);
+
+	size = av_strlen(face_key) + av_strlen(utf8) + 128;
+	if (size > _run_key_size)
+	{
+		char* run_key = (char*)av_realloc(_run_key, size);
+		if (!run_key)
+			return AV_NULL;
+		_run_key = run_key;
+		_run_key_size = size;
+	}
+	snprintf(_run_key, _run_key_size, "%s|%g %g %g %g|%g %g %g %g|%s", face_key,
+			 font_matrix.xx, font_matrix.yx, font_matrix.xy, font_matrix.yy,
+			 ctm.xx, ctm.yx, ctm.xy, ctm.yy, utf8);
+	return _run_key;
+}
+
+/* returns the cached glyph run of string drawn with the current font or AV_NULL if not cacheable */
+static text_run_p text_run_get(cairo_t* cairo, const char* utf8)
+{
+	const char* key;
+	text_run_p run;
+	cairo_glyph_t* glyphs = AV_NULL;
+	cairo_text_extents_t last_extents;
+	int num_glyphs = 0;
+	unsigned int bytes;
+
+	if (!_text_runs || 0 == (key = text_run_key(cairo, utf8)))
+		return AV_NULL;
+
+	if (0 != (run = (text_run_p)_text_runs->get(_text_runs, key)))
+		return run;
+
+	if (CAIRO_STATUS_SUCCESS != cairo_scaled_font_text_to_glyphs(cairo_get_scaled_font(cairo), 0, 0, utf8, -1,
+																 &glyphs, &num_glyphs, AV_NULL, AV_NULL, AV_NULL))
+		return AV_NULL;
+	if (0 == num_glyphs)
+	{
+		cairo_glyph_free(glyphs);
+		return AV_NULL;
+	}
+
+	bytes = sizeof(text_run_t) + (num_glyphs - 1) * sizeof(cairo_glyph_t);
+	if (0 == (run = (text_run_p)av_malloc(bytes)))
+	{
+		cairo_glyph_free(glyphs);
+		return AV_NULL;
+	}
+	av_memcpy((unsigned char*)run->glyphs, (unsigned char*)glyphs, num_glyphs * sizeof(cairo_glyph_t));
+	run->num_glyphs = num_glyphs;
+	cairo_glyph_free(glyphs);
+
+	/* the current point moves as with cairo_show_text */
+	cairo_glyph_extents(cairo, run->glyphs, num_glyphs, &run->extents);
+	cairo_glyph_extents(cairo, &run->glyphs[num_glyphs - 1], 1, &last_extents);
+	run->end_x = run->glyphs[num_glyphs - 1].x + last_extents.x_advance;
+	run->end_y = run->glyphs[num_glyphs - 1].y + last_extents.y_advance;
+
+	if (AV_OK != _text_runs->add(_text_runs, key, run, bytes + av_strlen(key)))
+	{
+		av_free(run);
+		return AV_NULL;
+	}
+	return run;
+}
+
+/* returns the run glyphs moved to the current point */
+static cairo_glyph_t* text_run_place(cairo_t* cairo, text_run_p run, double* px, double* py)
+{
+	int i;
+	if (run->num_glyphs > _glyphs_size)
+	{
+		cairo_glyph_t* glyphs = (cairo_glyph_t*)av_realloc(_glyphs, run->num_glyphs * sizeof(cairo_glyph_t));
+		if (!glyphs)
+			return AV_NULL;
+		_glyphs = glyphs;
+		_glyphs_size = run->num_glyphs;
+	}
+
+	cairo_get_current_point(cairo, px, py);
+	for (i = 0; i < run->num_glyphs; i++)
+	{
+		_glyphs[i].index = run->glyphs[i].index;
+		_glyphs[i].x = run->glyphs[i].x + *px;
+		_glyphs[i].y = run->glyphs[i].y + *py;
+	}
+	return _glyphs;
+}
+
 static void av_graphics_cairo_show_text(av_graphics_p self, const char* utf8)
 {
 	cairo_t* cairo = O_context(self);
+	text_run_p run;
+	cairo_glyph_t* glyphs;
+	double x, y;
 	av_assert(cairo, "method must be executed between `begin', `end' methods");
 
-	cairo_show_text(cairo, utf8);
+	if (0 == (run = text_run_get(cairo, utf8)) || 0 == (glyphs = text_run_place(cairo, run, &x, &y)))
+	{
+		cairo_show_text(cairo, utf8);
+		return;
+	}
+	cairo_show_glyphs(cairo, glyphs, run->num_glyphs);
+	cairo_move_to(cairo, x + run->end_x, y + run->end_y);
 }
 
 static void av_graphics_cairo_text_path(av_graphics_p self, const char* utf8)
 {
 	cairo_t* cairo = O_context(self);
+	text_run_p run;
+	cairo_glyph_t* glyphs;
+	double x, y;
 	av_assert(cairo, "method must be executed between `begin', `end' methods");
 
-	cairo_text_path(cairo, utf8);
+	if (0 == (run = text_run_get(cairo, utf8)) || 0 == (glyphs = text_run_place(cairo, run, &x, &y)))
+	{
+		cairo_text_path(cairo, utf8);
+		return;
+	}
+	cairo_glyph_path(cairo, glyphs, run->num_glyphs);
+	cairo_move_to(cairo, x + run->end_x, y + run->end_y);
 }
 
 static void av_graphics_cairo_show_image(av_graphics_p self, double x, double y, av_graphics_surface_p surface)
 {
 	cairo_t* cairo = O_context(self);
-	cairo_surface_t* cairo_surface = (cairo_surface_t*)O_context_surface(surface);
+	cairo_surface_t* cairo_surface;
 	av_assert(cairo, "method must be executed between `begin', `end' methods");
+	av_assert(O_is_a_named(surface, "graphics_surface_cairo", &graphics_surface_cairo_class), "image surface is not valid cairo surface");
+	cairo_surface = (cairo_surface_t*)O_context_surface(surface);
 	av_assert(cairo_surface, "image surface is not valid cairo surface");
 	cairo_set_source_surface(cairo, cairo_surface, SCALE_X(self, x), SCALE_Y(self, y));
 	cairo_paint(cairo);
@@ -876,9 +1169,13 @@ static av_result_t av_graphics_cairo_get_text_extents(av_graphics_p self,
 	int rc;
 	cairo_t* cairo = O_context(self);
 	cairo_text_extents_t text_extents;
+	text_run_p run;
 	av_assert(cairo, "method must be executed between `begin', `end' methods");
 
-	cairo_text_extents(cairo, utf8, &text_extents);
+	if (0 != (run = text_run_get(cairo, utf8)))
+		text_extents = run->extents;
+	else
+		cairo_text_extents(cairo, utf8, &text_extents);
 	if (CAIRO_STATUS_SUCCESS == (rc = cairo_status(cairo)))
 	{
 		if (pwidth)
@@ -906,6 +1203,9 @@ static av_result_t av_graphics_cairo_set_font_face(av_graphics_p self,
 	cairo_t* cairo = O_context(self);
 	cairo_font_slant_t cslant;
 	cairo_font_weight_t cweight;
+	cairo_font_face_t* face;
+	char face_key[256];
+	av_result_t rc;
 	av_assert(cairo, "method must be executed between `begin', `end' methods");
 
 	switch (slant)
@@ -935,8 +1235,33 @@ static av_result_t av_graphics_cairo_set_font_face(av_graphics_p self,
 			return AV_EARG;
 	}
 
-	cairo_select_font_face(cairo, fontface, cslant, cweight);
-	return av_cairo_error_check("cairo_select_font_face", cairo_status(cairo));
+	/* resolves the face once per family, slant and weight */
+	snprintf(face_key, sizeof(face_key), "%s|%d|%d", fontface, cslant, cweight);
+	if (0 == (face = (cairo_font_face_t*)_font_faces->get(_font_faces, face_key)))
+	{
+		char* user_key;
+		face = cairo_toy_font_face_create(fontface, cslant, cweight);
+		if (AV_OK != (rc = av_cairo_error_check("cairo_toy_font_face_create", cairo_font_face_status(face))))
+		{
+			cairo_font_face_destroy(face);
+			return rc;
+		}
+		if (0 == (user_key = av_strdup(face_key)))
+		{
+			cairo_font_face_destroy(face);
+			return AV_EMEM;
+		}
+		if (CAIRO_STATUS_SUCCESS != cairo_font_face_set_user_data(face, &_font_face_key, user_key, av_free))
+			av_free(user_key);
+		if (AV_OK != (rc = _font_faces->add(_font_faces, face_key, face, 1)))
+		{
+			cairo_font_face_destroy(face);
+			return rc;
+		}
+	}
+
+	cairo_set_font_face(cairo, face);
+	return av_cairo_error_check("cairo_set_font_face", cairo_status(cairo));
 }
 
 static av_result_t av_graphics_cairo_set_font_size(av_graphics_p self, int size)
@@ -953,6 +1278,19 @@ static av_result_t av_graphics_cairo_set_font_size(av_graphics_p self, int size)
 static void av_graphics_cairo_destructor(void* pgraphics)
 {
 	AV_UNUSED(pgraphics);
+	text_cache_destroy();
+}
+
+static void av_graphics_cairo_set_text_cache_budget(av_graphics_p self, unsigned int budget)
+{
+	AV_UNUSED(self);
+	_text_runs->set_budget(_text_runs, budget);
+}
+
+static void av_graphics_cairo_get_text_cache_stats(av_graphics_p self, av_cache_stats_p stats)
+{
+	AV_UNUSED(self);
+	_text_runs->get_stats(_text_runs, stats);
 }
 
 /* Initializes memory given by the input pointer with the graphics cairo class information */
@@ -1006,8 +1344,10 @@ static av_result_t av_graphics_cairo_constructor(av_object_p object)
 	self->get_text_extents         = av_graphics_cairo_get_text_extents;
 	self->set_font_face            = av_graphics_cairo_set_font_face;
 	self->set_font_size            = av_graphics_cairo_set_font_size;
+	self->set_text_cache_budget    = av_graphics_cairo_set_text_cache_budget;
+	self->get_text_cache_stats     = av_graphics_cairo_get_text_cache_stats;
 
-	return AV_OK;
+	return text_cache_create();
 }
 
 /* Registers Cairo graphics class into TORBA class repository */
@@ -1028,10 +1368,16 @@ AV_API av_result_t av_graphics_cairo_register_oop(av_oop_p oop)
 											  av_graphics_pattern_cairo_destructor)))
 		return rc;
 
+	if (AV_OK != (rc = oop->get_context_slot(oop, "graphics_pattern_cairo", &CONTEXT_GRAPHICS_PATTERN)))
+		return rc;
+
 	if (AV_OK != (rc = oop->define_class(oop, "graphics_cairo", "graphics", sizeof(av_graphics_t),
 		av_graphics_cairo_constructor, av_graphics_cairo_destructor)))
 		return rc;
 
+	if (AV_OK != (rc = oop->get_context_slot(oop, "graphics_cairo", &CONTEXT)))
+		return rc;
+
 	if (AV_OK != (rc = oop->new(oop, "graphics_cairo", (av_object_p*)&graphics)))
 		return rc;
 
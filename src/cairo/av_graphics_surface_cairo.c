@@ -14,7 +14,74 @@
 #include <cairo.h>
 #include "av_graphics_surface_cairo.h"
 
-#define O_context(o) ((cairo_surface_t*)O_attr(o, CONTEXT_GRAPHICS_SURFACE))
+#define O_context(o) ((cairo_surface_t*)O_context_slot(o, CONTEXT_GRAPHICS_SURFACE))
+
+int av_graphics_surface_cairo_context_slot = 0;
+cairo_user_data_key_t av_graphics_surface_cairo_context_key;
+cairo_user_data_key_t av_graphics_surface_cairo_cached_key;
+
+/*
+* The kept cairo context references its target surface,
+* so it is destroyed before the last surface reference is dropped
+*/
+void av_graphics_surface_cairo_drop_context(cairo_surface_t* cairo_surface)
+{
+	cairo_t* cairo = (cairo_t*)cairo_surface_get_user_data(cairo_surface, &av_graphics_surface_cairo_context_key);
+	if (cairo)
+	{
+		cairo_surface_set_user_data(cairo_surface, &av_graphics_surface_cairo_context_key, AV_NULL, AV_NULL);
+		cairo_destroy(cairo);
+	}
+}
+
+/*
+* The cached image stays read only for the other surfaces loading the same file,
+* once the cache has dropped it the surface is the only owner and keeps it
+*/
+av_result_t av_graphics_surface_cairo_detach(av_graphics_surface_p self)
+{
+	av_result_t rc;
+	cairo_t* cairo;
+	cairo_surface_t* cairo_surface = O_context(self);
+	cairo_surface_t* cairo_surface_copy;
+	av_assert(cairo_surface, "cairo surface is not initialized properly");
+
+	if (!cairo_surface_get_user_data(cairo_surface, &av_graphics_surface_cairo_cached_key))
+		return AV_OK;
+
+	if (1 == cairo_surface_get_reference_count(cairo_surface))
+	{
+		cairo_surface_set_user_data(cairo_surface, &av_graphics_surface_cairo_cached_key, AV_NULL, AV_NULL);
+		return AV_OK;
+	}
+
+	cairo_surface_copy = cairo_image_surface_create(cairo_image_surface_get_format(cairo_surface),
+													cairo_image_surface_get_width(cairo_surface),
+													cairo_image_surface_get_height(cairo_surface));
+	if (!cairo_surface_copy)
+		return AV_EMEM;
+	if (AV_OK != (rc = av_cairo_error_check("cairo_image_surface_create", cairo_surface_status(cairo_surface_copy))))
+	{
+		cairo_surface_destroy(cairo_surface_copy);
+		return rc;
+	}
+
+	cairo = cairo_create(cairo_surface_copy);
+	cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source_surface(cairo, cairo_surface, 0, 0);
+	cairo_paint(cairo);
+	rc = av_cairo_error_check("cairo_paint", cairo_status(cairo));
+	cairo_destroy(cairo);
+	if (AV_OK != rc)
+	{
+		cairo_surface_destroy(cairo_surface_copy);
+		return rc;
+	}
+
+	O_set_context_slot(self, CONTEXT_GRAPHICS_SURFACE, cairo_surface_copy);
+	cairo_surface_destroy(cairo_surface);
+	return AV_OK;
+}
 
 static av_result_t av_graphics_surface_cairo_set_size(av_surface_p self, int width, int height)
 {
@@ -23,8 +90,11 @@ static av_result_t av_graphics_surface_cairo_set_size(av_surface_p self, int wid
 	if (!cairo_surface_new)
 		return AV_EMEM;
 	if (cairo_surface_old)
+	{
+		av_graphics_surface_cairo_drop_context(cairo_surface_old);
 		cairo_surface_destroy(cairo_surface_old);
-	O_set_attr(self, CONTEXT_GRAPHICS_SURFACE, cairo_surface_new);
+	}
+	O_set_context_slot(self, CONTEXT_GRAPHICS_SURFACE, cairo_surface_new);
 	return AV_OK;
 }
 
@@ -39,16 +109,24 @@ static av_result_t av_graphics_surface_cairo_get_size(av_surface_p self, int* pw
 
 static av_result_t av_graphics_surface_cairo_lock(av_surface_p self, av_pixel_p* ppixels, int* ppitch)
 {
-	cairo_surface_t* cairo_surface = O_context(self);
-	av_assert(cairo_surface, "cairo surface is not initialized properly");
-	*ppixels = (int*)cairo_image_surface_get_data(cairo_surface);
+	av_result_t rc;
+	cairo_surface_t* cairo_surface;
+	/* the pixels may be written until unlock */
+	if (AV_OK != (rc = av_graphics_surface_cairo_detach((av_graphics_surface_p)self)))
+		return rc;
+	cairo_surface = O_context(self);
+	/* completes the pending drawing before the pixels are accessed directly */
+	cairo_surface_flush(cairo_surface);
+	*ppixels = (av_pixel_p)cairo_image_surface_get_data(cairo_surface);
 	*ppitch = cairo_image_surface_get_stride(cairo_surface);
 	return AV_OK;
 }
 
-static av_result_t av_graphics_surface_cairo_unlock(av_surface_p psurface)
+static av_result_t av_graphics_surface_cairo_unlock(av_surface_p self)
 {
-	AV_UNUSED(psurface);
+	cairo_surface_t* cairo_surface = O_context(self);
+	av_assert(cairo_surface, "cairo surface is not initialized properly");
+	cairo_surface_mark_dirty(cairo_surface);
 	return AV_OK;
 }
 
@@ -69,7 +147,7 @@ static av_result_t av_graphics_surface_cairo_create_pattern(av_graphics_surface_
 		return rc;
 	}
 
-	O_set_attr(pattern, CONTEXT_GRAPHICS_PATTERN, p);
+	O_set_context_slot(pattern, CONTEXT_GRAPHICS_PATTERN, p);
 
 	*ppattern = pattern;
 	return AV_OK;
@@ -94,7 +172,10 @@ static void av_graphics_surface_cairo_destructor(av_object_p self)
 		O_release(graphics_surface->graphics);
 
 	if (cairo_surface)
+	{
+		av_graphics_surface_cairo_drop_context(cairo_surface);
 		cairo_surface_destroy(cairo_surface);
+	}
 }
 
 static av_result_t av_graphics_surface_cairo_constructor(av_object_p object)
@@ -113,11 +194,15 @@ static av_result_t av_graphics_surface_cairo_constructor(av_object_p object)
 /* Registers Cairo video surface class into OOP class repository */
 av_result_t av_graphics_surface_cairo_register_oop(av_oop_p oop)
 {
+	av_result_t rc;
 	av_surface_register_oop(oop);
-	return oop->define_class(oop, "graphics_surface_cairo", "surface", // FIXME: surface or graphics_surface
+	if (AV_OK != (rc = oop->define_class(oop, "graphics_surface_cairo", "surface", // FIXME: surface or graphics_surface
 								  sizeof(av_graphics_surface_t),
 								  av_graphics_surface_cairo_constructor,
-								  av_graphics_surface_cairo_destructor);
+								  av_graphics_surface_cairo_destructor)))
+		return rc;
+
+	return oop->get_context_slot(oop, "graphics_surface_cairo", &CONTEXT_GRAPHICS_SURFACE);
 }
 
 #endif /* WITH_GRAPHICS_CAIRO */
@@ -12,13 +12,30 @@
 #ifndef __AV_GRAPHICS_SURFACE_CAIRO_H
 #define __AV_GRAPHICS_SURFACE_CAIRO_H
 
+#include <cairo.h>
 #include <av_oop.h>
 #include <av_graphics.h>
 #include "av_graphics_cairo.h"
 
 av_result_t av_graphics_surface_cairo_register_oop(av_oop_p);
 
-#define CONTEXT_GRAPHICS_SURFACE "graphics_surface_cairo_ctx"
-#define CONTEXT_GRAPHICS_PATTERN "graphics_pattern_cairo_ctx"
+/* cairo surface and pattern context slots assigned on class registration */
+extern int av_graphics_surface_cairo_context_slot;
+extern int av_graphics_pattern_cairo_context_slot;
+
+#define CONTEXT_GRAPHICS_SURFACE av_graphics_surface_cairo_context_slot
+#define CONTEXT_GRAPHICS_PATTERN av_graphics_pattern_cairo_context_slot
+
+/* cairo context kept in the cairo surface user data between graphics begin and end */
+extern cairo_user_data_key_t av_graphics_surface_cairo_context_key;
+
+/* destroys the cairo context kept for cairo surface */
+void av_graphics_surface_cairo_drop_context(cairo_surface_t* cairo_surface);
+
+/* marks the cairo images shared through the image cache */
+extern cairo_user_data_key_t av_graphics_surface_cairo_cached_key;
+
+/* replaces the image shared through the image cache with a private copy before writing to the surface */
+av_result_t av_graphics_surface_cairo_detach(av_graphics_surface_p self);
 
 #endif /* __AV_GRAPHICS_SURFACE_CAIRO_H */
@@ -0,0 +1,254 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_cache.c                                         */
+/* Description:   Least recently used cache                          */
+/*                                                                   */
+/*********************************************************************/
+
+#include <av_cache.h>
+#include <av_hash.h>
+#include <av_stdc.h>
+
+/* cached value linked in the recently used order */
+typedef struct _cache_entry_t
+{
+	char*                   key;
+	void*                   value;
+	unsigned int            bytes;
+	unsigned int            pins;
+	struct _cache_entry_t*  prev;   /* more recently used */
+	struct _cache_entry_t*  next;   /* less recently used */
+} cache_entry_t, *cache_entry_p;
+
+typedef struct _cache_ctx_t
+{
+	av_hash_p        entries;       /* key -> cache_entry_p */
+	cache_entry_p    first;         /* most recently used */
+	cache_entry_p    last;          /* least recently used */
+	av_cache_free_t  free_value;
+	av_cache_busy_t  is_busy;
+	av_cache_stats_t stats;
+} cache_ctx_t, *cache_ctx_p;
+
+static void cache_unlink(cache_ctx_p ctx, cache_entry_p entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		ctx->first = entry->next;
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		ctx->last = entry->prev;
+	entry->prev = entry->next = AV_NULL;
+}
+
+static void cache_link_first(cache_ctx_p ctx, cache_entry_p entry)
+{
+	entry->prev = AV_NULL;
+	entry->next = ctx->first;
+	if (ctx->first)
+		ctx->first->prev = entry;
+	else
+		ctx->last = entry;
+	ctx->first = entry;
+}
+
+/* unlinks, releases and frees entry already removed from the hash table */
+static void cache_drop(cache_ctx_p ctx, cache_entry_p entry)
+{
+	cache_unlink(ctx, entry);
+	ctx->stats.count--;
+	ctx->stats.bytes -= entry->bytes;
+	if (entry->pins)
+		ctx->stats.pinned--;
+	if (ctx->free_value)
+		ctx->free_value(entry->value);
+	av_free(entry->key);
+	av_free(entry);
+}
+
+/* evicts the least recently used entries except keep, pinned and busy until fitting the budget */
+static void cache_evict(cache_ctx_p ctx, cache_entry_p keep)
+{
+	cache_entry_p entry = ctx->last;
+	while (entry && ctx->stats.bytes > ctx->stats.budget)
+	{
+		cache_entry_p prev = entry->prev;
+		if (entry != keep && !entry->pins && !(ctx->is_busy && ctx->is_busy(entry->value)))
+		{
+			ctx->entries->remove(ctx->entries, entry->key);
+			cache_drop(ctx, entry);
+			ctx->stats.evictions++;
+		}
+		entry = prev;
+	}
+}
+
+static av_result_t av_cache_add(av_cache_p self, const char* key, void* value, unsigned int bytes)
+{
+	cache_ctx_p ctx = (cache_ctx_p)self->context;
+	cache_entry_p entry;
+	av_result_t rc;
+
+	if (!key || !*key)
+		return AV_EARG;
+
+	if (0 != (entry = (cache_entry_p)ctx->entries->remove(ctx->entries, key)))
+		cache_drop(ctx, entry);
+
+	if (0 == (entry = (cache_entry_p)av_calloc(1, sizeof(cache_entry_t))))
+		return AV_EMEM;
+	if (0 == (entry->key = av_strdup(key)))
+	{
+		av_free(entry);
+		return AV_EMEM;
+	}
+	if (AV_OK != (rc = ctx->entries->add(ctx->entries, entry->key, entry)))
+	{
+		av_free(entry->key);
+		av_free(entry);
+		return rc;
+	}
+
+	entry->value = value;
+	entry->bytes = bytes;
+	cache_link_first(ctx, entry);
+	ctx->stats.count++;
+	ctx->stats.bytes += bytes;
+	cache_evict(ctx, entry);
+	return AV_OK;
+}
+
+static void* av_cache_get(av_cache_p self, const char* key)
+{
+	cache_ctx_p ctx = (cache_ctx_p)self->context;
+	cache_entry_p entry = (key && *key) ? (cache_entry_p)ctx->entries->get(ctx->entries, key) : AV_NULL;
+
+	if (!entry)
+	{
+		ctx->stats.misses++;
+		return AV_NULL;
+	}
+	ctx->stats.hits++;
+	if (entry != ctx->first)
+	{
+		cache_unlink(ctx, entry);
+		cache_link_first(ctx, entry);
+	}
+	return entry->value;
+}
+
+static av_bool_t av_cache_remove(av_cache_p self, const char* key)
+{
+	cache_ctx_p ctx = (cache_ctx_p)self->context;
+	cache_entry_p entry = (key && *key) ? (cache_entry_p)ctx->entries->remove(ctx->entries, key) : AV_NULL;
+
+	if (!entry)
+		return AV_FALSE;
+	cache_drop(ctx, entry);
+	return AV_TRUE;
+}
+
+static av_bool_t av_cache_pin(av_cache_p self, const char* key, av_bool_t pin)
+{
+	cache_ctx_p ctx = (cache_ctx_p)self->context;
+	cache_entry_p entry = (key && *key) ? (cache_entry_p)ctx->entries->get(ctx->entries, key) : AV_NULL;
+
+	if (!entry)
+		return AV_FALSE;
+	if (pin)
+	{
+		if (0 == entry->pins++)
+			ctx->stats.pinned++;
+	}
+	else if (entry->pins && 0 == --entry->pins)
+	{
+		ctx->stats.pinned--;
+		cache_evict(ctx, AV_NULL);
+	}
+	return AV_TRUE;
+}
+
+static void av_cache_clear(av_cache_p self)
+{
+	cache_ctx_p ctx = (cache_ctx_p)self->context;
+	while (ctx->first)
+	{
+		cache_entry_p entry = ctx->first;
+		ctx->entries->remove(ctx->entries, entry->key);
+		cache_drop(ctx, entry);
+	}
+}
+
+static void av_cache_set_budget(av_cache_p self, unsigned int budget)
+{
+	cache_ctx_p ctx = (cache_ctx_p)self->context;
+	ctx->stats.budget = budget;
+	cache_evict(ctx, AV_NULL);
+}
+
+static void av_cache_get_stats(av_cache_p self, av_cache_stats_p stats)
+{
+	cache_ctx_p ctx = (cache_ctx_p)self->context;
+	*stats = ctx->stats;
+}
+
+static void av_cache_destroy(av_cache_p self)
+{
+	cache_ctx_p ctx = (cache_ctx_p)self->context;
+	if (ctx->entries)
+	{
+		av_cache_clear(self);
+		ctx->entries->destroy(ctx->entries);
+	}
+	av_free(ctx);
+	av_free(self);
+}
+
+av_result_t av_cache_create_ex(unsigned int budget, av_cache_free_t free_value, av_cache_busy_t is_busy,
+							  av_cache_p* ppcache)
+{
+	av_cache_p self;
+	cache_ctx_p ctx;
+	av_result_t rc;
+
+	if (0 == (self = (av_cache_p)av_calloc(1, sizeof(av_cache_t))))
+		return AV_EMEM;
+	if (0 == (ctx = (cache_ctx_p)av_calloc(1, sizeof(cache_ctx_t))))
+	{
+		av_free(self);
+		return AV_EMEM;
+	}
+
+	ctx->free_value    = free_value;
+	ctx->is_busy       = is_busy;
+	ctx->stats.budget  = budget;
+
+	self->context      = ctx;
+	self->add          = av_cache_add;
+	self->get          = av_cache_get;
+	self->remove       = av_cache_remove;
+	self->pin          = av_cache_pin;
+	self->clear        = av_cache_clear;
+	self->set_budget   = av_cache_set_budget;
+	self->get_stats    = av_cache_get_stats;
+	self->destroy      = av_cache_destroy;
+
+	if (AV_OK != (rc = av_hash_create_ex(AV_HASH_CAPACITY_SMALL, AV_HASH_KEY_STRING, AV_HASH_UNSYNCHRONIZED, &ctx->entries)))
+	{
+		av_cache_destroy(self);
+		return rc;
+	}
+
+	*ppcache = self;
+	return AV_OK;
+}
+
+av_result_t av_cache_create(unsigned int budget, av_cache_free_t free_value, av_cache_p* ppcache)
+{
+	return av_cache_create_ex(budget, free_value, AV_NULL, ppcache);
+}
@@ -11,199 +11,364 @@
 /*                                                                   */
 /*********************************************************************/
 
-#include <math.h>
 #include <av_hash.h>
 #include <av_thread.h>
 #include <av_stdc.h>
+#include <string.h>
 
-/* Table is sized by primes to minimise clustering.
-   See: http://planetmath.org/encyclopedia/GoodHashTablePrimes.html */
-static const unsigned int sizes[] = 
+/*
+	Robin hood double hashing over a prime sized table.
+	The home slot is the hash code modulo the table size, so string keys
+	sharing a prefix land in nearby slots, and collisions continue with a step
+	derived from the hash code, so such runs of keys do not pile up into long
+	clusters. Every record caches its hash code and its probe count, which
+	lets lookups stop at the first record probed fewer times than the key.
+	Hash code 0 marks an empty slot, removed records are kept as tombstones
+	until the next rehash.
+*/
+
+/* rehash when used slots exceed capacity * LOAD_NUM / LOAD_DEN */
+#define HASH_LOAD_NUM 2
+#define HASH_LOAD_DEN 3
+
+#define HASH_LOCK_READ(h)  if ((h)->mutex) (h)->mutex->lock_read((h)->mutex)
+#define HASH_LOCK_WRITE(h) if ((h)->mutex) (h)->mutex->lock_write((h)->mutex)
+#define HASH_UNLOCK(h)     if ((h)->mutex) (h)->mutex->unlock((h)->mutex)
+
+/* dist flag of a removed record */
+#define HASH_DELETED 0x80000000U
+#define HASH_DIST(rec) ((rec)->dist & ~HASH_DELETED)
+
+/* probe step of a hash code, never 0 and below the prime capacity */
+#define HASH_STEP(h, code) (1 + ((code) * 2654435769U) % ((h)->capacity - 1))
+
+/* table sizes, primes about doubling and far from powers of two */
+static const unsigned int hash_sizes[] =
 {
-	53, 97, 193, 389, 769, 1543, 3079, 6151, 12289, 24593, 49157, 98317,
+	17, 53, 97, 193, 389, 769, 1543, 3079, 6151, 12289, 24593, 49157, 98317,
 	196613, 393241, 786433, 1572869, 3145739, 6291469, 12582917, 25165843,
 	50331653, 100663319, 201326611, 402653189, 805306457, 1610612741
 };
+#define HASH_SIZES_COUNT (sizeof(hash_sizes) / sizeof(hash_sizes[0]))
 
-static const unsigned int sizes_count = sizeof(sizes) / sizeof(sizes[0]);
-static const float load_factor = 0.65f;
-
-struct record 
+struct record
 {
 	unsigned int hash;
-	char *key;
+	unsigned int dist;
+	void *key;
 	void *value;
 };
 
-struct hash 
+struct hash
 {
 	struct record *records;
 	unsigned int records_count;
+	unsigned int deleted_count;
+	unsigned int capacity;
 	unsigned int size_index;
 	unsigned int current_record;
+	av_hash_key_t keytype;
 	av_rwmutex_p mutex;
 };
 
-static av_result_t hash_grow(av_hash_p self)
+/* algorithm djb2 */
+static unsigned int strhash(const char *str)
 {
-	unsigned int i;
-	struct record *old_recs;
-	unsigned int old_recs_length;
-	struct hash *h = (struct hash *)self->context;
-	
-	av_assert(h, "hash is not properly initialized");
-	
-	old_recs_length = sizes[h->size_index];
-	old_recs = h->records;
-	
-	if (h->size_index == sizes_count - 1)
+	unsigned int c;
+	unsigned int hash = 5381;
+	while ((c = (unsigned char)*str++))
+		hash = hash * 33 + c;
+	return hash;
+}
+
+/* mixes pointer or integer bits so aligned pointers and sequential integers spread over the table */
+static unsigned int inthash(const void *key)
+{
+	uint64_t x = (uint64_t)(uintptr_t)key;
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	return (unsigned int)x;
+}
+
+static unsigned int hash_code(struct hash *h, const void *key)
+{
+	unsigned int code = (AV_HASH_KEY_STRING == h->keytype) ? strhash((const char*)key) : inthash(key);
+	return code ? code : 1;
+}
+
+/* slot following ind in the probe sequence of step */
+static unsigned int hash_next(struct hash *h, unsigned int ind, unsigned int step)
+{
+	ind += step;
+	return (ind >= h->capacity) ? ind - h->capacity : ind;
+}
+
+/* returns the slot index of the key or -1 if not found */
+static int hash_find(struct hash *h, unsigned int code, const void *key)
+{
+	unsigned int ind = code % h->capacity;
+	unsigned int dist = 0;
+	unsigned int step = 0;
+	struct record *rec;
+
+	while ((rec = &h->records[ind])->hash)
 	{
-		/* too big hash table, the most probably caused by an application bug */
-		return AV_EMEM; 
+		/* a record probed fewer times than the key means the key is absent */
+		if (HASH_DIST(rec) < dist)
+			break;
+		if (code == rec->hash && !(rec->dist & HASH_DELETED))
+		{
+			if (AV_HASH_KEY_STRING == h->keytype)
+			{
+				if (0 == strcmp((const char*)key, (const char*)rec->key))
+					return (int)ind;
+			}
+			else if (key == rec->key)
+				return (int)ind;
+		}
+		if (!step)
+			step = HASH_STEP(h, code);
+		ind = hash_next(h, ind, step);
+		dist++;
 	}
-	
-	if (0 == (h->records = calloc(sizes[++h->size_index], sizeof(struct record))))
+	return -1;
+}
+
+/* inserts record known to be absent, without growing */
+static void hash_insert(struct hash *h, unsigned int code, void *key, void *value)
+{
+	struct record ins;
+	struct record *rec;
+	unsigned int ind = code % h->capacity;
+
+	ins.hash  = code;
+	ins.dist  = 0;
+	ins.key   = key;
+	ins.value = value;
+
+	while ((rec = &h->records[ind])->hash)
 	{
-		h->records = old_recs;
-		return AV_EMEM;
+		if (rec->dist & HASH_DELETED)
+		{
+			/* reuse a tombstone probed no more times than the inserted record */
+			if (HASH_DIST(rec) <= ins.dist)
+			{
+				h->deleted_count--;
+				break;
+			}
+		}
+		else if (rec->dist < ins.dist)
+		{
+			/* steal the slot from the richer record and continue inserting it */
+			struct record trec = *rec;
+			*rec = ins;
+			ins = trec;
+		}
+		ind = hash_next(h, ind, HASH_STEP(h, ins.hash));
+		ins.dist++;
 	}
-	
+	*rec = ins;
+	h->records_count++;
+}
+
+/* replaces the records with an empty table, h is left unchanged on failure */
+static av_result_t hash_alloc(struct hash *h, unsigned int size_index)
+{
+	unsigned int capacity = hash_sizes[size_index];
+	struct record *records = (struct record*)calloc(capacity, sizeof(struct record));
+	if (0 == records)
+		return AV_EMEM;
+
+	h->records = records;
+	h->capacity = capacity;
+	h->size_index = size_index;
 	h->records_count = 0;
-	
-	/* rehash table */
-	for (i=0; i < old_recs_length; i++)
+	h->deleted_count = 0;
+	return AV_OK;
+}
+
+/* rebuilds the table without tombstones, growing it unless they took most of the used slots */
+static av_result_t hash_rehash(struct hash *h)
+{
+	unsigned int i;
+	struct record *old_recs = h->records;
+	unsigned int old_capacity = h->capacity;
+	unsigned int size_index = h->size_index;
+	av_result_t rc;
+
+	if (h->records_count >= h->deleted_count)
+		size_index++;
+
+	if (size_index >= HASH_SIZES_COUNT)
 	{
-		if (old_recs[i].hash && old_recs[i].key)
-		{
-			self->add(self, old_recs[i].key, old_recs[i].value);
-			av_free(old_recs[i].key);
-		}
+		/* too big hash table, the most probably caused by an application bug */
+		return AV_EMEM;
 	}
-	
+
+	/* the old table is kept on failure */
+	if (AV_OK != (rc = hash_alloc(h, size_index)))
+		return rc;
+
+	/* rehash table reusing the cached hash codes */
+	for (i=0; i < old_capacity; i++)
+		if (old_recs[i].hash && !(old_recs[i].dist & HASH_DELETED))
+			hash_insert(h, old_recs[i].hash, old_recs[i].key, old_recs[i].value);
+
 	av_free(old_recs);
-	
 	return AV_OK;
 }
 
-/* algorithm djb2 */
-static unsigned int strhash(const char *str)
+static av_bool_t hash_key_valid(struct hash *h, const void *key)
 {
-	int c;
-	int hash = 5381;
-	while ((c = *str++))
-		hash = hash * 33 + c;
-	return hash == 0 ? 1 : hash;
+	if (AV_HASH_KEY_STRING == h->keytype)
+		return (key && *(const char*)key);
+	return AV_TRUE;
 }
 
-static av_result_t av_hash_add(av_hash_p self, const char* key, void* value)
+static unsigned int av_hash_hash(av_hash_p self, const void* key)
 {
 	struct hash *h = (struct hash *)self->context;
-	struct record *recs;
-	int rc;
-	unsigned int off, ind, size, code;
-	
 	av_assert(h, "hash is not properly initialized");
-	
-	if ((0 == key) || (0 == *key))
-		return AV_EARG;
-	
-	h->mutex->lock_write(h->mutex);
-	if (h->records_count > sizes[h->size_index] * load_factor)
+	return hash_code(h, key);
+}
+
+/* hash_add, hash_get and hash_remove expect a valid key */
+static av_result_t hash_add(struct hash *h, unsigned int code, const void* key, void* value)
+{
+	av_result_t rc = AV_OK;
+	int ind;
+
+	HASH_LOCK_WRITE(h);
+	if (0 <= (ind = hash_find(h, code, key)))
 	{
-		if (AV_OK != (rc = hash_grow(self)))
-		{
-			h->mutex->unlock(h->mutex);
-			return rc;
-		}
+		/* replaces value of existing key */
+		h->records[ind].value = value;
 	}
-
-	code = strhash(key);
-	recs = h->records;
-	size = sizes[h->size_index];
-	
-	ind = code % size;
-	off = 0;
-	
-	while (recs[ind].key)
+	else
 	{
-		ind = (code + (int)pow(++off,2)) % size;
+		void *hkey = (void*)key;
+		if (h->records_count + h->deleted_count >= h->capacity / HASH_LOAD_DEN * HASH_LOAD_NUM)
+			rc = hash_rehash(h);
+
+		if (AV_OK == rc && AV_HASH_KEY_STRING == h->keytype)
+			if (0 == (hkey = av_strdup((const char*)key)))
+				rc = AV_EMEM;
+
+		if (AV_OK == rc)
+			hash_insert(h, code, hkey, value);
 	}
-	
-	recs[ind].hash  = code;
-	recs[ind].key   = av_strdup(key);
-	recs[ind].value = value;
-	
-	h->records_count++;
-	h->mutex->unlock(h->mutex);
+	HASH_UNLOCK(h);
 
-	return AV_OK;
+	return rc;
 }
 
-static void* av_hash_get(av_hash_p self, const char* key)
+static void* hash_get(struct hash *h, unsigned int code, const void* key)
 {
-	struct hash *h = (struct hash *)self->context;
-	struct record *recs;
 	void * value = AV_NULL;
-	unsigned int off, ind, size;
-	unsigned int code = strhash(key);
+	int ind;
 
-	av_assert(h, "hash is not properly initialized");
+	HASH_LOCK_READ(h);
+	if (0 <= (ind = hash_find(h, code, key)))
+		value = h->records[ind].value;
+	HASH_UNLOCK(h);
 
-	h->mutex->lock_read(h->mutex);
-	recs = h->records;
-	size = sizes[h->size_index];
-	ind  = code % size;
-	off  = 0;
-	/* 
-		search on hash which remains even if a record has been removed,
-		so hash_remove() does not need to move any collision records
-	*/
-	while (recs[ind].hash) 
+	return value;
+}
+
+static void* hash_remove(struct hash *h, unsigned int code, const void* key)
+{
+	void * value = AV_NULL;
+	int ind;
+
+	HASH_LOCK_WRITE(h);
+	if (0 <= (ind = hash_find(h, code, key)))
 	{
-		if ((code == recs[ind].hash) && recs[ind].key && 0 == av_strcmp(key, recs[ind].key))
-		{
-			value = recs[ind].value;
-			break;
-		}
-		ind = (code + (int)pow(++off,2)) % size;
+		struct record *rec = &h->records[ind];
+
+		value = rec->value;
+		if (AV_HASH_KEY_STRING == h->keytype)
+			av_free(rec->key);
+
+		/* leave a tombstone so the probe sequences passing this slot stay intact */
+		rec->dist |= HASH_DELETED;
+		rec->key = AV_NULL;
+		rec->value = AV_NULL;
+		h->deleted_count++;
+		h->records_count--;
 	}
-	h->mutex->unlock(h->mutex);
+	HASH_UNLOCK(h);
 
 	return value;
 }
 
-static void* av_hash_remove(av_hash_p self, const char* key)
+static av_result_t av_hash_add_hashed(av_hash_p self, unsigned int code, const void* key, void* value)
 {
 	struct hash *h = (struct hash *)self->context;
-	unsigned int code = strhash(key);
-	struct record *recs;
-	void * value = AV_NULL;
-	unsigned int off, ind, size;
+	av_assert(h, "hash is not properly initialized");
+	if (!hash_key_valid(h, key))
+		return AV_EARG;
+	return hash_add(h, code, key, value);
+}
 
+static void* av_hash_get_hashed(av_hash_p self, unsigned int code, const void* key)
+{
+	struct hash *h = (struct hash *)self->context;
 	av_assert(h, "hash is not properly initialized");
+	if (!hash_key_valid(h, key))
+		return AV_NULL;
+	return hash_get(h, code, key);
+}
 
-	h->mutex->lock_write(h->mutex);
-	recs = h->records;
-	size = sizes[h->size_index];
-	ind = code % size;
-	off = 0;
-	while (recs[ind].hash)
-	{
-		if ((code == recs[ind].hash) && recs[ind].key && 0 == av_strcmp(key, recs[ind].key))
-		{
-			/* do not erase hash, so probes for collisions succeed */
-			value = recs[ind].value;
-			av_free(recs[ind].key);
-			recs[ind].key = 0;
-			recs[ind].value = 0;
-			h->records_count--;
-			break;
-		}
-		ind = (code + (int)pow(++off, 2)) % size;
-	}
-	h->mutex->unlock(h->mutex);
+static void* av_hash_remove_hashed(av_hash_p self, unsigned int code, const void* key)
+{
+	struct hash *h = (struct hash *)self->context;
+	av_assert(h, "hash is not properly initialized");
+	if (!hash_key_valid(h, key))
+		return AV_NULL;
+	return hash_remove(h, code, key);
+}
 
-	return value;
+static av_result_t av_hash_add_key(av_hash_p self, const void* key, void* value)
+{
+	struct hash *h = (struct hash *)self->context;
+	av_assert(h, "hash is not properly initialized");
+	if (!hash_key_valid(h, key))
+		return AV_EARG;
+	return hash_add(h, hash_code(h, key), key, value);
+}
+
+static void* av_hash_get_key(av_hash_p self, const void* key)
+{
+	struct hash *h = (struct hash *)self->context;
+	av_assert(h, "hash is not properly initialized");
+	if (!hash_key_valid(h, key))
+		return AV_NULL;
+	return hash_get(h, hash_code(h, key), key);
+}
+
+static void* av_hash_remove_key(av_hash_p self, const void* key)
+{
+	struct hash *h = (struct hash *)self->context;
+	av_assert(h, "hash is not properly initialized");
+	if (!hash_key_valid(h, key))
+		return AV_NULL;
+	return hash_remove(h, hash_code(h, key), key);
+}
+
+static av_result_t av_hash_add(av_hash_p self, const char* key, void* value)
+{
+	return av_hash_add_key(self, key, value);
+}
+
+static void* av_hash_get(av_hash_p self, const char* key)
+{
+	return av_hash_get_key(self, key);
+}
+
+static void* av_hash_remove(av_hash_p self, const char* key)
+{
+	return av_hash_remove_key(self, key);
 }
 
 static unsigned int av_hash_size(av_hash_p self)
@@ -211,9 +376,9 @@ static unsigned int av_hash_size(av_hash_p self)
 	struct hash *h = (struct hash *)self->context;
 	unsigned int size;
 	av_assert(h, "hash is not properly initialized");
-	h->mutex->lock_read(h->mutex);
+	HASH_LOCK_READ(h);
 	size = h->records_count;
-	h->mutex->unlock(h->mutex);
+	HASH_UNLOCK(h);
 
 	return size;
 }
@@ -221,23 +386,67 @@ static unsigned int av_hash_size(av_hash_p self)
 static void av_hash_destroy(av_hash_p self)
 {
 	struct hash *h = (struct hash *)self->context;
-	int records_size, i;
-	av_assert(h && h->records && h->mutex, "hash is not properly initialized");
-	av_assert(AV_OK == h->mutex->trylock_write(h->mutex), "hash is busy during destruction");
+	unsigned int i;
+	av_result_t rc;
+	av_assert(h && h->records, "hash is not properly initialized");
+	if (h->mutex)
+	{
+		rc = h->mutex->trylock_write(h->mutex);
+		av_assert(AV_OK == rc, "hash is busy during destruction");
+	}
 
 	/* free keys */
-	records_size = sizes[h->size_index];
-	for (i=0; i < records_size; i++)
-		if (h->records[i].key)
-			av_free(h->records[i].key);
+	if (AV_HASH_KEY_STRING == h->keytype)
+		for (i=0; i < h->capacity; i++)
+			if (h->records[i].hash && !(h->records[i].dist & HASH_DELETED))
+				av_free(h->records[i].key);
 
 	av_free(h->records);
-	av_assert(AV_OK == h->mutex->unlock(h->mutex), "unable to unlock the hash mutex");
-	h->mutex->destroy(h->mutex);
+	if (h->mutex)
+	{
+		rc = h->mutex->unlock(h->mutex);
+		av_assert(AV_OK == rc, "unable to unlock the hash mutex");
+		h->mutex->destroy(h->mutex);
+		AV_UNUSED(rc);
+	}
 	av_free(h);
 	av_free(self);
 }
 
+/* advances cursor to the next record, expects the table locked */
+static av_bool_t hash_cursor_next(struct hash *h, unsigned int *index, const void** key, void** value)
+{
+	while ((*index < h->capacity) && (0 == h->records[*index].hash || (h->records[*index].dist & HASH_DELETED)))
+	{
+		(*index)++;
+	}
+	if (*index < h->capacity)
+	{
+		*key = h->records[*index].key;
+		*value = h->records[*index].value;
+		(*index)++;
+		return AV_TRUE;
+	}
+	return AV_FALSE;
+}
+
+static void av_hash_cursor_first(av_hash_p self, av_hash_cursor_p cursor)
+{
+	AV_UNUSED(self);
+	cursor->index = 0;
+}
+
+static av_bool_t av_hash_cursor_next(av_hash_p self, av_hash_cursor_p cursor, const void** key, void** value)
+{
+	struct hash *h = (struct hash *)self->context;
+	av_bool_t res;
+	av_assert(h, "hash is not properly initialized");
+	HASH_LOCK_READ(h);
+	res = hash_cursor_next(h, &cursor->index, key, value);
+	HASH_UNLOCK(h);
+	return res;
+}
+
 static void av_hash_first(av_hash_p self)
 {
 	struct hash *h = (struct hash *)self->context;
@@ -247,75 +456,77 @@ static void av_hash_first(av_hash_p self)
 static av_bool_t av_hash_next(av_hash_p self, const char** key, void** value)
 {
 	struct hash *h = (struct hash *)self->context;
-	unsigned int records_size = sizes[h->size_index];
-	while ((h->current_record < records_size) && (0 == h->records[h->current_record].hash))
-	{
-		h->current_record++;
-	}
-	if (h->current_record < records_size)
-	{
-		*key = h->records[h->current_record].key;
-		*value = h->records[h->current_record].value;
-		h->current_record++;
-		return AV_TRUE;
-	}
-	return AV_FALSE;
+	return hash_cursor_next(h, &h->current_record, (const void**)key, value);
 }
 
-av_result_t av_hash_create(unsigned int capacity, av_hash_p *pphash)
+av_result_t av_hash_create_ex(unsigned int capacity, av_hash_key_t keytype, int flags, av_hash_p *pphash)
 {
 	av_hash_p self;
 	struct hash *h;
-	unsigned int i, sind=0;
+	unsigned int size_index = 0;
 	av_result_t rc;
-	
+
 	if (0 == (self = (av_hash_p)av_malloc(sizeof(av_hash_t))))
 	{
 		return AV_EMEM;
 	}
-	
+
 	if (0 == (h = (struct hash *)av_malloc(sizeof(struct hash))))
 	{
 		av_free(self);
 		return AV_EMEM;
 	}
-	
-	capacity = (unsigned int)floor(capacity / load_factor);
-	
-	for (i=0; i < sizes_count; i++) 
-		if (sizes[i] > capacity) 
-		{ 
-			sind = i; 
-			break;
-		}
-	
-	if (0 == (h->records = calloc(sizes[sind], sizeof(struct record))))
+
+	/* smallest table size keeping the estimated capacity under the load factor */
+	while (size_index + 1 < HASH_SIZES_COUNT &&
+		   hash_sizes[size_index] / HASH_LOAD_DEN * HASH_LOAD_NUM < capacity)
+		size_index++;
+
+	if (AV_OK != (rc = hash_alloc(h, size_index)))
 	{
 		av_free(h);
 		av_free(self);
-		return AV_EMEM;
+		return rc;
 	}
 
-	h->records_count = 0;
-	h->size_index = sind;
+	h->current_record = 0;
+	h->keytype = keytype;
+	h->mutex = AV_NULL;
 
-	if (AV_OK != (rc = av_rwmutex_create(&h->mutex)))
+	if (!(flags & AV_HASH_UNSYNCHRONIZED))
 	{
-		av_free(h->records);
-		av_free(h);
-		av_free(self);
-		return rc;
+		if (AV_OK != (rc = av_rwmutex_create(&h->mutex)))
+		{
+			av_free(h->records);
+			av_free(h);
+			av_free(self);
+			return rc;
+		}
 	}
 
-	self->context = (void *)h;
-	self->add     = av_hash_add;
-	self->get     = av_hash_get;
-	self->remove  = av_hash_remove;
-	self->size    = av_hash_size;
-	self->first   = av_hash_first;
-	self->next    = av_hash_next;
-	self->destroy = av_hash_destroy;
+	self->context       = (void *)h;
+	self->add           = av_hash_add;
+	self->get           = av_hash_get;
+	self->remove        = av_hash_remove;
+	self->add_key       = av_hash_add_key;
+	self->get_key       = av_hash_get_key;
+	self->remove_key    = av_hash_remove_key;
+	self->hash          = av_hash_hash;
+	self->add_hashed    = av_hash_add_hashed;
+	self->get_hashed    = av_hash_get_hashed;
+	self->remove_hashed = av_hash_remove_hashed;
+	self->size          = av_hash_size;
+	self->first         = av_hash_first;
+	self->next          = av_hash_next;
+	self->cursor_first  = av_hash_cursor_first;
+	self->cursor_next   = av_hash_cursor_next;
+	self->destroy       = av_hash_destroy;
 
 	*pphash = self;
 	return AV_OK;
 }
+
+av_result_t av_hash_create(unsigned int capacity, av_hash_p *pphash)
+{
+	return av_hash_create_ex(capacity, AV_HASH_KEY_STRING, AV_HASH_SYNCHRONIZED, pphash);
+}
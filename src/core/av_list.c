@@ -11,20 +11,12 @@
 #include <av_list.h>
 #include <av_stdc.h>
 
-/* defines list item */
-struct list_item
-{
-	void *value;
-	struct list_item* next;
-	struct list_item* prev;
-};
-
 /* defines list structure */
 struct list
 {
-	struct list_item* first;
-	struct list_item* last;
-	struct list_item* current;
+	av_list_item_p first;
+	av_list_item_p last;
+	av_list_item_p current;
 	unsigned int size;
 };
 
@@ -37,12 +29,12 @@ struct list
 */
 static av_result_t av_list_push_first(av_list_p self, void* value)
 {
-	struct list_item* item;
+	av_list_item_p item;
 	struct list* ctx = (struct list*)self->context;
 	av_assert(ctx, "list is not properly initialized");
 
 	/* initializes new item */
-	item = (struct list_item*)av_malloc(sizeof(struct list_item));
+	item = (av_list_item_p)av_malloc(sizeof(av_list_item_t));
 	if (!item)
 		return AV_EMEM;
 
@@ -69,12 +61,12 @@ static av_result_t av_list_push_first(av_list_p self, void* value)
 */
 static av_result_t av_list_push_last(av_list_p self, void* value)
 {
-	struct list_item* item;
+	av_list_item_p item;
 	struct list* ctx = (struct list*)self->context;
 	av_assert(ctx, "list is not properly initialized");
 
 	/* initializes new item */
-	item = (struct list_item*)av_malloc(sizeof(struct list_item));
+	item = (av_list_item_p)av_malloc(sizeof(av_list_item_t));
 	if (!item)
 		return AV_EMEM;
 
@@ -95,7 +87,7 @@ static av_result_t av_list_push_last(av_list_p self, void* value)
 av_result_t av_list_push_all(av_list_p self, av_list_p list)
 {
 	struct list* list_ctx = (struct list*)list->context;
-	struct list_item* item;
+	av_list_item_p item;
 	av_assert(list_ctx, "list is not properly initialized");
 
 	item = list_ctx->first;
@@ -116,7 +108,7 @@ av_result_t av_list_push_all(av_list_p self, av_list_p list)
 */
 static av_result_t av_list_insert_next(av_list_p self, void* value)
 {
-	struct list_item* item;
+	av_list_item_p item;
 	struct list* ctx = (struct list*)self->context;
 	av_assert(ctx, "list is not properly initialized");
 
@@ -124,7 +116,7 @@ static av_result_t av_list_insert_next(av_list_p self, void* value)
 	if (self->has_more(self))
 	{
 		/* initializes new item */
-		item = (struct list_item*)av_malloc(sizeof(struct list_item));
+		item = (av_list_item_p)av_malloc(sizeof(av_list_item_t));
 		if (!item)
 			return AV_EMEM;
 
@@ -157,7 +149,7 @@ static av_result_t av_list_insert_next(av_list_p self, void* value)
 */
 static av_result_t av_list_insert_prev(av_list_p self, void* value)
 {
-	struct list_item* item;
+	av_list_item_p item;
 	struct list* ctx = (struct list*)self->context;
 	av_assert(ctx, "list is not properly initialized");
 
@@ -165,7 +157,7 @@ static av_result_t av_list_insert_prev(av_list_p self, void* value)
 	if (self->has_more(self))
 	{
 		/* initializes new item */
-		item = (struct list_item*)av_malloc(sizeof(struct list_item));
+		item = (av_list_item_p)av_malloc(sizeof(av_list_item_t));
 		if (!item)
 			return AV_EMEM;
 
@@ -228,6 +220,26 @@ static void* av_list_get(av_list_p self)
 	return value;
 }
 
+/* detaches item from the list moving the current element to the next item if needed */
+static void av_list_unlink(struct list* ctx, av_list_item_p item)
+{
+	if (item->prev)
+		item->prev->next = item->next;
+	else
+		ctx->first = item->next;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	else
+		ctx->last = item->prev;
+
+	if (ctx->current == item)
+		ctx->current = item->next;
+
+	free(item);
+	ctx->size--;
+}
+
 /*
 *	Removes current item and returns its associated value.
 *	An item is removed and the returned value is valid
@@ -242,37 +254,8 @@ static void* av_list_remove(av_list_p self)
 	
 	if (self->has_more(self))
 	{
-		struct list_item* item;
-		item = ctx->current;
-		value = item->value;
-
-		if (item == ctx->first)
-		{
-			if (ctx->first == ctx->last)
-			{
-				ctx->current = ctx->first = ctx->last = AV_NULL;
-			}
-			else
-			{
-				ctx->first = ctx->current->next;
-			}
-		}
-		else
-		if (ctx->current == ctx->last)
-		{
-			ctx->last = ctx->current->prev;
-		}
-
-		if (ctx->current)
-		{
-			if (ctx->current->prev)
-				ctx->current->prev->next = ctx->current->next;
-			if (ctx->current->next)
-				ctx->current->next->prev = ctx->current->prev;
-			ctx->current = ctx->current->next;
-		}
-		free(item);
-		ctx->size--;
+		value = ctx->current->value;
+		av_list_unlink(ctx, ctx->current);
 	}
 
 	av_assert((ctx->size != 0) || ((ctx->first == ctx->last) && (AV_NULL == ctx->first)), "invalid list state");
@@ -280,6 +263,40 @@ static void* av_list_remove(av_list_p self)
 	return value;
 }
 
+/*
+*	Returns the first list item or AV_NULL if the list is empty
+*/
+static av_list_item_p av_list_first_item(av_list_p self)
+{
+	struct list* ctx = (struct list*)self->context;
+	av_assert(ctx, "list is not properly initialized");
+	return ctx->first;
+}
+
+/*
+*	Returns the last list item or AV_NULL if the list is empty
+*/
+static av_list_item_p av_list_last_item(av_list_p self)
+{
+	struct list* ctx = (struct list*)self->context;
+	av_assert(ctx, "list is not properly initialized");
+	return ctx->last;
+}
+
+/*
+*	Removes given item and returns its associated value
+*/
+static void* av_list_remove_item(av_list_p self, av_list_item_p item)
+{
+	void* value;
+	struct list* ctx = (struct list*)self->context;
+	av_assert(ctx && item, "list is not properly initialized");
+
+	value = item->value;
+	av_list_unlink(ctx, item);
+	return value;
+}
+
 /*
 *	Removes all list items.
 */
@@ -432,7 +449,7 @@ static av_result_t av_list_copy(av_list_p self, av_list_p source)
 static av_bool_t av_list_iterate(av_list_p self, av_list_iterator_t iterator, void* param)
 {
 	struct list* ctx = (struct list*)self->context;
-	struct list_item* item;
+	av_list_item_p item;
 	av_bool_t res = AV_FALSE;
 	av_assert(ctx, "list is not properly initialized");
 
@@ -459,7 +476,7 @@ static av_bool_t av_list_iterate(av_list_p self, av_list_iterator_t iterator, vo
 static void av_list_iterate_all(av_list_p self, void (*iterator)(void*), av_bool_t direction)
 {
 	struct list* ctx = (struct list*)self->context;
-	struct list_item* item;
+	av_list_item_p item;
 	av_assert(ctx, "list is not properly initialized");
 
 	item = (direction)?ctx->first:ctx->last;
@@ -488,8 +505,8 @@ static unsigned int av_list_size(av_list_p self)
 static void av_list_destroy(av_list_p self)
 {
 	struct list* ctx = (struct list*)self->context;
-	struct list_item* item;
-	struct list_item* pitem = AV_NULL;
+	av_list_item_p item;
+	av_list_item_p pitem = AV_NULL;
 	av_assert(ctx, "list is not properly initialized");
 	item = ctx->first;
 	while (item)
@@ -526,6 +543,9 @@ av_result_t av_list_create(av_list_p* pplist)
 	self->push_first  = av_list_push_first;
 	self->insert_next = av_list_insert_next;
 	self->insert_prev = av_list_insert_prev;
+	self->first_item  = av_list_first_item;
+	self->last_item   = av_list_last_item;
+	self->remove_item = av_list_remove_item;
 	self->pop_last    = av_list_pop_last;
 	self->pop_first   = av_list_pop_first;
 	self->get         = av_list_get;
@@ -12,10 +12,87 @@
 #include <av_oop.h>
 #include "av_stdc.h"
 
+/* rounds object size up so the trailing contexts array is pointer aligned */
+#define CONTEXTS_OFFSET(classsize) (((classsize) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+/* approximate size of memory block objects are allocated from */
+#define SLAB_SIZE 4096
+
 /* the class names of avgl base classes */
 static const char* object_class_name = "object";
 static const char* service_class_name = "service";
 
+/* last generation given to an OOP container, invalidating the class caches of O_is_a_named */
+static unsigned int oop_generation = 0;
+
+/* av_class_t implementation */
+/* -------------------------- */
+
+/* Allocates zeroed object memory from the class free list, refilling it with a new slab if empty */
+static av_object_p av_class_alloc_object(av_class_p self)
+{
+	void* object;
+
+	self->mutex->lock(self->mutex);
+	if (!self->freelist)
+	{
+		int i;
+		int count = AV_MAX(1, SLAB_SIZE / self->objectsize);
+		char* slab = (char*)av_malloc(count * self->objectsize);
+		if (!slab || AV_OK != self->slabs->push_last(self->slabs, slab))
+		{
+			av_free(slab);
+			self->mutex->unlock(self->mutex);
+			return AV_NULL;
+		}
+
+		/* links the slab objects in the free list */
+		for (i = count - 1; i >= 0; i--)
+		{
+			*(void**)(slab + i * self->objectsize) = self->freelist;
+			self->freelist = slab + i * self->objectsize;
+		}
+	}
+	object = self->freelist;
+	self->freelist = *(void**)object;
+	self->mutex->unlock(self->mutex);
+
+	av_memset(object, 0, self->objectsize);
+	return (av_object_p)object;
+}
+
+/* Returns object memory to the class free list */
+static void av_class_free_object(av_class_p self, av_object_p object)
+{
+	self->mutex->lock(self->mutex);
+	*(void**)object = self->freelist;
+	self->freelist = object;
+	self->mutex->unlock(self->mutex);
+}
+
+/* Returns AV_TRUE if the class owns its methods table rather than sharing the parent one */
+static av_bool_t av_class_owns_methods(av_class_p clazz)
+{
+	return clazz->methods && (!clazz->parent || clazz->parent->methods != clazz->methods);
+}
+
+/* Destroys class descriptor */
+static void av_class_destroy(void* pclass)
+{
+	av_class_p self = (av_class_p)pclass;
+	if (av_class_owns_methods(self))
+		av_free(self->methods);
+	if (self->slabs)
+	{
+		self->slabs->remove_all(self->slabs, av_free);
+		self->slabs->destroy(self->slabs);
+	}
+	if (self->mutex)
+		self->mutex->destroy(self->mutex);
+	av_free(self->ancestors);
+	av_free(self);
+}
+
 /* av_object_t implementation */
 /* --------------------------- */
 
@@ -23,19 +100,34 @@ static const char* service_class_name = "service";
 static av_bool_t av_object_is_a(av_object_p self, const char* classname)
 {
 	av_class_p classref;
+	av_hash_p classmap = self->classref->oop->classmap;
 
 	av_assert(classname, "NULL class name is not allowed");
 
-	classref = self->classref;
-	while (classref)
+	/* resolves the class name once, then checks the ancestors table */
+	classref = (av_class_p)classmap->get(classmap, classname);
+	if (!classref)
+		return AV_FALSE;
+
+	return O_is_a_class(self, classref);
+}
+
+/* Returns AV_TRUE if the object is derived from a named class resolved once into the cache */
+av_bool_t av_object_is_a_named(av_object_p self, const char* classname, av_class_cache_p cache)
+{
+	av_oop_p oop = self->classref->oop;
+	unsigned int generation = av_atomic_load(&oop->generation);
+
+	av_assert(classname, "NULL class name is not allowed");
+
+	/* resolves again after the container was recreated or got new classes */
+	if (av_atomic_load(&cache->generation) != generation)
 	{
-		if (0 == (av_strcmp(classref->classname, classname)))
-		{
-			return AV_TRUE;
-		}
-		classref = classref->parent;
+		cache->classref = (av_class_p)oop->classmap->get(oop->classmap, classname);
+		av_atomic_store(&cache->generation, generation);
 	}
-	return AV_FALSE;
+
+	return cache->classref && O_is_a_class(self, cache->classref);
 }
 
 /*
@@ -46,7 +138,9 @@ static av_result_t av_object_set_attribute(av_object_p self, const char* name, v
 	av_result_t rc;
 	if (!self->attributes)
 	{
-		if (AV_OK != (rc = av_hash_create(AV_HASH_CAPACITY_SMALL, &self->attributes)))
+		/* object attributes are confined to the thread owning the object */
+		if (AV_OK != (rc = av_hash_create_ex(AV_HASH_CAPACITY_SMALL, AV_HASH_KEY_STRING,
+											 AV_HASH_UNSYNCHRONIZED, &self->attributes)))
 			return rc;
 	}
 
@@ -107,34 +201,34 @@ static char* av_object_tostring(av_object_p self, char* buf, int bufsize)
 /* Object destructor */
 static void av_object_destructor(av_object_p self)
 {
+	int i;
 	av_class_p classref;
 	av_dbg("av_object_destructor: %p %s\n", self, self->classref->classname);
 
 	classref = self->classref;
 	// call all parent destructors but without object
-	while (classref->parent)
+	for (i = classref->context_slot; i > 0; i--)
 	{
-		if (classref->destructor)
-			classref->destructor(self);
-		classref = classref->parent;
+		if (classref->ancestors[i]->destructor)
+			classref->ancestors[i]->destructor(self);
 	}
 
 	if (self->attributes)
 		self->attributes->destroy(self->attributes);
-	free(self);
+	av_class_free_object(classref, self);
 }
 
 /* Increment reference counter */
 static av_object_p av_object_addref(av_object_p self)
 {
-	self->refcnt++;
+	av_atomic_inc(&self->refcnt);
 	return self;
 }
 
 /* Decrement reference counter and destroy the object when reaches 0 */
 static void av_object_release(av_object_p self)
 {
-	if (0 == --(self->refcnt))
+	if (0 == av_atomic_dec(&self->refcnt))
 	{
 		O_destroy(self);
 	}
@@ -215,7 +309,7 @@ static av_result_t av_oop_define_class(av_oop_p self,
 	}
 
 	/* creates new class descriptor entry */
-	clazz = (av_class_p)av_malloc(sizeof(av_class_t));
+	clazz = (av_class_p)av_calloc(1, sizeof(av_class_t));
 	if (!clazz)
 		return AV_EMEM;
 
@@ -225,21 +319,97 @@ static av_result_t av_oop_define_class(av_oop_p self,
 	clazz->classsize = classsize;
 	clazz->constructor = constructor;
 	clazz->destructor = destructor;
+	clazz->id = self->classes->size(self->classes);
+	clazz->context_slot = parent ? parent->context_slot + 1 : 0;
+	clazz->methods = parent ? parent->methods : AV_NULL;
+	clazz->methodssize = parent ? parent->methodssize : 0;
+	clazz->objectsize = CONTEXTS_OFFSET(classsize) + (clazz->context_slot + 1) * sizeof(void*);
+
+	/* caches the inheritance chain */
+	clazz->ancestors = (av_class_p*)av_malloc((clazz->context_slot + 1) * sizeof(av_class_p));
+	if (!clazz->ancestors)
+	{
+		av_class_destroy(clazz);
+		return AV_EMEM;
+	}
+	if (parent)
+		av_memcpy((unsigned char*)clazz->ancestors, (unsigned char*)parent->ancestors,
+				  clazz->context_slot * sizeof(av_class_p));
+	clazz->ancestors[clazz->context_slot] = clazz;
+
+	if (AV_OK != (rc = av_list_create(&clazz->slabs)))
+	{
+		av_class_destroy(clazz);
+		return rc;
+	}
+
+	if (AV_OK != (rc = av_mutex_create(&clazz->mutex)))
+	{
+		av_class_destroy(clazz);
+		return rc;
+	}
 
 	/* adds the new class entry to repository hashtable */
 	if (AV_OK != (rc = self->classmap->add(self->classmap, classname, clazz)))
 	{
-		free(clazz);
+		av_class_destroy(clazz);
 		return rc;
 	}
 
 	/* adds the new class name to repository list*/
 	if (AV_OK != (rc = self->classes->push_last(self->classes, clazz)))
 	{
-		free(clazz);
+		self->classmap->remove(self->classmap, classname);
+		av_class_destroy(clazz);
 		return rc;
 	}
 
+	/* the name may have been cached as not registered */
+	av_atomic_store(&self->generation, av_atomic_inc(&oop_generation));
+	return AV_OK;
+}
+
+/* Defines methods table shared by the class instances */
+static av_result_t av_oop_define_methods(av_oop_p self,
+	const char* classname,
+	int methodssize,
+	av_methods_initializer_t initializer)
+{
+	av_class_p clazz;
+	void* methods;
+
+	av_assert(classname, "NULL class name is not allowed");
+
+	clazz = (av_class_p)self->classmap->get(self->classmap, classname);
+	if (!clazz)
+	{
+		av_dbg("av_oop_define_methods: Class %s not found\n", classname);
+		return AV_EFOUND;
+	}
+
+	if (av_class_owns_methods(clazz))
+	{
+		av_dbg("av_oop_define_methods: %s methods are already defined\n", classname);
+
+		/* already defined */
+		return AV_OK;
+	}
+
+	av_assert(methodssize >= clazz->methodssize, "methods table is smaller than the parent one");
+
+	methods = av_calloc(1, methodssize);
+	if (!methods)
+		return AV_EMEM;
+
+	/* inherits parent methods */
+	if (clazz->methods)
+		av_memcpy((unsigned char*)methods, (unsigned char*)clazz->methods, clazz->methodssize);
+
+	if (initializer)
+		initializer(methods);
+
+	clazz->methods = methods;
+	clazz->methodssize = methodssize;
 	return AV_OK;
 }
 
@@ -292,63 +462,118 @@ static av_result_t av_oop_get_service(av_oop_p self, const char* servicename, av
 	return AV_OK;
 }
 
-/* Creates new object from the given class */
-static av_result_t av_oop_new(av_oop_p self, const char* classname, av_object_p* ppobject)
+/* Decrements object reference counter deferring the destroy */
+static void av_oop_release_deferred(av_oop_p self, av_object_p object)
 {
-	av_result_t rc;
-	av_class_p classref;
-	av_object_p object;
-	av_list_p parentslist;
+	av_object_p head;
+	if (0 != av_atomic_dec(&object->refcnt))
+		return;
+
+	/* pushes the object on the deferred list */
+	head = av_atomic_load(&self->deferred);
+	do
+	{
+		object->next_deferred = head;
+	} while (!av_atomic_cas(&self->deferred, &head, object));
+}
+
+/* Destroys objects released with release_deferred */
+static void av_oop_destroy_deferred(av_oop_p self)
+{
+	av_object_p object = (av_object_p)av_atomic_exchange(&self->deferred, AV_NULL);
+	while (object)
+	{
+		av_object_p next = object->next_deferred;
+		O_destroy(object);
+		object = next;
+	}
+}
 
+/* Gets the private context slot index of a class */
+static av_result_t av_oop_get_context_slot(av_oop_p self, const char* classname, int* pslot)
+{
+	av_class_p classref;
 	av_assert(classname, "NULL class name is not allowed");
 
 	classref = (av_class_p)self->classmap->get(self->classmap, classname);
 	if (AV_NULL == classref)
 	{
-		av_dbg("av_oop_new: Class %s not found\n", classname);
+		av_dbg("av_oop_get_context_slot: Class %s not found\n", classname);
 		return AV_EFOUND;
 	}
 
-	object = (av_object_p)calloc(1, classref->classsize);
+	*pslot = classref->context_slot;
+	return AV_OK;
+}
+
+/* Creates new object from the given class descriptor */
+static av_result_t av_oop_new_by_class(av_oop_p self, av_class_p classref, av_object_p* ppobject)
+{
+	int i;
+	av_result_t rc;
+	av_object_p object;
+
+	av_assert(classref && classref->oop == self, "class is not defined in this oop");
+	AV_UNUSED(self);
+
+	/* object and its class contexts are allocated in a single block */
+	object = av_class_alloc_object(classref);
 	if (!object)
 		return AV_EMEM;
 
 	object->classref = classref;
+	object->contexts = (void**)((char*)object + CONTEXTS_OFFSET(classref->classsize));
 
-	if (AV_OK != (rc = av_list_create(&parentslist)))
-	{
-		free(object);
-		return rc;
-	}
-
-	while (classref)
-	{
-		parentslist->push_last(parentslist, classref);
-		classref = classref->parent;
-	}
-
-	for (parentslist->last(parentslist); parentslist->has_more(parentslist); parentslist->prev(parentslist))
+	for (i = 0; i <= classref->context_slot; i++)
 	{
-		classref = (av_class_p)parentslist->get(parentslist);
-		if (classref->constructor)
-			if (AV_OK != (rc = classref->constructor(object)))
+		if (classref->ancestors[i]->constructor)
+			if (AV_OK != (rc = classref->ancestors[i]->constructor(object)))
 			{
-				parentslist->destroy(parentslist);
-				free(object);
+				av_class_free_object(classref, object);
 				return rc;
 			}
 	}
 	*ppobject = object;
-	av_dbg("av_oop_new: New object %p of class %s\n", object, classname);
-	parentslist->destroy(parentslist);
+	av_dbg("av_oop_new: New object %p of class %s\n", object, classref->classname);
+	return AV_OK;
+}
+
+/* Gets class descriptor by class name */
+static av_result_t av_oop_get_class(av_oop_p self, const char* classname, av_class_p* pclassref)
+{
+	av_class_p classref;
+	av_assert(classname, "NULL class name is not allowed");
+
+	classref = (av_class_p)self->classmap->get(self->classmap, classname);
+	if (AV_NULL == classref)
+	{
+		av_dbg("av_oop_get_class: Class %s not found\n", classname);
+		return AV_EFOUND;
+	}
+
+	*pclassref = classref;
 	return AV_OK;
 }
 
+/* Creates new object from the given class */
+static av_result_t av_oop_new(av_oop_p self, const char* classname, av_object_p* ppobject)
+{
+	av_result_t rc;
+	av_class_p classref;
+
+	if (AV_OK != (rc = av_oop_get_class(self, classname, &classref)))
+		return rc;
+
+	return av_oop_new_by_class(self, classref, ppobject);
+}
+
 static void av_oop_destroy(av_oop_p self)
 {
 	av_dbg("av_oop_destroy\n");
+	av_oop_destroy_deferred(self);
 	self->services->iterate_all(self->services, av_free, AV_FALSE);
-	self->classes->iterate_all(self->classes, av_free, AV_FALSE);
+	/* derived classes are destroyed before their parents */
+	self->classes->iterate_all(self->classes, av_class_destroy, AV_FALSE);
 	self->services->destroy(self->services);
 	self->classes->destroy(self->classes);
 	self->servicemap->destroy(self->servicemap);
@@ -364,6 +589,9 @@ av_result_t av_oop_create(av_oop_p* pself)
 	if (!self)
 		return AV_EMEM;
 
+	self->deferred = AV_NULL;
+	self->generation = av_atomic_inc(&oop_generation);
+
 	/* creates class repository hashtable */
 	if (AV_OK != (rc = av_hash_create(AV_HASH_CAPACITY_MEDIUM, &self->classmap)))
 	{
@@ -399,7 +627,13 @@ av_result_t av_oop_create(av_oop_p* pself)
 	}
 
 	self->define_class     = av_oop_define_class;
+	self->define_methods   = av_oop_define_methods;
 	self->new              = av_oop_new;
+	self->new_by_class     = av_oop_new_by_class;
+	self->get_class        = av_oop_get_class;
+	self->get_context_slot = av_oop_get_context_slot;
+	self->release_deferred = av_oop_release_deferred;
+	self->destroy_deferred = av_oop_destroy_deferred;
 	self->register_service = av_oop_register_service;
 	self->get_service      = av_oop_get_service;
 	self->destroy          = av_oop_destroy;
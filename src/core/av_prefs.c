@@ -14,6 +14,14 @@
 #include <av_prefs.h>
 #include <av_tree.h>
 
+/* preferences files loaded on creation, the user file is relative to $HOME and overrides the installed one */
+#ifndef AV_CONFIG_INSTALL_PREFERENCES
+#define AV_CONFIG_INSTALL_PREFERENCES "/etc/avgl.conf"
+#endif
+#ifndef AV_CONFIG_USER_PREFERENCES
+#define AV_CONFIG_USER_PREFERENCES ".avgl.conf"
+#endif
+
 #define MAX_INT_CHAR_SIZE 50
 #define NOT_ALLOCATE 0
 #define ALLOCATE 1
@@ -488,7 +496,7 @@ static void av_prefs_destroy_iterator(void* item)
 	}
 }
 
-static void av_prefs_destructor(void* pprefs)
+static void av_prefs_destructor(av_object_p pprefs)
 {
 	av_prefs_p self        = (av_prefs_p)pprefs;
 	av_prefs_context_p ctx = (av_prefs_context_p)O_context(self);
@@ -548,21 +556,17 @@ static av_result_t av_prefs_constructor(av_object_p object)
 	return AV_OK;
 }
 
-/* Registers prefs class into TORBA */
-av_result_t av_prefs_register_torba(void)
+/* Registers prefs class into TORBA and creates the prefs service */
+av_result_t av_prefs_register_oop(av_oop_p oop)
 {
 	av_service_p prefs;
 	av_result_t rc;
 
-	if (AV_OK != (rc = av_torb_register_class("prefs", "service",
-											  sizeof(av_prefs_t),
-											  av_prefs_constructor,
-											  av_prefs_destructor)))
+	if (AV_OK != (rc = oop->define_class(oop, "prefs", "service", sizeof(av_prefs_t), av_prefs_constructor, av_prefs_destructor)))
 		return rc;
 
-	if (AV_OK != (rc = av_torb_create_object("prefs", (av_object_p*)&prefs)))
+	if (AV_OK != (rc = oop->new(oop, "prefs", (av_object_p*)&prefs)))
 		return rc;
 
-	return av_torb_service_register("prefs", prefs);
+	return oop->register_service(oop, "prefs", prefs);
 }
-
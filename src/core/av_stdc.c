@@ -53,3 +53,8 @@ void av_memset(void* dst, unsigned char val, int size)
 {
 	memset(dst, val, size);
 }
+
+void av_memmove(void* dst, const void* src, int size)
+{
+	memmove(dst, src, size);
+}
@@ -19,10 +19,14 @@
 #    define __USE_UNIX98
 #  endif
 #include <errno.h>
+#include <time.h>
 #endif
 
 #ifdef _WIN32
 #define _TIMESPEC_DEFINED
+#include <windows.h>
+#else
+#include <unistd.h>
 #endif
 #include <pthread.h>
 
@@ -84,18 +88,15 @@ static av_result_t av_thread_error_process(int rc, const char* funcname, const c
 av_result_t av_thread_current(av_thread_p* ppthread)
 {
 #ifdef AV_MT
-	char tkey[11]; /* a key string with size of "0x12345678\0" */
 	av_result_t rc;
 	pthread_t tid = pthread_self();
 	unsigned long* ptid = (unsigned long*)&tid;
 
-	snprintf(tkey, 11, "%lu", *ptid);
-
 	if (AV_OK == (rc = _mtx_threads_ht->lock_read(_mtx_threads_ht)))
 	{
 		if (_threads_ht)
 		{
-			*ppthread = (av_thread_p)_threads_ht->get(_threads_ht, tkey);
+			*ppthread = (av_thread_p)_threads_ht->get_key(_threads_ht, AV_HASH_INT_KEY(*ptid));
 		}
 		else
 		{
@@ -208,7 +209,6 @@ static av_bool_t av_thread_equals(av_thread_p self, av_thread_p athread)
 
 static void av_thread_destroy(av_thread_p self)
 {
-	char tkey[11]; /* a key string with size of "0x12345678\0" */
 	av_bool_t active;
 	unsigned long* ptid = (unsigned long*)self->tid;
 
@@ -220,11 +220,9 @@ static void av_thread_destroy(av_thread_p self)
 		self->join(self);
 	}
 
-	snprintf(tkey, 11, "%lu", *ptid);
-
 	/* discards thread data */
 	_mtx_threads_ht->lock_write(_mtx_threads_ht);
-	_threads_ht->remove(_threads_ht, tkey);
+	_threads_ht->remove_key(_threads_ht, AV_HASH_INT_KEY(*ptid));
 	self->mtx_interrupted->destroy(self->mtx_interrupted);
 	self->mtx_active->destroy(self->mtx_active);
 	self->cnd_start->destroy(self->cnd_start);
@@ -256,7 +254,6 @@ static void av_thread_destroy(av_thread_p self)
 av_result_t av_thread_create(av_runnable_t runnable, void *arg, av_thread_p *ppthread)
 {
 #ifdef AV_MT
-	char               tkey[11]; /* a key string with size of "0x12345678\0" */
 	av_thread_p        self = (av_thread_p)av_malloc(sizeof(av_thread_t));
 	pthread_t          tid;
 	pthread_attr_t     attr;
@@ -337,7 +334,9 @@ av_result_t av_thread_create(av_runnable_t runnable, void *arg, av_thread_p *ppt
 	/* on first created thread the global _threads_ht is not initialized yet */
 	if (!_threads_ht)
 	{
-		if (AV_OK != (rc = av_hash_create(AV_HASH_CAPACITY_MEDIUM, &_threads_ht)))
+		/* _threads_ht is guarded by _mtx_threads_ht */
+		if (AV_OK != (rc = av_hash_create_ex(AV_HASH_CAPACITY_MEDIUM, AV_HASH_KEY_INTEGER,
+											 AV_HASH_UNSYNCHRONIZED, &_threads_ht)))
 		{
 			_mtx_threads_ht->unlock(_mtx_threads_ht);
 			self->cnd_start->destroy(self->cnd_start);
@@ -369,12 +368,7 @@ av_result_t av_thread_create(av_runnable_t runnable, void *arg, av_thread_p *ppt
 	*(pthread_t *)self->tid = tid;
 
 	/* adds the new (tid, self) pair to _threads_ht */
-	{
-		unsigned long* ptid = (unsigned long*)&tid;
-		snprintf(tkey, 11, "%lu", *ptid);
-	}
-
-	rc = _threads_ht->add(_threads_ht, tkey, self);
+	rc = _threads_ht->add_key(_threads_ht, AV_HASH_INT_KEY(*(unsigned long*)&tid), self);
 	if (AV_OK != rc)
 	{
 		_mtx_threads_ht->unlock(_mtx_threads_ht);
@@ -603,12 +597,26 @@ static av_result_t av_condition_wait(av_condition_p self, av_mutex_p mutex)
 #endif
 }
 
+#ifdef AV_MT
+/* converts timeout relative to now to the absolute time expected by pthread_cond_timedwait */
+static void av_condition_deadline(struct timespec* abstime, unsigned long sec, unsigned long nanos)
+{
+	timespec_get(abstime, TIME_UTC);
+	abstime->tv_sec  += sec + nanos / 1000000000L;
+	abstime->tv_nsec += nanos % 1000000000L;
+	if (abstime->tv_nsec >= 1000000000L)
+	{
+		abstime->tv_sec++;
+		abstime->tv_nsec -= 1000000000L;
+	}
+}
+#endif
+
 static av_result_t av_condition_wait_ms(av_condition_p self, av_mutex_p mutex, unsigned long mills)
 {
 #ifdef AV_MT
 	struct timespec abstime;
-	abstime.tv_sec  = mills / 1000;
-	abstime.tv_nsec = (mills % 1000)*1000000L;
+	av_condition_deadline(&abstime, mills / 1000, (mills % 1000)*1000000L);
 	return av_thread_error_check("pthread_cond_timedwait", pthread_cond_timedwait((pthread_cond_t*)(self->cid),
 																				  (pthread_mutex_t*)(mutex->mid), &abstime));
 #else
@@ -620,8 +628,7 @@ static av_result_t av_condition_wait_ns(av_condition_p self, av_mutex_p mutex, u
 {
 #ifdef AV_MT
 	struct timespec abstime;
-	abstime.tv_sec  = 0;
-	abstime.tv_nsec = nanos;
+	av_condition_deadline(&abstime, 0, nanos);
 	return av_thread_error_check("pthread_cond_timedwait", pthread_cond_timedwait((pthread_cond_t*)(self->cid),
 																				  (pthread_mutex_t*)(mutex->mid), &abstime));
 #else
@@ -818,3 +825,562 @@ av_result_t av_sync_queue_create(int elements_max, av_sync_queue_p* ppqueue)
 	*ppqueue           = self;
 	return AV_OK;
 }
+
+/* period the blocked spsc queue threads recheck the queue as a safety net for missed wakeups */
+#define SPSC_QUEUE_WAIT_MS 5
+
+static unsigned int av_spsc_queue_size(av_spsc_queue_p self)
+{
+	return av_atomic_load(&self->tail) - av_atomic_load(&self->head);
+}
+
+/* wakes the opposite side if blocked */
+static void av_spsc_queue_wakeup(av_spsc_queue_p self)
+{
+	/* orders the index store before the waiting load, pairs with the fence in av_spsc_queue_wait */
+	av_atomic_fence();
+	if (av_atomic_load(&self->waiting))
+		self->condition->signal(self->condition);
+}
+
+static av_result_t av_spsc_queue_try_push(av_spsc_queue_p self, void* element)
+{
+	unsigned int tail = self->tail;
+	if (av_atomic_load(&self->is_abort))
+		return AV_EINTERRUPT;
+
+	if (tail - av_atomic_load(&self->head) >= self->elements_max)
+		return AV_EAGAIN;
+
+	self->elements[tail & (self->capacity - 1)] = element;
+	av_atomic_store(&self->tail, tail + 1);
+	av_spsc_queue_wakeup(self);
+	return AV_OK;
+}
+
+static av_result_t av_spsc_queue_try_pop(av_spsc_queue_p self, void** element)
+{
+	unsigned int head = self->head;
+	if (av_atomic_load(&self->is_abort))
+		return AV_EINTERRUPT;
+
+	if (av_atomic_load(&self->tail) == head)
+		return AV_EAGAIN;
+
+	*element = self->elements[head & (self->capacity - 1)];
+	av_atomic_store(&self->head, head + 1);
+	av_spsc_queue_wakeup(self);
+	return AV_OK;
+}
+
+/* blocks the calling thread until the opposite side signals or the wait period expires */
+static void av_spsc_queue_wait(av_spsc_queue_p self, av_bool_t for_space)
+{
+	unsigned int size;
+	self->mutex->lock(self->mutex);
+	av_atomic_inc(&self->waiting);
+	av_atomic_fence();
+
+	/* rechecks after announcing the wait, so a concurrent push or pop either sees the waiter or is seen here */
+	size = av_spsc_queue_size(self);
+	if (!av_atomic_load(&self->is_abort) && (for_space ? size >= self->elements_max : 0 == size))
+		self->condition->wait_ms(self->condition, self->mutex, SPSC_QUEUE_WAIT_MS);
+	av_atomic_dec(&self->waiting);
+	self->mutex->unlock(self->mutex);
+}
+
+static av_result_t av_spsc_queue_push(av_spsc_queue_p self, void* element)
+{
+	av_result_t rc;
+	while (AV_EAGAIN == (rc = av_spsc_queue_try_push(self, element)))
+		av_spsc_queue_wait(self, AV_TRUE);
+	return rc;
+}
+
+static av_result_t av_spsc_queue_pop(av_spsc_queue_p self, void** element)
+{
+	av_result_t rc;
+	while (AV_EAGAIN == (rc = av_spsc_queue_try_pop(self, element)))
+		av_spsc_queue_wait(self, AV_FALSE);
+	return rc;
+}
+
+static void av_spsc_queue_abort(av_spsc_queue_p self)
+{
+	self->mutex->lock(self->mutex);
+	av_atomic_store(&self->is_abort, AV_TRUE);
+	self->condition->broadcast(self->condition);
+	self->mutex->unlock(self->mutex);
+}
+
+static void av_spsc_queue_destroy(void* pqueue)
+{
+	av_spsc_queue_p self = (av_spsc_queue_p)pqueue;
+	self->abort(self);
+	self->mutex->destroy(self->mutex);
+	self->condition->destroy(self->condition);
+	free(self->elements);
+	free(self);
+}
+
+av_result_t av_spsc_queue_create(unsigned int elements_max, av_spsc_queue_p* ppqueue)
+{
+	av_result_t rc;
+	unsigned int capacity = 1;
+	av_spsc_queue_p self;
+
+	if (0 == elements_max)
+		return AV_EARG;
+
+	if (0 == (self = (av_spsc_queue_p)av_calloc(1, sizeof(av_spsc_queue_t))))
+		return AV_EMEM;
+
+	/* power of two ring buffer so the free running indices wrap consistently */
+	while (capacity < elements_max)
+		capacity <<= 1;
+
+	if (0 == (self->elements = (void**)av_malloc(capacity * sizeof(void*))))
+	{
+		free(self);
+		return AV_EMEM;
+	}
+
+	if (AV_OK != (rc = av_mutex_create(&self->mutex)))
+	{
+		free(self->elements);
+		free(self);
+		return rc;
+	}
+
+	if (AV_OK != (rc = av_condition_create(&self->condition)))
+	{
+		self->mutex->destroy(self->mutex);
+		free(self->elements);
+		free(self);
+		return rc;
+	}
+
+	self->capacity     = capacity;
+	self->elements_max = elements_max;
+	self->head         = 0;
+	self->tail         = 0;
+	self->waiting      = 0;
+	self->is_abort     = AV_FALSE;
+	self->size         = av_spsc_queue_size;
+	self->try_push     = av_spsc_queue_try_push;
+	self->try_pop      = av_spsc_queue_try_pop;
+	self->push         = av_spsc_queue_push;
+	self->pop          = av_spsc_queue_pop;
+	self->abort        = av_spsc_queue_abort;
+	self->destroy      = av_spsc_queue_destroy;
+	*ppqueue           = self;
+	return AV_OK;
+}
+
+unsigned int av_cpu_count(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (unsigned int)info.dwNumberOfProcessors;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0) ? (unsigned int)count : 1;
+#endif
+}
+
+/* initial capacity of the worker task deque */
+#define TASK_DEQUE_CAPACITY 64
+
+struct task_item
+{
+	av_task_t task;
+	void* arg;
+	av_task_group_p group;
+};
+
+/* ring buffer of tasks, the owner works on the bottom end and thieves on the top */
+struct task_deque
+{
+	av_mutex_p mutex;
+	struct task_item* items;
+	unsigned int capacity;
+	unsigned int head;
+	unsigned int count;
+};
+
+struct task_worker
+{
+	struct task_deque deque;
+	av_thread_p thread;
+	struct task_pool* pool;
+	unsigned int index;
+};
+
+struct task_pool
+{
+	struct task_worker* workers;
+	unsigned int workers_count;
+
+	/* round robin index for tasks submitted by non worker threads */
+	unsigned int next_worker;
+
+	/* number of tasks in all deques */
+	unsigned int queued;
+
+	av_bool_t shutdown;
+	av_mutex_p mutex;
+	av_condition_p cond_work;
+	av_condition_p cond_done;
+#ifdef AV_MT
+	/* maps worker threads to their struct task_worker */
+	pthread_key_t worker_key;
+#endif
+};
+
+static av_result_t task_deque_push_bottom(struct task_deque* deque, struct task_item* item)
+{
+	deque->mutex->lock(deque->mutex);
+	if (deque->count == deque->capacity)
+	{
+		unsigned int i;
+		struct task_item* items = (struct task_item*)av_malloc(2 * deque->capacity * sizeof(struct task_item));
+		if (!items)
+		{
+			deque->mutex->unlock(deque->mutex);
+			return AV_EMEM;
+		}
+		for (i = 0; i < deque->count; i++)
+			items[i] = deque->items[(deque->head + i) & (deque->capacity - 1)];
+		free(deque->items);
+		deque->items = items;
+		deque->capacity *= 2;
+		deque->head = 0;
+	}
+	deque->items[(deque->head + deque->count) & (deque->capacity - 1)] = *item;
+	deque->count++;
+	deque->mutex->unlock(deque->mutex);
+	return AV_OK;
+}
+
+static av_bool_t task_deque_pop_bottom(struct task_deque* deque, struct task_item* item)
+{
+	av_bool_t found = AV_FALSE;
+	deque->mutex->lock(deque->mutex);
+	if (deque->count)
+	{
+		deque->count--;
+		*item = deque->items[(deque->head + deque->count) & (deque->capacity - 1)];
+		found = AV_TRUE;
+	}
+	deque->mutex->unlock(deque->mutex);
+	return found;
+}
+
+static av_bool_t task_deque_steal_top(struct task_deque* deque, struct task_item* item)
+{
+	av_bool_t found = AV_FALSE;
+	deque->mutex->lock(deque->mutex);
+	if (deque->count)
+	{
+		*item = deque->items[deque->head & (deque->capacity - 1)];
+		deque->head++;
+		deque->count--;
+		found = AV_TRUE;
+	}
+	deque->mutex->unlock(deque->mutex);
+	return found;
+}
+
+/* returns the worker running the calling thread or AV_NULL */
+static struct task_worker* task_pool_current_worker(struct task_pool* pool)
+{
+#ifdef AV_MT
+	return (struct task_worker*)pthread_getspecific(pool->worker_key);
+#else
+	AV_UNUSED(pool);
+	return AV_NULL;
+#endif
+}
+
+/* takes a task from the own deque, or steals one from the others */
+static av_bool_t task_pool_take(struct task_pool* pool, struct task_worker* worker, struct task_item* item)
+{
+	unsigned int i, start;
+
+	if (0 == av_atomic_load(&pool->queued))
+		return AV_FALSE;
+
+	if (worker && task_deque_pop_bottom(&worker->deque, item))
+	{
+		av_atomic_dec(&pool->queued);
+		return AV_TRUE;
+	}
+
+	start = worker ? worker->index + 1 : 0;
+	for (i = 0; i < pool->workers_count; i++)
+	{
+		struct task_worker* victim = &pool->workers[(start + i) % pool->workers_count];
+		if (victim != worker && task_deque_steal_top(&victim->deque, item))
+		{
+			av_atomic_dec(&pool->queued);
+			return AV_TRUE;
+		}
+	}
+	return AV_FALSE;
+}
+
+static void task_pool_run(struct task_pool* pool, struct task_item* item)
+{
+	item->task(item->arg);
+	if (item->group && 0 == av_atomic_dec(&item->group->pending))
+	{
+		pool->mutex->lock(pool->mutex);
+		pool->cond_done->broadcast(pool->cond_done);
+		pool->mutex->unlock(pool->mutex);
+	}
+}
+
+#ifdef AV_MT
+static int task_pool_worker_thread(av_thread_p thread)
+{
+	struct task_worker* worker = (struct task_worker*)thread->arg;
+	struct task_pool* pool = worker->pool;
+	struct task_item item;
+
+	pthread_setspecific(pool->worker_key, worker);
+	for (;;)
+	{
+		if (task_pool_take(pool, worker, &item))
+		{
+			task_pool_run(pool, &item);
+			continue;
+		}
+
+		pool->mutex->lock(pool->mutex);
+		while (0 == av_atomic_load(&pool->queued) && !pool->shutdown)
+			pool->cond_work->wait(pool->cond_work, pool->mutex);
+
+		if (pool->shutdown && 0 == av_atomic_load(&pool->queued))
+		{
+			pool->mutex->unlock(pool->mutex);
+			break;
+		}
+		pool->mutex->unlock(pool->mutex);
+	}
+	return 0;
+}
+#endif
+
+static av_result_t av_task_pool_submit(av_task_pool_p self, av_task_group_p group, av_task_t task, void* arg)
+{
+	struct task_pool* pool = (struct task_pool*)self->context;
+	struct task_worker* worker;
+	struct task_item item;
+	av_result_t rc;
+
+	if (0 == pool->workers_count)
+	{
+		/* no workers, executes in place */
+		task(arg);
+		return AV_OK;
+	}
+
+	item.task  = task;
+	item.arg   = arg;
+	item.group = group;
+
+	if (!(worker = task_pool_current_worker(pool)))
+		worker = &pool->workers[av_atomic_inc(&pool->next_worker) % pool->workers_count];
+
+	if (group)
+		av_atomic_inc(&group->pending);
+
+	/* counted before pushed so takers never see more tasks than counted */
+	av_atomic_inc(&pool->queued);
+	if (AV_OK != (rc = task_deque_push_bottom(&worker->deque, &item)))
+	{
+		av_atomic_dec(&pool->queued);
+		if (group)
+			av_atomic_dec(&group->pending);
+		return rc;
+	}
+
+	pool->mutex->lock(pool->mutex);
+	pool->cond_work->signal(pool->cond_work);
+	pool->mutex->unlock(pool->mutex);
+	return AV_OK;
+}
+
+static void av_task_pool_wait(av_task_pool_p self, av_task_group_p group)
+{
+	struct task_pool* pool = (struct task_pool*)self->context;
+	struct task_worker* worker = task_pool_current_worker(pool);
+	struct task_item item;
+
+	while (av_atomic_load(&group->pending))
+	{
+		/* helps executing tasks instead of blocking */
+		if (task_pool_take(pool, worker, &item))
+		{
+			task_pool_run(pool, &item);
+			continue;
+		}
+
+		pool->mutex->lock(pool->mutex);
+		if (av_atomic_load(&group->pending))
+			pool->cond_done->wait(pool->cond_done, pool->mutex);
+		pool->mutex->unlock(pool->mutex);
+	}
+}
+
+static unsigned int av_task_pool_get_workers(av_task_pool_p self)
+{
+	struct task_pool* pool = (struct task_pool*)self->context;
+	return pool->workers_count;
+}
+
+static void av_task_pool_destroy(av_task_pool_p self)
+{
+	struct task_pool* pool = (struct task_pool*)self->context;
+	unsigned int i;
+
+	pool->mutex->lock(pool->mutex);
+	pool->shutdown = AV_TRUE;
+	pool->cond_work->broadcast(pool->cond_work);
+	pool->mutex->unlock(pool->mutex);
+
+	/* all workers are stopped before any deque is freed since the running ones still steal */
+	for (i = 0; i < pool->workers_count; i++)
+	{
+		struct task_worker* worker = &pool->workers[i];
+		if (worker->thread)
+		{
+			worker->thread->join(worker->thread);
+			worker->thread->destroy(worker->thread);
+		}
+	}
+	for (i = 0; i < pool->workers_count; i++)
+	{
+		struct task_worker* worker = &pool->workers[i];
+		worker->deque.mutex->destroy(worker->deque.mutex);
+		free(worker->deque.items);
+	}
+#ifdef AV_MT
+	pthread_key_delete(pool->worker_key);
+#endif
+	pool->cond_done->destroy(pool->cond_done);
+	pool->cond_work->destroy(pool->cond_work);
+	pool->mutex->destroy(pool->mutex);
+	free(pool->workers);
+	free(pool);
+	free(self);
+}
+
+av_result_t av_task_pool_create(unsigned int workers, av_task_pool_p* pppool)
+{
+	av_result_t rc;
+	av_task_pool_p self;
+	struct task_pool* pool;
+	unsigned int i;
+
+#ifdef AV_MT
+	if (0 == workers)
+		workers = av_cpu_count();
+#else
+	/* tasks are executed by submit */
+	workers = 0;
+#endif
+
+	if (0 == (self = (av_task_pool_p)av_malloc(sizeof(av_task_pool_t))))
+		return AV_EMEM;
+
+	if (0 == (pool = (struct task_pool*)av_calloc(1, sizeof(struct task_pool))))
+	{
+		free(self);
+		return AV_EMEM;
+	}
+	self->context     = pool;
+	self->submit      = av_task_pool_submit;
+	self->wait        = av_task_pool_wait;
+	self->get_workers = av_task_pool_get_workers;
+	self->destroy     = av_task_pool_destroy;
+
+	if (workers && 0 == (pool->workers = (struct task_worker*)av_calloc(workers, sizeof(struct task_worker))))
+	{
+		free(pool);
+		free(self);
+		return AV_EMEM;
+	}
+
+	if (AV_OK != (rc = av_mutex_create(&pool->mutex)))
+	{
+		free(pool->workers);
+		free(pool);
+		free(self);
+		return rc;
+	}
+
+	if (AV_OK != (rc = av_condition_create(&pool->cond_work)))
+	{
+		pool->mutex->destroy(pool->mutex);
+		free(pool->workers);
+		free(pool);
+		free(self);
+		return rc;
+	}
+
+	if (AV_OK != (rc = av_condition_create(&pool->cond_done)))
+	{
+		pool->cond_work->destroy(pool->cond_work);
+		pool->mutex->destroy(pool->mutex);
+		free(pool->workers);
+		free(pool);
+		free(self);
+		return rc;
+	}
+
+#ifdef AV_MT
+	if (AV_OK != (rc = av_thread_error_check("pthread_key_create", pthread_key_create(&pool->worker_key, AV_NULL))))
+	{
+		pool->cond_done->destroy(pool->cond_done);
+		pool->cond_work->destroy(pool->cond_work);
+		pool->mutex->destroy(pool->mutex);
+		free(pool->workers);
+		free(pool);
+		free(self);
+		return rc;
+	}
+
+	/* the pool is destroyed on failure, stopping the workers created so far */
+	for (i = 0; i < workers; i++)
+	{
+		struct task_worker* worker = &pool->workers[i];
+		worker->pool  = pool;
+		worker->index = i;
+		worker->deque.capacity = TASK_DEQUE_CAPACITY;
+		if (0 == (worker->deque.items = (struct task_item*)av_malloc(TASK_DEQUE_CAPACITY * sizeof(struct task_item))))
+			rc = AV_EMEM;
+		else
+		if (AV_OK == (rc = av_mutex_create(&worker->deque.mutex)))
+		{
+			pool->workers_count++;
+			if (AV_OK == (rc = av_thread_create(task_pool_worker_thread, worker, &worker->thread)))
+				rc = worker->thread->start(worker->thread);
+		}
+
+		if (AV_OK != rc)
+		{
+			if (!worker->deque.mutex)
+				free(worker->deque.items);
+			av_task_pool_destroy(self);
+			return rc;
+		}
+	}
+#else
+	AV_UNUSED(i);
+#endif
+
+	*pppool = self;
+	return AV_OK;
+}
@@ -0,0 +1,140 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      av_vector.c                                        */
+/* Description:   Contiguous dynamic arrays                          */
+/*                                                                   */
+/*********************************************************************/
+
+#include <string.h>
+#include <av_vector.h>
+#include <av_stdc.h>
+
+#define VECTOR_MIN_CAPACITY 8
+
+/* element address at index */
+#define VECTOR_ELEM(v, i) ((unsigned char*)(v)->data + (i) * (v)->elemsize)
+
+static av_result_t av_vector_reserve(av_vector_p self, unsigned int capacity)
+{
+	void* data;
+	if (capacity <= self->capacity)
+		return AV_OK;
+
+	if (0 == (data = av_realloc(self->data, capacity * self->elemsize)))
+		return AV_EMEM;
+
+	self->data = data;
+	self->capacity = capacity;
+	return AV_OK;
+}
+
+/* doubles the storage when full */
+static av_result_t av_vector_grow(av_vector_p self)
+{
+	if (self->size < self->capacity)
+		return AV_OK;
+	return av_vector_reserve(self, self->capacity ? 2 * self->capacity : VECTOR_MIN_CAPACITY);
+}
+
+static av_result_t av_vector_push_last(av_vector_p self, const void* elem)
+{
+	av_result_t rc;
+	if (AV_OK != (rc = av_vector_grow(self)))
+		return rc;
+
+	av_memcpy(VECTOR_ELEM(self, self->size), (unsigned char*)elem, self->elemsize);
+	self->size++;
+	return AV_OK;
+}
+
+static av_result_t av_vector_insert(av_vector_p self, unsigned int index, const void* elem)
+{
+	av_result_t rc;
+	if (index > self->size)
+		return AV_EARG;
+
+	if (AV_OK != (rc = av_vector_grow(self)))
+		return rc;
+
+	av_memmove(VECTOR_ELEM(self, index + 1), VECTOR_ELEM(self, index), (self->size - index) * self->elemsize);
+	av_memcpy(VECTOR_ELEM(self, index), (unsigned char*)elem, self->elemsize);
+	self->size++;
+	return AV_OK;
+}
+
+static av_bool_t av_vector_pop_last(av_vector_p self, void* elem)
+{
+	if (0 == self->size)
+		return AV_FALSE;
+
+	self->size--;
+	if (elem)
+		av_memcpy((unsigned char*)elem, VECTOR_ELEM(self, self->size), self->elemsize);
+	return AV_TRUE;
+}
+
+static void av_vector_remove(av_vector_p self, unsigned int index)
+{
+	av_assert(index < self->size, "vector index is out of range");
+	self->size--;
+	av_memmove(VECTOR_ELEM(self, index), VECTOR_ELEM(self, index + 1), (self->size - index) * self->elemsize);
+}
+
+static void av_vector_remove_all(av_vector_p self)
+{
+	self->size = 0;
+}
+
+static int av_vector_index_of(av_vector_p self, const void* elem)
+{
+	unsigned int i;
+	if (sizeof(void*) == self->elemsize)
+	{
+		/* fast path for vector of pointers */
+		void** items = (void**)self->data;
+		void* item = *(void* const*)elem;
+		for (i = 0; i < self->size; i++)
+			if (items[i] == item)
+				return (int)i;
+		return -1;
+	}
+
+	for (i = 0; i < self->size; i++)
+		if (0 == memcmp(VECTOR_ELEM(self, i), elem, self->elemsize))
+			return (int)i;
+	return -1;
+}
+
+static void av_vector_destroy(av_vector_p self)
+{
+	av_free(self->data);
+	av_free(self);
+}
+
+av_result_t av_vector_create(unsigned int elemsize, av_vector_p* ppvector)
+{
+	av_vector_p self;
+	av_assert(elemsize > 0, "vector element size must be positive");
+
+	if (0 == (self = (av_vector_p)av_malloc(sizeof(av_vector_t))))
+		return AV_EMEM;
+
+	self->data       = AV_NULL;
+	self->size       = 0;
+	self->capacity   = 0;
+	self->elemsize   = elemsize;
+	self->push_last  = av_vector_push_last;
+	self->insert     = av_vector_insert;
+	self->pop_last   = av_vector_pop_last;
+	self->remove     = av_vector_remove;
+	self->remove_all = av_vector_remove_all;
+	self->index_of   = av_vector_index_of;
+	self->reserve    = av_vector_reserve;
+	self->destroy    = av_vector_destroy;
+
+	*ppvector = self;
+	return AV_OK;
+}
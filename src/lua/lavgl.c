@@ -222,23 +222,16 @@ static int lsystem_graphics(lua_State* L)
 
 static int lsystem_create_surface(lua_State* L)
 {
-	av_system_p system = tosystem(L, 1);
-	av_result_t rc;
-	av_bitmap_p bitmap;
 	av_surface_p surface;
 	const char* filename = luaL_checkstring(L, 2);
+	tosystem(L, 1);
 
-	rc = system->create_bitmap(system, &bitmap);
-	check_result(L, rc);
-
-	rc = bitmap->load(bitmap, filename);
-	check_result(L, rc);
-
-	rc = system->display->create_surface(system->display, &surface);
-	check_result(L, rc);
-
-	rc = surface->set_bitmap(surface, bitmap);
-	check_result(L, rc);
+	/* the decoded bitmap is shared through the image cache */
+	if (!(surface = avgl_load_surface(filename)))
+	{
+		av_result_t rc = avgl_last_error();
+		check_result(L, rc)
+	}
 
 	new_lua_surface(L, surface);
 	return 1;
@@ -643,7 +636,7 @@ static av_bool_t av_window_on_mouse_button_down(av_window_p self, av_event_mouse
 static int lwindow_detach(lua_State* L)
 {
 	av_window_p window = towindow(L, 1);
-	window->detach(window);
+	window->methods->detach(window);
 	lua_pushboolean(L, AV_TRUE);
 	return 1;
 }
@@ -653,10 +646,10 @@ static int lwindow_setpos(lua_State* L)
 	av_window_p window = towindow(L, 1);
 	av_rect_t rect;
 	av_result_t rc;
-	window->get_rect(window, &rect);
+	window->methods->get_rect(window, &rect);
 	rect.x = (int)luaL_checkinteger(L, 2);
 	rect.y = (int)luaL_checkinteger(L, 3);
-	rc = window->set_rect(window, &rect);
+	rc = window->methods->set_rect(window, &rect);
 	check_result(L, rc)
 	lua_pushboolean(L, AV_TRUE);
 	return 1;
@@ -666,7 +659,7 @@ static int lwindow_getpos(lua_State* L)
 {
 	av_window_p window = towindow(L, 1);
 	av_rect_t rect;
-	window->get_rect(window, &rect);
+	window->methods->get_rect(window, &rect);
 	lua_pushinteger(L, rect.x);
 	lua_pushinteger(L, rect.y);
 	return 2;
@@ -677,10 +670,10 @@ static int lwindow_setsize(lua_State* L)
 	av_window_p window = towindow(L, 1);
 	av_rect_t rect;
 	av_result_t rc;
-	window->get_rect(window, &rect);
+	window->methods->get_rect(window, &rect);
 	rect.w = (int)luaL_checkinteger(L, 2);
 	rect.h = (int)luaL_checkinteger(L, 3);
-	rc = window->set_rect(window, &rect);
+	rc = window->methods->set_rect(window, &rect);
 	check_result(L, rc)
 	lua_pushboolean(L, AV_TRUE);
 	return 1;
@@ -690,7 +683,7 @@ static int lwindow_getsize(lua_State* L)
 {
 	av_window_p window = towindow(L, 1);
 	av_rect_t rect;
-	window->get_rect(window, &rect);
+	window->methods->get_rect(window, &rect);
 	lua_pushinteger(L, rect.w);
 	lua_pushinteger(L, rect.h);
 	return 2;
@@ -702,7 +695,7 @@ static int lwindow_setrect(lua_State* L)
 	av_rect_t rect;
 	av_result_t rc;
 	avlua_torect(L, 2, &rect);
-	rc = window->set_rect(window, &rect);
+	rc = window->methods->set_rect(window, &rect);
 	check_result(L, rc)
 	lua_pushboolean(L, AV_TRUE);
 	return 1;
@@ -712,7 +705,7 @@ static int lwindow_getrect(lua_State* L)
 {
 	av_window_p window = towindow(L, 1);
 	av_rect_t rect;
-	window->get_rect(window, &rect);
+	window->methods->get_rect(window, &rect);
 	avlua_rect_new(L, &rect);
 	return 1;
 }
@@ -749,7 +742,7 @@ static int lvisible_createwindow(lua_State* L)
 	av_visible_p child;
 	av_result_t rc;
 	const char *kind = luaL_optstring(L, 2, "visible");
-	rc = visible->create_child(visible, kind, &child);
+	rc = visible->methods->create_child(visible, kind, &child);
 	check_result(L, rc)
 	new_lua_visible(L, child);
 	return 1;
@@ -766,7 +759,74 @@ static int lvisible_set_surface(lua_State* L)
 {
 	av_visible_p visible = tovisible(L, 1);
 	av_surface_p surface = tosurface(L, 2);
-	visible->set_surface(visible, surface);
+	visible->methods->set_surface(visible, surface);
+	lua_pushboolean(L, AV_TRUE);
+	return 1;
+}
+
+/* sets the loaded surface and notifies the visible onload handler */
+static void visible_on_surface_loaded(void* arg, av_visible_p self, av_surface_p surface, av_result_t rc)
+{
+	lua_State* L;
+	AV_UNUSED(arg);
+	if (surface)
+		self->methods->set_surface(self, surface);
+
+	L = avlua_push_object((av_object_p)self);
+	lua_pushliteral(L, "onload");
+	lua_rawget(L, -2);
+	if (lua_isfunction(L, -1))
+	{
+		lua_pushboolean(L, AV_OK == rc);
+		lua_pushinteger(L, rc);
+		lua_call(L, 2, 0);
+	}
+	else
+		lua_pop(L, 1);
+	lua_pop(L, 1);
+}
+
+static int lvisible_load_surface(lua_State* L)
+{
+	av_visible_p visible = tovisible(L, 1);
+	const char* filename = luaL_checkstring(L, 2);
+	const char* placeholder_filename = luaL_optstring(L, 3, AV_NULL);
+	av_surface_p placeholder = AV_NULL;
+	unsigned int id;
+
+	/* the placeholder is usually small and already cached */
+	if (placeholder_filename && !(placeholder = avgl_load_surface(placeholder_filename)))
+	{
+		av_result_t rc = avgl_last_error();
+		check_result(L, rc)
+	}
+
+	if (0 == (id = avgl_load_surface_async(visible, filename, placeholder, visible_on_surface_loaded, AV_NULL)))
+	{
+		av_result_t rc = avgl_last_error();
+		if (placeholder)
+			O_release(placeholder);
+		check_result(L, rc)
+	}
+	lua_pushinteger(L, id);
+	return 1;
+}
+
+static int lvisible_invalidate(lua_State* L)
+{
+	av_visible_p visible = tovisible(L, 1);
+	av_rect_t rect;
+	av_result_t rc;
+	if (lua_isnoneornil(L, 2))
+	{
+		rc = visible->methods->invalidate_rect(visible, AV_NULL);
+	}
+	else
+	{
+		avlua_torect(L, 2, &rect);
+		rc = visible->methods->invalidate_rect(visible, &rect);
+	}
+	check_result(L, rc)
 	lua_pushboolean(L, AV_TRUE);
 	return 1;
 }
@@ -776,6 +836,8 @@ static const struct luaL_Reg lvisible_meths[] =
 	{ "createwindow", lvisible_createwindow },
 	{ "system", lvisible_system }, // FIXME: Convert to property
 	{ "setsurface", lvisible_set_surface},
+	{ "loadsurface", lvisible_load_surface },
+	{ "invalidate", lvisible_invalidate },
 	{ AV_NULL, AV_NULL }
 };
 
@@ -784,7 +846,7 @@ static int lsprite_set_size(lua_State* L)
 	av_sprite_p sprite = tosprite(L, 1);
 	int frame_width = (int)luaL_checkinteger(L, 2);
 	int frame_height = (int)luaL_checkinteger(L, 3);
-	sprite->set_size(sprite, frame_width, frame_height);
+	sprite->methods->set_size(sprite, frame_width, frame_height);
 	lua_pushboolean(L, AV_TRUE);
 	return 1;
 }
@@ -793,7 +855,7 @@ static int lsprite_get_size(lua_State* L)
 {
 	av_sprite_p sprite = tosprite(L, 1);
 	int frame_width, frame_height;
-	sprite->get_size(sprite, &frame_width, &frame_height);
+	sprite->methods->get_size(sprite, &frame_width, &frame_height);
 	lua_pushinteger(L, frame_width);
 	lua_pushinteger(L, frame_height);
 	return 2;
@@ -802,7 +864,7 @@ static int lsprite_get_size(lua_State* L)
 static int lsprite_get_frames_count(lua_State* L)
 {
 	av_sprite_p sprite = tosprite(L, 1);
-	lua_pushinteger(L, sprite->get_frames_count(sprite));
+	lua_pushinteger(L, sprite->methods->get_frames_count(sprite));
 	return 1;
 }
 
@@ -811,7 +873,7 @@ static int lsprite_set_current_frame(lua_State* L)
 	av_sprite_p* psprite = (av_sprite_p *)lua_touserdata(L, 1);
 	av_sprite_p sprite = *psprite;
 	int frame = (int)luaL_checkinteger(L, 2);
-	sprite->set_current_frame(sprite, frame);
+	sprite->methods->set_current_frame(sprite, frame);
 	return 0;
 }
 
@@ -819,7 +881,7 @@ static int lsprite_get_current_frame(lua_State* L)
 {
 	av_sprite_p* psprite = (av_sprite_p *)lua_touserdata(L, 1);
 	av_sprite_p sprite = *psprite;
-	lua_pushinteger(L, sprite->get_current_frame(sprite));
+	lua_pushinteger(L, sprite->methods->get_current_frame(sprite));
 	return 1;
 }
 
@@ -830,7 +892,7 @@ static int lsprite_set_sequence(lua_State* L)
 	int* seq = luatable_tointarray(L, 2);
 	int duration = (int)lua_tointeger(L, 3);
 	av_bool_t loop = lua_toboolean(L, 4);
-	sprite->set_sequence(sprite, &seq[1], seq[0], duration, loop);
+	sprite->methods->set_sequence(sprite, &seq[1], seq[0], duration, loop);
 	free(seq);
 	lua_pushboolean(L, AV_TRUE);
 	return 1;
@@ -855,6 +917,7 @@ static void new_lua_surface(lua_State* L, av_surface_p surface)
 
 static void new_lua_visible(lua_State* L, av_visible_p visible)
 {
+	static av_class_cache_t sprite_class = AV_CLASS_CACHE_INIT;
 	new_lua_object(L, (av_object_p)visible);
 	((av_window_p)visible)->on_key_down           = window_on_key_down;
 	((av_window_p)visible)->on_key_up             = window_on_key_up;
@@ -867,7 +930,7 @@ static void new_lua_visible(lua_State* L, av_visible_p visible)
 	visible->on_draw = visible_on_draw;
 	luaL_setfuncs(L, lwindow_meths, 0);
 	luaL_setfuncs(L, lvisible_meths, 0);
-	if (O_is_a(visible, "sprite"))
+	if (O_is_a_named(visible, "sprite", &sprite_class))
 	{
 		luaL_setfuncs(L, lsprite_meths, 0);
 	}
@@ -922,9 +985,9 @@ static int avlua_graphics_create_surface(lua_State* L)
 	av_result_t rc;
 	av_graphics_p self = tographics(L, 1);
 	av_graphics_surface_p graphics_surface;
-	if (lua_isstring(L, 1))
+	if (lua_isstring(L, 2))
 	{
-		const char* filename = lua_tostring(L, 1);
+		const char* filename = lua_tostring(L, 2);
 		if (AV_OK != (rc = self->create_surface_from_file(self, filename, &graphics_surface)))
 		{
 			lua_pushnil(L);
@@ -1665,6 +1728,7 @@ static void new_lua_graphics_pattern(lua_State* L, av_graphics_pattern_p graphic
 static int lavgl_create(lua_State* L)
 {
 	av_display_config_t display_config;
+	av_visible_p root;
 	luaL_checktype(L, 1, LUA_TTABLE);
 	av_memset(&display_config, 0, sizeof(av_display_config_t));
 	lua_getfield(L, 1, "width");
@@ -1676,7 +1740,12 @@ static int lavgl_create(lua_State* L)
 	display_config.scale_x = (int)luaL_optinteger(L, -2, 1);
 	display_config.scale_y = (int)luaL_optinteger(L, -1, 1);
 	lua_pop(L, 4);
-	new_lua_visible(L, avgl_create(&display_config));
+	if (!(root = avgl_create(&display_config)))
+	{
+		av_result_t rc = avgl_last_error();
+		check_result(L, rc)
+	}
+	new_lua_visible(L, root);
 	return 1;
 }
 
@@ -1684,10 +1753,21 @@ static int lavgl_create(lua_State* L)
 static int lavgl_load_surface(lua_State* L)
 {
 	av_surface_p surface = avgl_load_surface(luaL_checkstring(L, 1));
+	if (!surface)
+	{
+		av_result_t rc = avgl_last_error();
+		check_result(L, rc)
+	}
 	new_lua_surface(L, surface);
 	return 1;
 }
 
+static int lavgl_cancel_load(lua_State* L)
+{
+	avgl_cancel_load((unsigned int)luaL_checkinteger(L, 1));
+	return 0;
+}
+
 static int lavgl_loop(lua_State* L)
 {
 	avgl_loop();
@@ -1700,13 +1780,22 @@ static int lavgl_step(lua_State* L)
 	return 0;
 }
 
+static int lavgl_set_loop_mode(lua_State* L)
+{
+	static const char* const modes[] = { "poll", "wait", AV_NULL };
+	avgl_set_loop_mode((av_loop_mode_t)luaL_checkoption(L, 1, AV_NULL, modes));
+	return 0;
+}
+
 /* AVGL main functions */
 static const struct luaL_Reg lavgl_funcs[] =
 {
 	{ "create", lavgl_create },
 	{ "load_surface", lavgl_load_surface },
+	{ "cancel_load", lavgl_cancel_load },
 	{ "loop", lavgl_loop },
 	{ "step", lavgl_step },
+	{ "set_loop_mode", lavgl_set_loop_mode },
 	{ AV_NULL, AV_NULL }
 };
 
@@ -43,7 +43,7 @@ typedef struct av_audio_handle
 	av_bool_t is_paused;
 
 	av_media_p media;
-	av_sync_queue_p queue;
+	av_spsc_queue_p queue;
 	void* user_callback_data;
 	av_audio_callback_t user_callback;
 	av_frame_audio_p frame_audio;
@@ -109,18 +109,14 @@ static void default_sdl_audio_callback(void* userdata, unsigned char* data, int
 		if (0 == length)
 			break;
 
-		if (0 < p->queue->size(p->queue))
+		/* never blocks the audio thread */
+		if (AV_OK == p->queue->try_pop(p->queue, (void**)&p->frame_audio))
 		{
-			if (AV_OK == p->queue->pop(p->queue, (void**)&p->frame_audio))
-			{
-				if (p->media)
-					p->media->synchronize_audio(p->media, p->frame_audio);
-				av_memcpy((unsigned char*)&p->frame_audio_out, (unsigned char*)p->frame_audio, av_offsetof(p->frame_audio,data) + p->frame_audio->size);
-				p->frame_audio_out_index = 0;
-				free(p->frame_audio);
-			}
-			else
-				break;
+			if (p->media)
+				p->media->synchronize_audio(p->media, p->frame_audio);
+			av_memcpy((unsigned char*)&p->frame_audio_out, (unsigned char*)p->frame_audio, av_offsetof(p->frame_audio,data) + p->frame_audio->size);
+			p->frame_audio_out_index = 0;
+			free(p->frame_audio);
 		}
 		else
 			break;
@@ -174,6 +170,7 @@ static av_result_t av_audio_sdl_write(av_audio_p self, struct av_audio_handle* p
 	av_audio_sdl_ctx_p ctx = (av_audio_sdl_ctx_p)O_context(self);
 	if (ctx->enabled)
 	{
+		av_result_t rc;
 		av_frame_audio_p frame_audio_new;
 		if (phandle->has_cvt)
 		{
@@ -198,7 +195,12 @@ static av_result_t av_audio_sdl_write(av_audio_p self, struct av_audio_handle* p
 				av_memcpy((unsigned char *)frame_audio_new, (unsigned char *)frame_audio, av_offsetof(frame_audio,data));
 				av_memcpy((unsigned char *)frame_audio_new->data, src, size);
 				frame_audio_new->size = size;
-				phandle->queue->push(phandle->queue, frame_audio_new);
+				if (AV_OK != (rc = phandle->queue->push(phandle->queue, frame_audio_new)))
+				{
+					free(frame_audio_new);
+					free(phandle->cvt.buf);
+					return rc;
+				}
 				length -= size;
 				src += size;
 			}
@@ -210,7 +212,11 @@ static av_result_t av_audio_sdl_write(av_audio_p self, struct av_audio_handle* p
 			if (!frame_audio_new)
 				return AV_EMEM;
 			av_memcpy((unsigned char *)frame_audio_new, (unsigned char *)frame_audio, av_offsetof(frame_audio,data) + frame_audio->size);
-			phandle->queue->push(phandle->queue, frame_audio_new);
+			if (AV_OK != (rc = phandle->queue->push(phandle->queue, frame_audio_new)))
+			{
+				free(frame_audio_new);
+				return rc;
+			}
 		}
 	}
 	return AV_OK;
@@ -266,7 +272,7 @@ static av_result_t av_audio_sdl_open(struct av_audio* self, int samplerate, int
 		return AV_EMEM;
 	}
 
-	if (AV_OK != (rc = av_sync_queue_create(SDL_AUDIO_QUEUE_SIZE, &phandle->queue)))
+	if (AV_OK != (rc = av_spsc_queue_create(SDL_AUDIO_QUEUE_SIZE, &phandle->queue)))
 	{
 		free(phandle);
 		return rc;
@@ -334,10 +340,10 @@ static av_result_t av_audio_sdl_close(struct av_audio* self, struct av_audio_han
 	av_audio_sdl_ctx_p ctx = (av_audio_sdl_ctx_p)O_context(self);
 	if (ctx->mtx)
 	{
-		phandle->queue->abort(phandle->queue);
 		ctx->mtx->lock(ctx->mtx);
 		if (phandle)
 		{
+			av_frame_audio_p frame_audio;
 			if (av_audio_root)
 			{
 				if (av_audio_root == phandle)
@@ -358,6 +364,10 @@ static av_result_t av_audio_sdl_close(struct av_audio* self, struct av_audio_han
 					}
 				}
 			}
+			/* unlinked, the callback no longer pops so the closing producer drains the frames left */
+			while (AV_OK == phandle->queue->try_pop(phandle->queue, (void**)&frame_audio))
+				free(frame_audio);
+			phandle->queue->destroy(phandle->queue);
 			free(phandle);
 		}
 		/* stops the callback if no more open handles */
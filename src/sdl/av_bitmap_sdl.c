@@ -16,6 +16,8 @@
 #include <av_stdc.h>
 #include <SDL_image.h>
 
+int av_bitmap_sdl_context_slot = 0;
+
 /* SDL interprets each pixel as a 32-bit number, so our masks must depend
 on the endianness (byte order) of the machine */
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
@@ -80,7 +82,7 @@ static av_result_t av_bitmap_sdl_constructor(av_object_p object)
 	av_bitmap_p self = (av_bitmap_p)object;
 	bitmap_sdl_ctx_p ctx = (bitmap_sdl_ctx_p)av_calloc(1, sizeof(bitmap_sdl_ctx_t));
 	ctx->surface = AV_NULL;
-	O_set_attr(object, bitmap_context, ctx);
+	O_set_context_slot(object, av_bitmap_sdl_context_slot, ctx);
 
 	self->set_size    = av_bitmap_sdl_set_size;
 	self->get_size    = av_bitmap_sdl_get_size;
@@ -91,7 +93,11 @@ static av_result_t av_bitmap_sdl_constructor(av_object_p object)
 /*	Registers bitmap class into OOP class repository */
 av_result_t av_bitmap_sdl_register_oop(av_oop_p oop)
 {
-	return oop->define_class(oop, "bitmap_sdl", "bitmap", sizeof(av_bitmap_t), av_bitmap_sdl_constructor, av_bitmap_sdl_destructor);
+	av_result_t rc;
+	if (AV_OK != (rc = oop->define_class(oop, "bitmap_sdl", "bitmap", sizeof(av_bitmap_t), av_bitmap_sdl_constructor, av_bitmap_sdl_destructor)))
+		return rc;
+
+	return oop->get_context_slot(oop, "bitmap_sdl", &av_bitmap_sdl_context_slot);
 }
 
 #endif /* WITH_SYSTEM_SDL */
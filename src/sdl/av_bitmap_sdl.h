@@ -19,8 +19,9 @@ typedef struct _bitmap_sdl_ctx_t
 	SDL_Surface *surface;
 } bitmap_sdl_ctx_t, *bitmap_sdl_ctx_p;
 
-static const char* bitmap_context = "bitmap_sdl_ctx_p";
-#define O_bitmap_context(o) ((bitmap_sdl_ctx_p)O_attr(o, bitmap_context))
+/* bitmap context slot assigned on class registration */
+extern int av_bitmap_sdl_context_slot;
+#define O_bitmap_context(o) ((bitmap_sdl_ctx_p)O_context_slot(o, av_bitmap_sdl_context_slot))
 
 //AV_API av_result_t av_surface_sdl_register_oop(av_oop_p);
 
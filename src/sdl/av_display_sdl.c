@@ -55,6 +55,45 @@ static av_result_t av_display_sdl_enum_display_modes(av_display_p pdisplay, disp
 	return AV_ESUPPORTED;
 }
 
+/*
+*	(Re)creates the texture keeping the composited frame between presents.
+*	SDL leaves the back buffer undefined after SDL_RenderPresent, so compositing
+*	only the damaged rects is valid only in a persistent render target.
+*/
+static av_result_t av_display_sdl_create_target(av_display_sdl_p self)
+{
+	SDL_RendererInfo info;
+	int width, height;
+
+	if (0 != SDL_GetRendererInfo(self->renderer, &info) || !(info.flags & SDL_RENDERER_TARGETTEXTURE))
+		return AV_ESUPPORTED;
+	if (0 != SDL_GetRendererOutputSize(self->renderer, &width, &height))
+		return AV_EGENERAL;
+
+	if (self->target)
+	{
+		int target_width, target_height;
+		SDL_QueryTexture(self->target, AV_NULL, AV_NULL, &target_width, &target_height);
+		if (target_width == width && target_height == height)
+			return AV_OK;
+		SDL_SetRenderTarget(self->renderer, AV_NULL);
+		SDL_DestroyTexture(self->target);
+	}
+
+	if (AV_NULL == (self->target = SDL_CreateTexture(self->renderer, SDL_PIXELFORMAT_ARGB8888,
+													 SDL_TEXTUREACCESS_TARGET, width, height)))
+		return AV_EMEM;
+	if (0 != SDL_SetRenderTarget(self->renderer, self->target))
+	{
+		SDL_DestroyTexture(self->target);
+		self->target = AV_NULL;
+		return AV_EGENERAL;
+	}
+	SDL_SetRenderDrawColor(self->renderer, 0, 0, 0, 255);
+	SDL_RenderClear(self->renderer);
+	return AV_OK;
+}
+
 /*
 *	Sets display configuration options.
 *	After setting configuration the \c display_config parameter is filled
@@ -86,6 +125,10 @@ static av_result_t av_display_sdl_set_configuration(av_display_p pdisplay, av_di
 		}
 	}
 
+	/* without render target the surfaces are composited directly to the window */
+	if (AV_OK != av_display_sdl_create_target(self))
+		av_dbg("display_sdl: render targets are not supported, partial redraws may be lost\n");
+
 	return AV_OK;
 }
 
@@ -197,13 +240,26 @@ av_result_t av_display_sdl_create_surface(struct av_display* self, av_surface_p*
 static void av_display_sdl_render(struct av_display* display)
 {
 	av_display_sdl_p self = (av_display_sdl_p)display;
-	SDL_RenderPresent(self->renderer);
+	if (self->target)
+	{
+		/* the window is redrawn from the whole frame as its content is undefined after a present */
+		SDL_SetRenderTarget(self->renderer, AV_NULL);
+		SDL_RenderCopy(self->renderer, self->target, AV_NULL, AV_NULL);
+		SDL_RenderPresent(self->renderer);
+		SDL_SetRenderTarget(self->renderer, self->target);
+	}
+	else
+	{
+		SDL_RenderPresent(self->renderer);
+	}
 //	av_dbg("SDL_RenderPresent\n");
 }
 
 static void av_display_sdl_destructor(void* pdisplay)
 {
 	av_display_sdl_p self = (av_display_sdl_p)pdisplay;
+	if (self->target)
+		SDL_DestroyTexture(self->target);
 	if (self->renderer)
 		SDL_DestroyRenderer(self->renderer);
 	if (self->window)
@@ -25,6 +25,9 @@ typedef struct av_display_sdl
 
 	/* SDL renderer */
 	SDL_Renderer* renderer;
+
+	/* Persistent frame the surfaces are composited into, NULL if render targets are not supported */
+	SDL_Texture* target;
 } av_display_sdl_t, *av_display_sdl_p;
 
 AV_API av_result_t av_display_sdl_register_oop(av_oop_p);
@@ -10,6 +10,7 @@
 
 #ifdef WITH_SYSTEM_SDL
 
+#include <limits.h>
 #include <avgl.h>
 #include <SDL.h>
 #include "av_core_sdl.h"
@@ -383,101 +384,130 @@ static av_bool_t av_input_translate_key(SDL_Keycode *skey, av_key_t* akey, av_bo
 }
 
 /*
-* Polls for currently pending events
-* \return AV_TRUE if there are any pending events, AV_FALSE otherwise
+* Translates SDL event
+* \return AV_TRUE if the event is translated, AV_FALSE otherwise
 */
-static av_bool_t av_input_sdl_poll_event(av_input_p self, av_event_p event)
+static av_bool_t av_input_sdl_translate_event(SDL_Event* e, av_event_p event)
 {
-	SDL_Event e;
-	AV_UNUSED(self);
 	event->type = 0;
 	event->flags = 0;
-	if (SDL_PollEvent(&e))
+	switch (e->type)
 	{
-		switch (e.type)
+		case SDL_MOUSEMOTION:
+			av_event_init_mouse_motion(event, e->motion.x, e->motion.y);
+		break;
+		case SDL_MOUSEBUTTONUP:
+		case SDL_MOUSEBUTTONDOWN:
 		{
-			case SDL_MOUSEMOTION:
-				av_event_init_mouse_motion(event, e.motion.x, e.motion.y);
-			break;
-			case SDL_MOUSEBUTTONUP:
-			case SDL_MOUSEBUTTONDOWN:
-			{
-				int mousex, mousey;
-				av_event_button_status_t button_status = (e.type == SDL_MOUSEBUTTONUP)?AV_BUTTON_RELEASED:AV_BUTTON_PRESSED;
-				av_event_mouse_button_t mouse_button;
-				switch (e.button.button)
-				{
-					case SDL_BUTTON_LEFT:
-						mouse_button = AV_MOUSE_BUTTON_LEFT;
-					break;
-					case SDL_BUTTON_RIGHT:
-						mouse_button = AV_MOUSE_BUTTON_RIGHT;
-					break;
-					case SDL_BUTTON_MIDDLE:
-						mouse_button = AV_MOUSE_BUTTON_MIDDLE;
-					break;
-					case SDL_BUTTON_X1:
-						mouse_button = AV_MOUSE_BUTTON_X1;
-					break;
-					case SDL_BUTTON_X2:
-						mouse_button = AV_MOUSE_BUTTON_X2;
-					break;
-					default: return AV_FALSE;
-				}
-				SDL_GetMouseState(&mousex, &mousey);
-				av_event_init_mouse_button(event, mouse_button, button_status, mousex, mousey);
-			}
-			break;
-			case SDL_MOUSEWHEEL:
+			int mousex, mousey;
+			av_event_button_status_t button_status = (e->type == SDL_MOUSEBUTTONUP)?AV_BUTTON_RELEASED:AV_BUTTON_PRESSED;
+			av_event_mouse_button_t mouse_button;
+			switch (e->button.button)
 			{
-				int mousex, mousey;
-				av_event_mouse_button_t mouse_button = AV_MOUSE_BUTTON_WHEEL;
-				av_event_button_status_t button_status = (e.wheel.direction == SDL_MOUSEWHEEL_NORMAL) ? AV_BUTTON_PRESSED : AV_BUTTON_RELEASED;
-				SDL_GetMouseState(&mousex, &mousey);
-				av_event_init_mouse_button(event, mouse_button, button_status, mousex, mousey);
+				case SDL_BUTTON_LEFT:
+					mouse_button = AV_MOUSE_BUTTON_LEFT;
+				break;
+				case SDL_BUTTON_RIGHT:
+					mouse_button = AV_MOUSE_BUTTON_RIGHT;
+				break;
+				case SDL_BUTTON_MIDDLE:
+					mouse_button = AV_MOUSE_BUTTON_MIDDLE;
+				break;
+				case SDL_BUTTON_X1:
+					mouse_button = AV_MOUSE_BUTTON_X1;
+				break;
+				case SDL_BUTTON_X2:
+					mouse_button = AV_MOUSE_BUTTON_X2;
+				break;
+				default: return AV_FALSE;
 			}
-			break;
-			case SDL_KEYUP:
-			case SDL_KEYDOWN:
-			{
-				av_event_button_status_t button_status = (e.type == SDL_KEYUP)?AV_BUTTON_RELEASED:AV_BUTTON_PRESSED;
-				av_key_t key;
-				if (AV_FALSE == av_input_translate_key(&e.key.keysym.sym, &key, KEY_SDL_TO_AVGL))
-					return AV_FALSE;
+			SDL_GetMouseState(&mousex, &mousey);
+			av_event_init_mouse_button(event, mouse_button, button_status, mousex, mousey);
+		}
+		break;
+		case SDL_MOUSEWHEEL:
+		{
+			int mousex, mousey;
+			av_event_mouse_button_t mouse_button = AV_MOUSE_BUTTON_WHEEL;
+			av_event_button_status_t button_status = (e->wheel.direction == SDL_MOUSEWHEEL_NORMAL) ? AV_BUTTON_PRESSED : AV_BUTTON_RELEASED;
+			SDL_GetMouseState(&mousex, &mousey);
+			av_event_init_mouse_button(event, mouse_button, button_status, mousex, mousey);
+		}
+		break;
+		case SDL_KEYUP:
+		case SDL_KEYDOWN:
+		{
+			av_event_button_status_t button_status = (e->type == SDL_KEYUP)?AV_BUTTON_RELEASED:AV_BUTTON_PRESSED;
+			av_key_t key;
+			if (AV_FALSE == av_input_translate_key(&e->key.keysym.sym, &key, KEY_SDL_TO_AVGL))
+				return AV_FALSE;
 
-				av_event_init_keyboard(event, key, button_status);
+			av_event_init_keyboard(event, key, button_status);
 
-				/* TODO: use e.key.keysym.unicode if provided */
-			}
-			break;
-			case SDL_QUIT:
+			/* TODO: use e->key.keysym.unicode if provided */
+		}
+		break;
+		case SDL_QUIT:
+		{
+			event->type = AV_EVENT_QUIT;
+			event->flags = 0;
+		}
+		break;
+		case SDL_USEREVENT:
+		{
+			if (e->user.code < AV_EVENT_USER)
 			{
-				event->type = AV_EVENT_QUIT;
-				event->flags = 0;
+				event->type = e->user.code;
+				event->flags = AV_EVENT_FLAGS_NONE;
 			}
-			break;
-			case SDL_USEREVENT:
+			else
 			{
-				if (e.user.code < AV_EVENT_USER)
-				{
-					event->type = e.user.code;
-					event->flags = AV_EVENT_FLAGS_NONE;
-				}
-				else
-				{
-					event->type = AV_EVENT_USER;
-					event->user_id = e.user.code & ~AV_EVENT_USER;
-					event->data = e.user.data1;
-					event->window = e.user.data2;
-					event->flags = AV_EVENT_FLAGS_USER_ID | AV_EVENT_FLAGS_WINDOW | AV_EVENT_FLAGS_DATA;
-				}
+				event->type = AV_EVENT_USER;
+				event->user_id = e->user.code & ~AV_EVENT_USER;
+				event->data = e->user.data1;
+				event->window = e->user.data2;
+				event->flags = AV_EVENT_FLAGS_USER_ID | AV_EVENT_FLAGS_WINDOW | AV_EVENT_FLAGS_DATA;
 			}
-			break;
-			default:
-				break;
 		}
-		return AV_TRUE;
+		break;
+		default:
+			break;
 	}
+	return AV_TRUE;
+}
+
+/*
+* Polls for currently pending events
+* \return AV_TRUE if there are any pending events, AV_FALSE otherwise
+*/
+static av_bool_t av_input_sdl_poll_event(av_input_p self, av_event_p event)
+{
+	SDL_Event e;
+	AV_UNUSED(self);
+	if (SDL_PollEvent(&e))
+		return av_input_sdl_translate_event(&e, event);
+	event->type = 0;
+	event->flags = 0;
+	return AV_FALSE;
+}
+
+/*
+* Waits for the next event up to timeout_ms milliseconds
+* \return AV_TRUE if event is returned, AV_FALSE on timeout
+*/
+static av_bool_t av_input_sdl_wait_event(av_input_p self, av_event_p event, unsigned long timeout_ms)
+{
+	SDL_Event e;
+	int rc;
+	AV_UNUSED(self);
+	if (AV_INPUT_WAIT_FOREVER == timeout_ms)
+		rc = SDL_WaitEvent(&e);
+	else
+		rc = SDL_WaitEventTimeout(&e, (int)AV_MIN(timeout_ms, (unsigned long)INT_MAX));
+	if (rc)
+		return av_input_sdl_translate_event(&e, event);
+	event->type = 0;
+	event->flags = 0;
 	return AV_FALSE;
 }
 
@@ -598,6 +628,7 @@ static av_result_t av_input_sdl_constructor(av_object_p object)
 {
 	av_input_p self         = (av_input_p)object;
 	self->poll_event        = av_input_sdl_poll_event;
+	self->wait_event        = av_input_sdl_wait_event;
 	self->push_event        = av_input_sdl_push_event;
 	self->get_key_modifiers = av_input_sdl_get_key_modifiers;
 	return AV_OK;
@@ -17,6 +17,8 @@
 #include "av_bitmap_sdl.h"
 #include <SDL.h>
 
+int av_surface_sdl_context_slot = 0;
+
 /* set surface width and height */
 static av_result_t av_surface_sdl_set_size(av_surface_p self, int width, int height)
 {
@@ -53,6 +55,15 @@ static av_result_t av_surface_sdl_lock(av_surface_p self, av_pixel_p* ppixels, i
 	return AV_OK;
 }
 
+static av_result_t av_surface_sdl_lock_rect(av_surface_p self, av_rect_p rect, av_pixel_p* ppixels, int* ppitch)
+{
+	surface_sdl_ctx_p ctx = O_surface_context(self);
+	if (0 != SDL_LockTexture(ctx->texture, (SDL_Rect*)rect, (void**)ppixels, ppitch))
+		return AV_ESTATE;
+
+	return AV_OK;
+}
+
 static void av_surface_sdl_unlock(av_surface_p self)
 {
 	surface_sdl_ctx_p ctx = O_surface_context(self);
@@ -96,9 +107,10 @@ static av_result_t av_surface_sdl_constructor(av_object_p object)
 	av_surface_p self = (av_surface_p)object;
 	av_oop_p oop = O_oop(object);
 	surface_sdl_ctx_p ctx = (surface_sdl_ctx_p)av_calloc(1, sizeof(surface_sdl_ctx_t));
-	O_set_attr(object, surface_context, ctx);
+	O_set_context_slot(object, av_surface_sdl_context_slot, ctx);
 
 	self->lock        = av_surface_sdl_lock;
+	self->lock_rect   = av_surface_sdl_lock_rect;
 	self->unlock      = av_surface_sdl_unlock;
 	self->set_size    = av_surface_sdl_set_size;
 	self->get_size    = av_surface_sdl_get_size;
@@ -110,7 +122,11 @@ static av_result_t av_surface_sdl_constructor(av_object_p object)
 /*	Registers surface class into OOP class repository */
 av_result_t av_surface_sdl_register_oop(av_oop_p oop)
 {
-	return oop->define_class(oop, "surface_sdl", "surface", sizeof(av_surface_t), av_surface_sdl_constructor, av_surface_sdl_destructor);
+	av_result_t rc;
+	if (AV_OK != (rc = oop->define_class(oop, "surface_sdl", "surface", sizeof(av_surface_t), av_surface_sdl_constructor, av_surface_sdl_destructor)))
+		return rc;
+
+	return oop->get_context_slot(oop, "surface_sdl", &av_surface_sdl_context_slot);
 }
 
 #endif /* WITH_SYSTEM_SDL */
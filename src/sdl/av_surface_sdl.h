@@ -19,8 +19,9 @@ typedef struct _surface_sdl_ctx_t
 	av_display_sdl_p display;
 } surface_sdl_ctx_t, *surface_sdl_ctx_p;
 
-static const char* surface_context = "surface_sdl_ctx_p";
-#define O_surface_context(o) ((surface_sdl_ctx_p)O_attr(o, surface_context))
+/* surface context slot assigned on class registration */
+extern int av_surface_sdl_context_slot;
+#define O_surface_context(o) ((surface_sdl_ctx_p)O_context_slot(o, av_surface_sdl_context_slot))
 
 AV_API av_result_t av_surface_sdl_register_oop(av_oop_p);
 
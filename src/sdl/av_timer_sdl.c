@@ -14,8 +14,9 @@
 
 av_result_t av_timer_register_oop(av_oop_p);
 
-#define CONTEXT "timer_sdl_ctx"
-#define O_context(o) O_attr(o, CONTEXT)
+/* timer context slot assigned on class registration */
+static int context_slot = 0;
+#define O_context(o) O_context_slot(o, context_slot)
 
 /* SDL timer context */
 typedef struct av_timer_ctx
@@ -47,11 +48,23 @@ typedef struct av_timer_info
 
 } av_timer_info_t, *av_timer_info_p;
 
+/* wakes the main loop waiting for events to render the changes made by a timer callback */
+static void av_timer_sdl_wakeup(void)
+{
+	SDL_Event e;
+	av_memset(&e, 0, sizeof(SDL_Event));
+	e.type = e.user.type = SDL_USEREVENT;
+	e.user.code = AV_EVENT_UPDATE;
+	SDL_PushEvent(&e);
+}
+
 static Uint32 av_timer_sdl_callback(Uint32 interval, void *arg)
 {
 	av_timer_info_p tinfo = (av_timer_info_p)arg;
+	av_bool_t repeat = tinfo->timer_callback(tinfo->arg);
 
-	if (tinfo->timer_callback(tinfo->arg))
+	av_timer_sdl_wakeup();
+	if (repeat)
 	{
 		return interval;
 	}
@@ -92,14 +105,15 @@ static av_result_t av_timer_sdl_add_timer(av_timer_p self,
 static av_result_t av_timer_sdl_remove_timer(av_timer_p self, int timer_id)
 {
 	av_timer_ctx_p ctx = (av_timer_ctx_p)O_context(self);
-	for (ctx->timers->first(ctx->timers); ctx->timers->has_more(ctx->timers); ctx->timers->next(ctx->timers))
+	av_list_item_p item;
+	for (item = ctx->timers->first_item(ctx->timers); item; item = item->next)
 	{
-		av_timer_info_p timer_info = (av_timer_info_p)ctx->timers->get(ctx->timers);
+		av_timer_info_p timer_info = (av_timer_info_p)item->value;
 		if (timer_id == timer_info->timer_id)
 		{
 			SDL_RemoveTimer(timer_info->sdl_timer_id);
 			av_free(timer_info);
-			ctx->timers->remove(ctx->timers);
+			ctx->timers->remove_item(ctx->timers, item);
 			return AV_OK;
 		}
 	}
@@ -122,9 +136,10 @@ static void av_timer_sdl_sleep_ms(unsigned long mills)
 static void av_timer_sdl_destructor(void* pobject)
 {
 	av_timer_ctx_p ctx = (av_timer_ctx_p)O_context(pobject);
-	for (ctx->timers->first(ctx->timers); ctx->timers->has_more(ctx->timers); ctx->timers->next(ctx->timers))
+	av_list_item_p item;
+	for (item = ctx->timers->first_item(ctx->timers); item; item = item->next)
 	{
-		av_timer_info_p timer_info = (av_timer_info_p)ctx->timers->get(ctx->timers);
+		av_timer_info_p timer_info = (av_timer_info_p)item->value;
 		SDL_RemoveTimer(timer_info->sdl_timer_id);
 		av_free(timer_info);
 	}
@@ -153,7 +168,7 @@ static av_result_t av_timer_sdl_constructor(av_object_p pobject)
 		return rc;
 	}
 	ctx->id_gen = 1;
-	O_set_attr(self, CONTEXT, ctx);
+	O_set_context_slot(self, context_slot, ctx);
 	self->add_timer    = av_timer_sdl_add_timer;
 	self->remove_timer = av_timer_sdl_remove_timer;
 	self->sleep        = av_timer_sdl_sleep;
@@ -175,6 +190,8 @@ av_result_t av_timer_sdl_register_oop(av_oop_p oop)
 		av_timer_sdl_constructor, av_timer_sdl_destructor)))
 		return rc;
 
+	if (AV_OK != (rc = oop->get_context_slot(oop, "timer_sdl", &context_slot)))
+		return rc;
 
 	if (AV_OK != (rc = oop->new(oop, "timer_sdl", (av_object_p*)&timer)))
 		return rc;
@@ -0,0 +1,289 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      bench_hash.c                                       */
+/* Description:   Hash table microbenchmark                          */
+/*                                                                   */
+/*********************************************************************/
+
+/*
+	Compares av_hash against the previous quadratic probing implementation,
+	kept here as baseline, on insert, lookup and remove of string keys, and
+	measures the unsynchronized, precomputed hash and pointer key variants.
+	Lookups and removes run once in insertion order and once in random order.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <av_hash.h>
+#include <av_thread.h>
+
+#define BENCH_KEYS    100000
+#define BENCH_ROUNDS  10
+
+/* baseline: quadratic probing over primes, strdup'd keys, locked on every operation */
+
+static const unsigned int old_sizes[] =
+{
+	53, 97, 193, 389, 769, 1543, 3079, 6151, 12289, 24593, 49157, 98317,
+	196613, 393241, 786433, 1572869, 3145739, 6291469, 12582917, 25165843
+};
+
+struct old_record
+{
+	unsigned int hash;
+	char *key;
+	void *value;
+};
+
+/* called through function pointers, as the old av_hash methods were */
+struct old_hash
+{
+	struct old_record *records;
+	unsigned int records_count;
+	unsigned int size_index;
+	av_rwmutex_p mutex;
+
+	void (*add)(struct old_hash *h, const char *key, void *value);
+	void* (*get)(struct old_hash *h, const char *key);
+	void (*remove)(struct old_hash *h, const char *key);
+};
+
+static unsigned int old_strhash(const char *str)
+{
+	int c;
+	int hash = 5381;
+	while ((c = *str++))
+		hash = hash * 33 + c;
+	return hash == 0 ? 1 : hash;
+}
+
+static void old_add(struct old_hash *h, const char *key, void *value);
+
+static void old_grow(struct old_hash *h)
+{
+	unsigned int i;
+	struct old_record *old_recs = h->records;
+	unsigned int old_length = old_sizes[h->size_index];
+
+	h->records = calloc(old_sizes[++h->size_index], sizeof(struct old_record));
+	h->records_count = 0;
+	for (i = 0; i < old_length; i++)
+		if (old_recs[i].hash && old_recs[i].key)
+		{
+			old_add(h, old_recs[i].key, old_recs[i].value);
+			free(old_recs[i].key);
+		}
+	free(old_recs);
+}
+
+static void old_add(struct old_hash *h, const char *key, void *value)
+{
+	unsigned int off = 0, ind, size, code;
+	h->mutex->lock_write(h->mutex);
+	if (h->records_count > old_sizes[h->size_index] * 0.65f)
+	{
+		h->mutex->unlock(h->mutex);
+		old_grow(h);
+		h->mutex->lock_write(h->mutex);
+	}
+	code = old_strhash(key);
+	size = old_sizes[h->size_index];
+	ind = code % size;
+	while (h->records[ind].key)
+		ind = (code + (int)pow(++off, 2)) % size;
+	h->records[ind].hash = code;
+	h->records[ind].key = strdup(key);
+	h->records[ind].value = value;
+	h->records_count++;
+	h->mutex->unlock(h->mutex);
+}
+
+static void* old_get(struct old_hash *h, const char *key)
+{
+	unsigned int off = 0, ind, size, code = old_strhash(key);
+	void *value = 0;
+	h->mutex->lock_read(h->mutex);
+	size = old_sizes[h->size_index];
+	ind = code % size;
+	while (h->records[ind].hash)
+	{
+		if (code == h->records[ind].hash && h->records[ind].key && 0 == strcmp(key, h->records[ind].key))
+		{
+			value = h->records[ind].value;
+			break;
+		}
+		ind = (code + (int)pow(++off, 2)) % size;
+	}
+	h->mutex->unlock(h->mutex);
+	return value;
+}
+
+static void old_remove(struct old_hash *h, const char *key)
+{
+	unsigned int off = 0, ind, size, code = old_strhash(key);
+	h->mutex->lock_write(h->mutex);
+	size = old_sizes[h->size_index];
+	ind = code % size;
+	while (h->records[ind].hash)
+	{
+		if (code == h->records[ind].hash && h->records[ind].key && 0 == strcmp(key, h->records[ind].key))
+		{
+			free(h->records[ind].key);
+			h->records[ind].key = 0;
+			h->records_count--;
+			break;
+		}
+		ind = (code + (int)pow(++off, 2)) % size;
+	}
+	h->mutex->unlock(h->mutex);
+}
+
+static char keys[BENCH_KEYS][16];
+static unsigned int codes[BENCH_KEYS];
+static int order[BENCH_KEYS];
+
+typedef struct bench_result
+{
+	const char* name;
+	double tadd, tget, tremove;
+	unsigned int sum;
+} bench_result_t;
+
+static double elapsed_ms(clock_t start)
+{
+	return 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* one round of the baseline, looking up and removing keys in the given order */
+static void bench_old(bench_result_t* res)
+{
+	struct old_hash h;
+	clock_t start;
+	int i;
+
+	h.records = calloc(old_sizes[0], sizeof(struct old_record));
+	h.records_count = 0;
+	h.size_index = 0;
+	h.add = old_add;
+	h.get = old_get;
+	h.remove = old_remove;
+	av_rwmutex_create(&h.mutex);
+
+	start = clock();
+	for (i = 0; i < BENCH_KEYS; i++)
+		h.add(&h, keys[i], keys[i]);
+	res->tadd += elapsed_ms(start);
+
+	start = clock();
+	for (i = 0; i < BENCH_KEYS; i++)
+		res->sum += (h.get(&h, keys[order[i]]) != 0);
+	res->tget += elapsed_ms(start);
+
+	start = clock();
+	for (i = 0; i < BENCH_KEYS; i++)
+		h.remove(&h, keys[order[i]]);
+	res->tremove += elapsed_ms(start);
+
+	free(h.records);
+	h.mutex->destroy(h.mutex);
+}
+
+/* one round of av_hash, looking up and removing keys in the given order */
+static void bench_new(bench_result_t* res, av_hash_key_t keytype, int flags, av_bool_t prehashed)
+{
+	av_hash_p h;
+	clock_t start;
+	int i;
+
+	av_hash_create_ex(0, keytype, flags, &h);
+	if (prehashed)
+		for (i = 0; i < BENCH_KEYS; i++)
+			codes[i] = h->hash(h, keys[i]);
+
+	start = clock();
+	for (i = 0; i < BENCH_KEYS; i++)
+		if (prehashed)
+			h->add_hashed(h, codes[i], keys[i], keys[i]);
+		else
+			h->add_key(h, keys[i], keys[i]);
+	res->tadd += elapsed_ms(start);
+
+	start = clock();
+	for (i = 0; i < BENCH_KEYS; i++)
+		if (prehashed)
+			res->sum += (h->get_hashed(h, codes[order[i]], keys[order[i]]) != 0);
+		else
+			res->sum += (h->get_key(h, keys[order[i]]) != 0);
+	res->tget += elapsed_ms(start);
+
+	start = clock();
+	for (i = 0; i < BENCH_KEYS; i++)
+		if (prehashed)
+			h->remove_hashed(h, codes[order[i]], keys[order[i]]);
+		else
+			h->remove_key(h, keys[order[i]]);
+	res->tremove += elapsed_ms(start);
+
+	h->destroy(h);
+}
+
+/*
+	Runs every variant once per round so they all see the same heap state,
+	the keys freed in one round are reallocated by the next.
+*/
+static void bench_all(const char* title)
+{
+	bench_result_t res[5];
+	int r, i;
+
+	memset(res, 0, sizeof(res));
+	res[0].name = "baseline";
+	res[1].name = "string";
+	res[2].name = "string unsynchronized";
+	res[3].name = "string prehashed";
+	res[4].name = "pointer unsynchronized";
+
+	for (r = 0; r < BENCH_ROUNDS; r++)
+	{
+		bench_old(&res[0]);
+		bench_new(&res[1], AV_HASH_KEY_STRING, AV_HASH_SYNCHRONIZED, AV_FALSE);
+		bench_new(&res[2], AV_HASH_KEY_STRING, AV_HASH_UNSYNCHRONIZED, AV_FALSE);
+		bench_new(&res[3], AV_HASH_KEY_STRING, AV_HASH_UNSYNCHRONIZED, AV_TRUE);
+		bench_new(&res[4], AV_HASH_KEY_POINTER, AV_HASH_UNSYNCHRONIZED, AV_FALSE);
+	}
+
+	printf("%s\n", title);
+	for (i = 0; i < 5; i++)
+		printf("%-28s add %8.2f ms  get %8.2f ms  remove %8.2f ms  (%u)\n", res[i].name,
+			   res[i].tadd / BENCH_ROUNDS, res[i].tget / BENCH_ROUNDS, res[i].tremove / BENCH_ROUNDS, res[i].sum);
+}
+
+int main(void)
+{
+	int i;
+	for (i = 0; i < BENCH_KEYS; i++)
+	{
+		snprintf(keys[i], sizeof(keys[i]), "key%d", i);
+		order[i] = i;
+	}
+
+	printf("%d keys, average of %d rounds\n", BENCH_KEYS, BENCH_ROUNDS);
+	bench_all("insertion order");
+
+	/* fixed seed shuffle, so runs stay comparable */
+	srand(1);
+	for (i = BENCH_KEYS - 1; i > 0; i--)
+	{
+		int j = rand() % (i + 1), t = order[i];
+		order[i] = order[j];
+		order[j] = t;
+	}
+	bench_all("random order");
+	return 0;
+}
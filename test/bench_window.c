@@ -0,0 +1,112 @@
+/*********************************************************************/
+/*                                                                   */
+/* Copyright (C) 2007,  AVIQ Bulgaria Ltd                            */
+/*                                                                   */
+/* Project:       avgl                                               */
+/* Filename:      bench_window.c                                     */
+/* Description:   Window children index microbenchmark               */
+/*                                                                   */
+/*********************************************************************/
+
+/*
+	Lays out growing numbers of tiles in a container, as in EPG grids and
+	channel walls, and compares point queries (get_child_xy) and rect queries
+	(get_children_in_rect) over the linear children scan and the children
+	index, showing the number of children where the index starts to pay off.
+*/
+
+#include <stdio.h>
+#include <time.h>
+#include <avgl.h>
+
+#define BENCH_QUERIES   20000
+#define BENCH_TILE_W    120
+#define BENCH_TILE_H    40
+#define BENCH_COLUMNS   16
+
+static unsigned int seed = 1;
+
+static int bench_random(int n)
+{
+	seed = seed * 1103515245 + 12345;
+	return (int)((seed >> 16) % n);
+}
+
+static double elapsed_us(clock_t start)
+{
+	return 1000000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void bench_tiles(av_oop_p oop, int count)
+{
+	av_window_p container;
+	av_window_p tile;
+	av_vector_p found;
+	av_rect_t rect;
+	clock_t start;
+	double tpoint[2], trect[2];
+	int width = BENCH_COLUMNS * BENCH_TILE_W;
+	int height = (count / BENCH_COLUMNS + 1) * BENCH_TILE_H;
+	unsigned int sum = 0;
+	int indexed, i;
+
+	oop->new(oop, "window", (av_object_p*)&container);
+	av_vector_create(sizeof(av_window_p), &found);
+	av_rect_init(&rect, 0, 0, width, height);
+	container->methods->set_rect(container, &rect);
+	for (i = 0; i < count; i++)
+	{
+		oop->new(oop, "window", (av_object_p*)&tile);
+		av_rect_init(&rect, (i % BENCH_COLUMNS) * BENCH_TILE_W, (i / BENCH_COLUMNS) * BENCH_TILE_H,
+					 BENCH_TILE_W, BENCH_TILE_H);
+		tile->methods->set_rect(tile, &rect);
+		container->methods->add_child_top(container, tile);
+		O_release(tile);
+	}
+
+	for (indexed = 0; indexed < 2; indexed++)
+	{
+		container->methods->set_children_index(container, indexed);
+
+		seed = 1;
+		start = clock();
+		for (i = 0; i < BENCH_QUERIES; i++)
+			sum += (AV_NULL != container->methods->get_child_xy(container, bench_random(width), bench_random(height)));
+		tpoint[indexed] = elapsed_us(start) / BENCH_QUERIES;
+
+		/* damage of about two tiles */
+		seed = 1;
+		start = clock();
+		for (i = 0; i < BENCH_QUERIES; i++)
+		{
+			av_rect_init(&rect, bench_random(width), bench_random(height), BENCH_TILE_W, 2 * BENCH_TILE_H);
+			found->remove_all(found);
+			container->methods->get_children_in_rect(container, &rect, found);
+			sum += found->size;
+		}
+		trect[indexed] = elapsed_us(start) / BENCH_QUERIES;
+	}
+
+	printf("%6d  point %8.3f us %8.3f us  rect %8.3f us %8.3f us  (%u)\n",
+		   count, tpoint[0], tpoint[1], trect[0], trect[1], sum);
+
+	found->destroy(found);
+	O_release(container);
+}
+
+int main(void)
+{
+	av_oop_p oop;
+	int count;
+
+	av_oop_create(&oop);
+	av_window_register_oop(oop);
+
+	printf("%d queries, linear scan vs children index\n", BENCH_QUERIES);
+	printf("%6s  %-26s  %-25s\n", "tiles", "point linear / indexed", "rect linear / indexed");
+	for (count = 4; count <= 4096; count *= 2)
+		bench_tiles(oop, count);
+
+	oop->destroy(oop);
+	return 0;
+}
@@ -11,9 +11,29 @@
 main()
 {
 //	TEST(test_oop_inheritance)
+//	TEST(test_oop_context_slots)
+//	TEST(test_oop_methods)
+//	TEST(test_oop_new_by_class)
+//	TEST(test_oop_is_a)
+//	TEST(test_oop_is_a_named)
+//	TEST(test_oop_release_deferred)
+//	TEST(test_hash_keys)
+//	TEST(test_hash_cursor)
+//	TEST(test_cache)
+//	TEST(test_image_cache)
+//	TEST(test_list_items)
+//	TEST(test_vector)
+//	TEST(test_region)
+//	TEST(test_grid)
+//	TEST(test_spsc_queue)
+//	TEST(test_task_pool)
 //	TEST(test_avgl_create_destroy)
+//	TEST(test_avgl_task_pool_workers)
 //	TEST(test_window_absolute)
+//	TEST(test_window_geometry)
+//	TEST(test_window_index)
 //	TEST(test_event_mouse)
+//	TEST(test_event_wait_timer)
 //	TEST(test_widgets)
 //	TEST(test_surface)
 //	TEST(test_visible)
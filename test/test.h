@@ -3,8 +3,28 @@
 #define __TEST_H
 
 int test_oop_inheritance();
+int test_oop_context_slots();
+int test_oop_methods();
+int test_oop_new_by_class();
+int test_oop_is_a();
+int test_oop_is_a_named();
+int test_oop_release_deferred();
+int test_hash_keys();
+int test_hash_cursor();
+int test_cache();
+int test_image_cache();
+int test_list_items();
+int test_vector();
+int test_region();
+int test_spsc_queue();
+int test_task_pool();
 int test_avgl_create_destroy();
+int test_avgl_task_pool_workers();
+int test_event_wait_timer();
 int test_window_absolute();
+int test_window_geometry();
+int test_window_index();
+int test_grid();
 int test_surface();
 int test_visible();
 int test_sprite();
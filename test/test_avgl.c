@@ -6,7 +6,7 @@
 void on_draw(av_visible_p self, av_graphics_p graphics)
 {
 	av_rect_t rect;
-	((av_window_p)self)->get_rect((av_window_p)self, &rect);
+	((av_window_p)self)->methods->get_rect((av_window_p)self, &rect);
 	rect.x = rect.y = 0;
 	graphics->set_color_rgba(graphics, RAND_COLOR, RAND_COLOR, RAND_COLOR, RAND_COLOR);
 	graphics->rectangle(graphics, &rect);
@@ -15,7 +15,7 @@ void on_draw(av_visible_p self, av_graphics_p graphics)
 
 av_bool_t on_mouse_button_down(av_window_p self, av_event_mouse_button_t button, int x, int y)
 {
-	self->raise_top(self);
+	self->methods->raise_top(self);
 	return AV_TRUE;
 }
 
@@ -24,11 +24,11 @@ void create_visible(av_visible_p parent, int x, int y)
 	av_rect_t rect;
 	av_visible_p visible;
 	av_rect_init(&rect, x, y, 10, 5);
-	parent->create_child(parent, "visible", &visible);
+	parent->methods->create_child(parent, "visible", &visible);
 	visible->on_draw = on_draw;
 	av_window_p window = (av_window_p)visible;
-	window->set_rect(window, &rect);
-	visible->draw(visible);
+	window->methods->set_rect(window, &rect);
+	visible->methods->draw(visible);
 	window->on_mouse_button_down = on_mouse_button_down;
 }
 
@@ -48,3 +48,28 @@ int test_avgl_create_destroy()
 
 	return 1;
 }
+
+/* the task pool takes its worker count from the prefs service */
+int test_avgl_task_pool_workers()
+{
+	av_oop_p oop;
+	av_prefs_p prefs;
+	av_system_p system;
+	av_task_pool_p pool;
+	int ok = 0;
+	av_visible_p main_visible = avgl_create(AV_NULL);
+	if (!main_visible)
+		return 0;
+
+	oop = O_oop(main_visible);
+	if (AV_OK == oop->get_service(oop, "prefs", (av_service_p*)&prefs)
+		&& AV_OK == oop->get_service(oop, "system", (av_service_p*)&system))
+	{
+		prefs->set_int(prefs, "system.task_pool.workers", 3);
+		if (AV_OK == system->get_task_pool(system, &pool))
+			ok = (3 == pool->get_workers(pool));
+	}
+	avgl_destroy();
+
+	return ok;
+}
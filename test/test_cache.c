@@ -0,0 +1,59 @@
+#include <avgl.h>
+#include <av_cache.h>
+
+static int freed = 0;
+
+static void cache_test_free(void* value)
+{
+	AV_UNUSED(value);
+	freed++;
+}
+
+int test_cache()
+{
+	av_cache_p cache;
+	av_cache_stats_t stats;
+	int values[4];
+
+	if (AV_OK != av_cache_create(30, cache_test_free, &cache))
+		return 0;
+
+	cache->add(cache, "a", &values[0], 10);
+	cache->add(cache, "b", &values[1], 10);
+	cache->add(cache, "c", &values[2], 10);
+
+	/* touching a makes b the least recently used */
+	if (&values[0] != cache->get(cache, "a"))
+		return 0;
+	cache->add(cache, "d", &values[3], 10);
+	if (1 != freed || cache->get(cache, "b") || &values[2] != cache->get(cache, "c"))
+		return 0;
+
+	/* replacing releases the old value */
+	cache->add(cache, "c", &values[1], 5);
+	if (2 != freed || &values[1] != cache->get(cache, "c"))
+		return 0;
+
+	cache->get_stats(cache, &stats);
+	if (3 != stats.hits || 1 != stats.misses || 1 != stats.evictions || 3 != stats.count || 25 != stats.bytes)
+		return 0;
+
+	/* value larger than the budget is kept alone */
+	cache->add(cache, "e", &values[0], 100);
+	cache->get_stats(cache, &stats);
+	if (5 != freed || 1 != stats.count || &values[0] != cache->get(cache, "e"))
+		return 0;
+
+	if (!cache->remove(cache, "e") || cache->remove(cache, "e") || 6 != freed)
+		return 0;
+
+	cache->add(cache, "a", &values[0], 10);
+	cache->set_budget(cache, 0);
+	cache->get_stats(cache, &stats);
+	if (0 != stats.count || 0 != stats.bytes || 7 != freed)
+		return 0;
+
+	cache->add(cache, "a", &values[0], 0);
+	cache->destroy(cache);
+	return 8 == freed;
+}
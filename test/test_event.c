@@ -8,7 +8,7 @@ static av_bool_t child_move_bubble = AV_FALSE;
 static void print_window_xy(const char* name, av_window_p self, int x, int y)
 {
 	av_rect_t rect;
-	self->get_absolute_rect(self, &rect);
+	self->methods->get_absolute_rect(self, &rect);
 	printf("%s: x = %d, y = %d (%d %d %d %d)\n", name, x, y, rect.x, rect.y, rect.w, rect.h);
 }
 
@@ -63,19 +63,19 @@ int test_event_mouse()
 	av_visible_p root = avgl_create(AV_NULL);
 	av_rect_t rect;
 
-	root->create_child(root, "visible", (av_visible_p*)&parent);
+	root->methods->create_child(root, "visible", (av_visible_p*)&parent);
 	av_rect_init(&rect, 10, 10, 5, 5);
-	parent->set_rect(parent, &rect);
+	parent->methods->set_rect(parent, &rect);
 	parent->on_mouse_move = on_mouse_move_parent;
 
-	((av_visible_p)parent)->create_child((av_visible_p)parent, "visible", (av_visible_p*)&child1);
+	((av_visible_p)parent)->methods->create_child((av_visible_p)parent, "visible", (av_visible_p*)&child1);
 	av_rect_init(&rect, 1, 1, 2, 2);
-	child1->set_rect(child1, &rect);
+	child1->methods->set_rect(child1, &rect);
 	child1->on_mouse_move = on_mouse_move_child;
 
-	((av_visible_p)parent)->create_child((av_visible_p)parent, "visible", (av_visible_p*)&child2);
+	((av_visible_p)parent)->methods->create_child((av_visible_p)parent, "visible", (av_visible_p*)&child2);
 	av_rect_init(&rect, 3, 3, 2, 2);
-	child2->set_rect(child2, &rect);
+	child2->methods->set_rect(child2, &rect);
 	child2->on_mouse_move = on_mouse_move_child_bubble;
 
 	// assert no event
@@ -120,3 +120,70 @@ int test_event_mouse()
 	avgl_destroy();
 	return 1;
 }
+
+static av_bool_t timer_fired = AV_FALSE;
+static av_bool_t timer_timed_out = AV_FALSE;
+static av_bool_t timer_presented = AV_FALSE;
+
+static void on_draw_timer(av_visible_p self, av_graphics_p graphics)
+{
+	AV_UNUSED(self);
+	AV_UNUSED(graphics);
+	if (timer_fired && !timer_presented)
+	{
+		av_event_t event;
+		timer_presented = !timer_timed_out;
+		event.type = AV_EVENT_QUIT;
+		avgl_event_push(&event);
+	}
+}
+
+static av_bool_t on_timer_invalidate(void* arg)
+{
+	av_visible_p visible = (av_visible_p)arg;
+	timer_fired = AV_TRUE;
+	visible->methods->draw(visible);
+	return AV_FALSE;
+}
+
+static av_bool_t on_timer_timeout(void* arg)
+{
+	av_event_t event;
+	AV_UNUSED(arg);
+	timer_timed_out = AV_TRUE;
+	event.type = AV_EVENT_QUIT;
+	avgl_event_push(&event);
+	return AV_FALSE;
+}
+
+/* the wait mode loop presents what a timer invalidated without further input */
+int test_event_wait_timer()
+{
+	av_visible_p visible;
+	av_system_p system;
+	av_rect_t rect;
+	int timeout_id;
+	av_visible_p root = avgl_create(AV_NULL);
+	av_oop_p oop = O_oop(root);
+
+	if (AV_OK != oop->get_service(oop, "system", (av_service_p*)&system))
+	{
+		avgl_destroy();
+		return 0;
+	}
+
+	root->methods->create_child(root, "visible", &visible);
+	av_rect_init(&rect, 10, 10, 5, 5);
+	((av_window_p)visible)->methods->set_rect((av_window_p)visible, &rect);
+	visible->on_draw = on_draw_timer;
+
+	system->timer->add_timer(system->timer, on_timer_invalidate, 100, visible, AV_NULL);
+	system->timer->add_timer(system->timer, on_timer_timeout, 2000, AV_NULL, &timeout_id);
+	avgl_set_loop_mode(AV_LOOP_MODE_WAIT);
+	avgl_loop();
+
+	if (!timer_timed_out)
+		system->timer->remove_timer(system->timer, timeout_id);
+	avgl_destroy();
+	return timer_presented;
+}
@@ -0,0 +1,102 @@
+#include <avgl.h>
+#include <av_grid.h>
+
+#define GRID_TEST_ITEMS 200
+#define GRID_TEST_ROUNDS 2000
+
+static unsigned int seed = 1;
+
+static int grid_random(int n)
+{
+	seed = seed * 1103515245 + 12345;
+	return (int)((seed >> 16) % n);
+}
+
+/* rects of various sizes around the origin, including empty and huge ones */
+static void random_rect(av_rect_p rect)
+{
+	int size = grid_random(4) ? 200 : 3000;
+	av_rect_init(rect, grid_random(2000) - 500, grid_random(2000) - 500,
+				 grid_random(size), grid_random(size));
+}
+
+static int grid_rect_found(av_vector_p items, void* item)
+{
+	int n = 0;
+	void** pitem;
+	av_vector_foreach(items, void*, pitem)
+		if (*pitem == item)
+			n++;
+	return n;
+}
+
+int test_grid()
+{
+	av_grid_p grid;
+	av_vector_p items;
+	av_rect_t rects[GRID_TEST_ITEMS];
+	av_bool_t added[GRID_TEST_ITEMS];
+	av_rect_t query;
+	int i, j;
+
+	if (AV_OK != av_grid_create(64, &grid))
+		return 0;
+	if (AV_OK != av_vector_create(sizeof(void*), &items))
+		return 0;
+
+	for (i = 0; i < GRID_TEST_ITEMS; i++)
+		added[i] = AV_FALSE;
+
+	for (i = 0; i < GRID_TEST_ROUNDS; i++)
+	{
+		int n = grid_random(GRID_TEST_ITEMS);
+
+		/* add, move or remove random item */
+		if (added[n] && 0 == grid_random(4))
+		{
+			if (!grid->remove(grid, &rects[n]))
+				return 0;
+			added[n] = AV_FALSE;
+		}
+		else
+		{
+			random_rect(&rects[n]);
+			if (AV_OK != grid->add(grid, &rects[n], &rects[n]))
+				return 0;
+			added[n] = AV_TRUE;
+		}
+
+		/* queries match brute force */
+		random_rect(&query);
+		items->remove_all(items);
+		if (AV_OK != grid->query_rect(grid, &query, items))
+			return 0;
+		for (j = 0; j < GRID_TEST_ITEMS; j++)
+		{
+			av_rect_t irect;
+			int expected = added[j] && rects[j].w > 0 && rects[j].h > 0 && query.w > 0 && query.h > 0
+						 && av_rect_intersect(&rects[j], &query, &irect);
+			if (expected != grid_rect_found(items, &rects[j]))
+				return 0;
+		}
+
+		items->remove_all(items);
+		if (AV_OK != grid->query_point(grid, query.x, query.y, items))
+			return 0;
+		for (j = 0; j < GRID_TEST_ITEMS; j++)
+			if ((added[j] && av_rect_point_inside(&rects[j], query.x, query.y)) != grid_rect_found(items, &rects[j]))
+				return 0;
+	}
+
+	/* item without rect matches all queries */
+	if (AV_OK != grid->add(grid, &query, AV_NULL))
+		return 0;
+	items->remove_all(items);
+	grid->query_point(grid, -10000, 10000, items);
+	if (1 != items->size || &query != av_vector_at(items, void*, 0))
+		return 0;
+
+	items->destroy(items);
+	grid->destroy(grid);
+	return 1;
+}
@@ -0,0 +1,109 @@
+#include <avgl.h>
+#include <av_hash.h>
+#include <stdio.h>
+
+#define HASH_TEST_COUNT 1000
+
+int test_hash_keys()
+{
+	av_hash_p strings;
+	av_hash_p pointers;
+	av_hash_p integers;
+	int values[HASH_TEST_COUNT];
+	char key[16];
+	const char* k;
+	void* v;
+	unsigned int code;
+	int i, n;
+
+	if (AV_OK != av_hash_create(AV_HASH_CAPACITY_SMALL, &strings))
+		return 0;
+
+	/* string keys are copied and adding existing key replaces the value */
+	for (i = 0; i < HASH_TEST_COUNT; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		if (AV_OK != strings->add(strings, key, &values[i]))
+			return 0;
+	}
+	if (AV_OK != strings->add(strings, "key0", &values[1]))
+		return 0;
+	if (HASH_TEST_COUNT != strings->size(strings))
+		return 0;
+	if (&values[1] != strings->get(strings, "key0"))
+		return 0;
+	if (AV_EARG != strings->add(strings, "", &values[0]))
+		return 0;
+
+	/* removing every other key keeps the rest reachable */
+	for (i = 0; i < HASH_TEST_COUNT; i += 2)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		strings->remove(strings, key);
+	}
+	for (i = 1; i < HASH_TEST_COUNT; i += 2)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		if (&values[i] != strings->get(strings, key))
+			return 0;
+	}
+	if (strings->get(strings, "key2"))
+		return 0;
+
+	/* precomputed hash code matches the plain lookup */
+	code = strings->hash(strings, "key3");
+	if (&values[3] != strings->get_hashed(strings, code, "key3"))
+		return 0;
+
+	n = 0;
+	for (strings->first(strings); strings->next(strings, &k, &v); n++);
+	if (HASH_TEST_COUNT / 2 != n)
+		return 0;
+	strings->destroy(strings);
+
+	if (AV_OK != av_hash_create_ex(AV_HASH_CAPACITY_SMALL, AV_HASH_KEY_POINTER, AV_HASH_UNSYNCHRONIZED, &pointers))
+		return 0;
+	for (i = 0; i < HASH_TEST_COUNT; i++)
+		pointers->add_key(pointers, &values[i], (void*)(intptr_t)(i + 1));
+	for (i = 0; i < HASH_TEST_COUNT; i++)
+		if (AV_HASH_INT_KEY(i + 1) != pointers->get_key(pointers, &values[i]))
+			return 0;
+	pointers->destroy(pointers);
+
+	if (AV_OK != av_hash_create_ex(AV_HASH_CAPACITY_SMALL, AV_HASH_KEY_INTEGER, AV_HASH_SYNCHRONIZED, &integers))
+		return 0;
+	for (i = 0; i < HASH_TEST_COUNT; i++)
+		integers->add_key(integers, AV_HASH_INT_KEY(i), &values[i]);
+	for (i = 0; i < HASH_TEST_COUNT; i++)
+		if (&values[i] != integers->remove_key(integers, AV_HASH_INT_KEY(i)))
+			return 0;
+	if (0 != integers->size(integers))
+		return 0;
+	integers->destroy(integers);
+
+	return 1;
+}
+
+int test_hash_cursor()
+{
+	av_hash_p hash;
+	av_hash_cursor_t outer;
+	av_hash_cursor_t inner;
+	const void* key;
+	const void* ikey;
+	void* value;
+	int i, n = 0;
+
+	if (AV_OK != av_hash_create_ex(AV_HASH_CAPACITY_SMALL, AV_HASH_KEY_INTEGER, AV_HASH_UNSYNCHRONIZED, &hash))
+		return 0;
+	for (i = 1; i <= 10; i++)
+		hash->add_key(hash, AV_HASH_INT_KEY(i), &i);
+
+	/* nested traversals of the same table */
+	for (hash->cursor_first(hash, &outer); hash->cursor_next(hash, &outer, &key, &value);)
+		for (hash->cursor_first(hash, &inner); hash->cursor_next(hash, &inner, &ikey, &value);)
+			n++;
+
+	hash->destroy(hash);
+	return (100 == n);
+}
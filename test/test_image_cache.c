@@ -0,0 +1,128 @@
+#include <stdio.h>
+#ifdef _MSC_VER
+#include <sys/utime.h>
+#define utime _utime
+#define utimbuf _utimbuf
+#else
+#include <utime.h>
+#endif
+#include <avgl.h>
+#include <av_image_cache.h>
+
+#define IMAGE_TEST_BYTES 60
+
+/* fake image counting its references */
+typedef struct
+{
+	int refs;
+} test_image_t;
+
+static int decoded = 0;
+static int released = 0;
+
+static av_result_t test_image_decode(void* param, const char* filename, void** ppimage, unsigned int* pbytes)
+{
+	test_image_t* image = (test_image_t*)av_calloc(1, sizeof(test_image_t));
+	AV_UNUSED(param);
+	AV_UNUSED(filename);
+	image->refs = 1;
+	decoded++;
+	*ppimage = image;
+	*pbytes = IMAGE_TEST_BYTES;
+	return AV_OK;
+}
+
+static void test_image_addref(void* image)
+{
+	((test_image_t*)image)->refs++;
+}
+
+static void test_image_release(void* image)
+{
+	if (0 == --((test_image_t*)image)->refs)
+	{
+		av_free(image);
+		released++;
+	}
+}
+
+static av_bool_t test_image_is_shared(void* image)
+{
+	return ((test_image_t*)image)->refs > 1;
+}
+
+static av_image_type_t test_image_type =
+{
+	"test", test_image_decode, test_image_addref, test_image_release, test_image_is_shared
+};
+
+static int test_image_file(const char* filename)
+{
+	FILE* f = fopen(filename, "w");
+	if (!f)
+		return 0;
+	fputs("image", f);
+	fclose(f);
+	return 1;
+}
+
+int test_image_cache()
+{
+	const char* files[] = { "test_image_a.tmp", "test_image_b.tmp", "test_image_c.tmp" };
+	void* a, *a2, *b, *c;
+	av_image_cache_stats_t stats;
+	struct utimbuf times;
+	int i, ok = 0;
+
+	for (i = 0; i < 3; i++)
+		if (!test_image_file(files[i]))
+			return 0;
+
+	if (AV_OK != av_image_cache_initialize(2 * IMAGE_TEST_BYTES - 20))
+		return 0;
+
+	/* the second load shares the decoded image */
+	av_image_cache_load(&test_image_type, AV_NULL, files[0], &a);
+	av_image_cache_load(&test_image_type, AV_NULL, files[0], &a2);
+	if (a != a2 || 1 != decoded || 3 != ((test_image_t*)a)->refs)
+		goto done;
+
+	/* images in use are kept over budget */
+	av_image_cache_load(&test_image_type, AV_NULL, files[1], &b);
+	av_image_cache_get_stats(&stats);
+	if (2 != stats.count || 2 * IMAGE_TEST_BYTES != stats.resident_bytes)
+		goto done;
+
+	/* released images are evicted least recently used first */
+	test_image_release(a);
+	test_image_release(a2);
+	av_image_cache_load(&test_image_type, AV_NULL, files[2], &c);
+	if (1 != released || AV_EFOUND != av_image_cache_pin(&test_image_type, files[0], AV_TRUE))
+		goto done;
+
+	/* pinned images are not evicted */
+	if (AV_OK != av_image_cache_pin(&test_image_type, files[1], AV_TRUE))
+		goto done;
+	test_image_release(b);
+	test_image_release(c);
+	av_image_cache_set_budget(0);
+	av_image_cache_get_stats(&stats);
+	if (2 != released || 1 != stats.count || 1 != stats.pinned || 1 != stats.hits || 3 != stats.misses
+		|| 2 != stats.evictions)
+		goto done;
+
+	/* modified file is decoded again */
+	times.actime = times.modtime = 1000;
+	utime(files[1], &times);
+	av_image_cache_load(&test_image_type, AV_NULL, files[1], &b);
+	test_image_release(b);
+	if (4 != decoded)
+		goto done;
+
+	ok = 1;
+done:
+	av_image_cache_finalize();
+	for (i = 0; i < 3; i++)
+		remove(files[i]);
+	return ok && decoded == released;
+}
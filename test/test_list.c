@@ -0,0 +1,40 @@
+#include <avgl.h>
+
+int test_list_items()
+{
+	av_list_p list;
+	av_list_item_p outer;
+	av_list_item_p inner;
+	av_list_item_p next;
+	int values[10];
+	int i, n = 0;
+
+	if (AV_OK != av_list_create(&list))
+		return 0;
+	for (i = 0; i < 10; i++)
+		list->push_last(list, &values[i]);
+
+	/* nested traversals of the same list */
+	for (outer = list->first_item(list); outer; outer = outer->next)
+		for (inner = list->last_item(list); inner; inner = inner->prev)
+			n++;
+	if (100 != n)
+		return 0;
+
+	/* removing items while iterating */
+	for (outer = list->first_item(list), i = 0; outer; outer = next, i++)
+	{
+		next = outer->next;
+		if (i % 2)
+			list->remove_item(list, outer);
+	}
+	if (5 != list->size(list))
+		return 0;
+
+	for (outer = list->first_item(list), i = 0; outer; outer = outer->next, i += 2)
+		if (outer->value != &values[i])
+			return 0;
+
+	list->destroy(list);
+	return 1;
+}
@@ -93,3 +93,207 @@ int test_oop_inheritance()
 	return status;
 }
 
+
+int test_oop_context_slots()
+{
+	int status;
+	int foo_slot, boo_slot;
+	int foo_ctx, boo_ctx;
+	av_oop_p oop;
+	av_boo_p boo;
+	av_oop_create(&oop);
+	oop->define_class(oop, "foo", NULL, sizeof(av_foo_t), av_foo_constructor, av_foo_destructor);
+	oop->define_class(oop, "boo", "foo", sizeof(av_boo_t), av_boo_constructor, av_boo_destructor);
+	oop->get_context_slot(oop, "foo", &foo_slot);
+	oop->get_context_slot(oop, "boo", &boo_slot);
+	oop->new(oop, "boo", (av_object_p*)&boo);
+	O_set_context_slot(boo, foo_slot, &foo_ctx);
+	O_set_context_slot(boo, boo_slot, &boo_ctx);
+	status = foo_slot != boo_slot
+		&& O_context_slot(boo, foo_slot) == &foo_ctx
+		&& O_context_slot(boo, boo_slot) == &boo_ctx
+		&& AV_EFOUND == oop->get_context_slot(oop, "moo", &foo_slot);
+	O_release(boo);
+	oop->destroy(oop);
+	return status;
+}
+
+/* methods table shared by foo instances */
+typedef struct _av_foo_methods_t
+{
+	int (*get_id)(av_foo_p self);
+} av_foo_methods_t, *av_foo_methods_p;
+
+static int av_foo_get_id(av_foo_p self)
+{
+	AV_UNUSED(self);
+	return 1;
+}
+
+static int av_boo_get_id(av_foo_p self)
+{
+	AV_UNUSED(self);
+	return 2;
+}
+
+static void av_foo_methods_initializer(void* methods)
+{
+	((av_foo_methods_p)methods)->get_id = av_foo_get_id;
+}
+
+static void av_boo_methods_initializer(void* methods)
+{
+	((av_foo_methods_p)methods)->get_id = av_boo_get_id;
+}
+
+int test_oop_methods()
+{
+	int status;
+	av_oop_p oop;
+	av_foo_p foo1, foo2;
+	av_boo_p boo;
+	av_oop_create(&oop);
+	oop->define_class(oop, "foo", NULL, sizeof(av_foo_t), av_foo_constructor, av_foo_destructor);
+	oop->define_methods(oop, "foo", sizeof(av_foo_methods_t), av_foo_methods_initializer);
+	oop->define_class(oop, "boo", "foo", sizeof(av_boo_t), av_boo_constructor, av_boo_destructor);
+	oop->define_methods(oop, "boo", sizeof(av_foo_methods_t), av_boo_methods_initializer);
+	oop->new(oop, "foo", (av_object_p*)&foo1);
+	oop->new(oop, "foo", (av_object_p*)&foo2);
+	oop->new(oop, "boo", (av_object_p*)&boo);
+	status = O_methods(foo1) == O_methods(foo2)
+		&& 1 == ((av_foo_methods_p)O_methods(foo1))->get_id(foo1)
+		&& 2 == ((av_foo_methods_p)O_methods(boo))->get_id((av_foo_p)boo);
+	O_release(boo);
+	O_release(foo2);
+	O_release(foo1);
+	oop->destroy(oop);
+	return status;
+}
+
+int test_oop_new_by_class()
+{
+	int i;
+	int status = 1;
+	av_oop_p oop;
+	av_class_p boo_class;
+	av_boo_p boos[100];
+	av_oop_create(&oop);
+	oop->define_class(oop, "foo", NULL, sizeof(av_foo_t), av_foo_constructor, av_foo_destructor);
+	oop->define_class(oop, "boo", "foo", sizeof(av_boo_t), av_boo_constructor, av_boo_destructor);
+	oop->get_class(oop, "boo", &boo_class);
+
+	/* objects memory is reused after release and constructed again */
+	for (i = 0; i < 100; i++)
+		oop->new_by_class(oop, boo_class, (av_object_p*)&boos[i]);
+	for (i = 0; i < 100; i++)
+	{
+		boos[i]->do_boolish(boos[i]);
+		O_release(boos[i]);
+	}
+	for (i = 0; i < 100; i++)
+	{
+		oop->new_by_class(oop, boo_class, (av_object_p*)&boos[i]);
+		status = status && boos[i]->invoked == 0 && O_is_a(boos[i], "foo");
+	}
+	for (i = 0; i < 100; i++)
+		O_release(boos[i]);
+	oop->destroy(oop);
+	return status;
+}
+
+int test_oop_is_a()
+{
+	int status;
+	av_oop_p oop;
+	av_class_p foo_class, boo_class;
+	av_foo_p foo;
+	av_boo_p boo;
+	av_oop_create(&oop);
+	oop->define_class(oop, "foo", NULL, sizeof(av_foo_t), av_foo_constructor, av_foo_destructor);
+	oop->define_class(oop, "boo", "foo", sizeof(av_boo_t), av_boo_constructor, av_boo_destructor);
+	oop->get_class(oop, "foo", &foo_class);
+	oop->get_class(oop, "boo", &boo_class);
+	oop->new(oop, "foo", (av_object_p*)&foo);
+	oop->new(oop, "boo", (av_object_p*)&boo);
+	status = O_is_a_class(boo, foo_class) && O_is_a_class(boo, boo_class)
+		&& O_is_a_class(foo, foo_class) && !O_is_a_class(foo, boo_class)
+		&& O_is_a(boo, "foo") && O_is_a(boo, "object") && !O_is_a(foo, "boo") && !O_is_a(foo, "moo");
+	O_release(boo);
+	O_release(foo);
+	oop->destroy(oop);
+	return status;
+}
+
+/* call site resolving the class name once */
+static int is_moo(void* object)
+{
+	static av_class_cache_t moo_class = AV_CLASS_CACHE_INIT;
+	return O_is_a_named(object, "moo", &moo_class);
+}
+
+int test_oop_is_a_named()
+{
+	int status;
+	av_oop_p oop;
+	av_foo_p foo;
+	av_boo_p moo;
+	av_oop_create(&oop);
+	oop->define_class(oop, "foo", NULL, sizeof(av_foo_t), av_foo_constructor, av_foo_destructor);
+	oop->new(oop, "foo", (av_object_p*)&foo);
+
+	/* the name is not registered yet */
+	status = !is_moo(foo);
+
+	/* a new class definition invalidates the cached name */
+	oop->define_class(oop, "moo", "foo", sizeof(av_boo_t), av_boo_constructor, av_boo_destructor);
+	oop->new(oop, "moo", (av_object_p*)&moo);
+	status = status && is_moo(moo) && !is_moo(foo) && is_moo(moo);
+	O_release(moo);
+	O_release(foo);
+	oop->destroy(oop);
+
+	/* a new container resolves the name again */
+	av_oop_create(&oop);
+	oop->define_class(oop, "moo", NULL, sizeof(av_boo_t), AV_NULL, AV_NULL);
+	oop->new(oop, "moo", (av_object_p*)&moo);
+	status = status && is_moo(moo);
+	O_release(moo);
+	oop->destroy(oop);
+	return status;
+}
+
+static int release_deferred_thread(av_thread_p thread)
+{
+	av_object_p object = (av_object_p)thread->arg;
+	O_release_deferred(object);
+	return 0;
+}
+
+int test_oop_release_deferred()
+{
+	int i;
+	int status;
+	av_oop_p oop;
+	av_foo_p foos[10];
+	av_thread_p threads[10];
+	av_oop_create(&oop);
+	oop->define_class(oop, "foo", NULL, sizeof(av_foo_t), av_foo_constructor, av_foo_destructor);
+	for (i = 0; i < 10; i++)
+	{
+		oop->new(oop, "foo", (av_object_p*)&foos[i]);
+		av_thread_create(release_deferred_thread, foos[i], &threads[i]);
+		threads[i]->start(threads[i]);
+	}
+	for (i = 0; i < 10; i++)
+	{
+		threads[i]->join(threads[i]);
+		threads[i]->destroy(threads[i]);
+	}
+
+	/* all objects are released but still not destroyed */
+	status = AV_NULL != oop->deferred;
+	oop->destroy_deferred(oop);
+	status = status && AV_NULL == oop->deferred;
+	oop->destroy(oop);
+	return status;
+}
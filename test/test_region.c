@@ -0,0 +1,130 @@
+#include <avgl.h>
+#include <av_region.h>
+
+#define REGION_TEST_SIZE 64
+#define REGION_TEST_ROUNDS 500
+
+static unsigned int seed = 1;
+
+static int region_random(int n)
+{
+	seed = seed * 1103515245 + 12345;
+	return (int)((seed >> 16) % n);
+}
+
+static void random_rect(av_rect_p rect)
+{
+	av_rect_init(rect, region_random(REGION_TEST_SIZE), region_random(REGION_TEST_SIZE),
+				 region_random(REGION_TEST_SIZE / 2) + 1, region_random(REGION_TEST_SIZE / 2) + 1);
+}
+
+/* paints region into mask, fails if rects overlap or break the banding */
+static int region_paint(av_region_p region, unsigned char mask[][2 * REGION_TEST_SIZE])
+{
+	av_rect_p rect;
+	int x, y;
+
+	av_memset((unsigned char*)mask, 0, 2 * REGION_TEST_SIZE * 2 * REGION_TEST_SIZE);
+	av_region_foreach(region, rect)
+	{
+		if (rect->w <= 0 || rect->h <= 0)
+			return 0;
+		if (rect > region->rects)
+		{
+			av_rect_p prev = rect - 1;
+			if (prev->y > rect->y || (prev->y == rect->y && (prev->h != rect->h || prev->x + prev->w >= rect->x)))
+				return 0;
+		}
+		for (y = rect->y; y < rect->y + rect->h; y++)
+			for (x = rect->x; x < rect->x + rect->w; x++)
+			{
+				if (mask[y][x])
+					return 0;
+				mask[y][x] = 1;
+			}
+	}
+	return 1;
+}
+
+int test_region()
+{
+	static unsigned char a[2 * REGION_TEST_SIZE][2 * REGION_TEST_SIZE];
+	static unsigned char b[2 * REGION_TEST_SIZE][2 * REGION_TEST_SIZE];
+	static unsigned char r[2 * REGION_TEST_SIZE][2 * REGION_TEST_SIZE];
+	av_region_t ra = AV_REGION_INIT;
+	av_region_t rb = AV_REGION_INIT;
+	av_region_t result = AV_REGION_INIT;
+	av_rect_t rect;
+	int i, j, x, y;
+
+	/* touching rects of equal spans collapse into one */
+	av_rect_init(&rect, 0, 0, 10, 10);
+	av_region_set_rect(&ra, &rect);
+	av_rect_init(&rect, 0, 10, 10, 10);
+	av_region_union_rect(&ra, &ra, &rect);
+	av_rect_init(&rect, 10, 0, 5, 20);
+	av_region_union_rect(&ra, &ra, &rect);
+	if (1 != ra.count || 15 != ra.extents.w || 20 != ra.extents.h || 300 != av_region_area(&ra))
+		return 0;
+
+	/* punching a hole leaves four rects in three bands */
+	av_rect_init(&rect, 5, 5, 5, 5);
+	av_region_subtract_rect(&ra, &ra, &rect);
+	if (4 != ra.count || 275 != av_region_area(&ra) || av_region_contains_point(&ra, 7, 7))
+		return 0;
+	if (av_region_intersects_rect(&ra, &rect) || av_region_contains_rect(&ra, &rect))
+		return 0;
+	av_rect_init(&rect, 0, 0, 15, 5);
+	if (!av_region_contains_rect(&ra, &rect))
+		return 0;
+
+	av_region_translate(&ra, -5, 3);
+	if (-5 != ra.extents.x || 3 != ra.extents.y || !av_region_contains_point(&ra, -5, 3))
+		return 0;
+
+	/* set operations match the per pixel ones */
+	for (i = 0; i < REGION_TEST_ROUNDS; i++)
+	{
+		av_region_clear(&ra);
+		av_region_clear(&rb);
+		for (j = region_random(8); j >= 0; j--)
+		{
+			random_rect(&rect);
+			av_region_union_rect(&ra, &ra, &rect);
+			random_rect(&rect);
+			av_region_union_rect(&rb, &rb, &rect);
+		}
+		if (!region_paint(&ra, a) || !region_paint(&rb, b))
+			return 0;
+
+		av_region_union(&result, &ra, &rb);
+		if (!region_paint(&result, r))
+			return 0;
+		for (y = 0; y < 2 * REGION_TEST_SIZE; y++)
+			for (x = 0; x < 2 * REGION_TEST_SIZE; x++)
+				if (r[y][x] != (a[y][x] | b[y][x]))
+					return 0;
+
+		av_region_intersect(&result, &ra, &rb);
+		if (!region_paint(&result, r))
+			return 0;
+		for (y = 0; y < 2 * REGION_TEST_SIZE; y++)
+			for (x = 0; x < 2 * REGION_TEST_SIZE; x++)
+				if (r[y][x] != (a[y][x] & b[y][x]))
+					return 0;
+
+		/* the destination may be an operand */
+		av_region_subtract(&ra, &ra, &rb);
+		if (!region_paint(&ra, r))
+			return 0;
+		for (y = 0; y < 2 * REGION_TEST_SIZE; y++)
+			for (x = 0; x < 2 * REGION_TEST_SIZE; x++)
+				if (r[y][x] != (a[y][x] & !b[y][x]))
+					return 0;
+	}
+
+	av_region_free(&ra);
+	av_region_free(&rb);
+	av_region_free(&result);
+	return 1;
+}
@@ -26,7 +26,7 @@ static const int explosion_height = 64;
 av_bool_t sprite_timer(void* arg)
 {
 	av_sprite_p sprite = (av_sprite_p)arg;
-	sprite->set_sequence(sprite, seq_explosion, EXPLOSION_SEQ_COUNT, 700, AV_TRUE);
+	sprite->methods->set_sequence(sprite, seq_explosion, EXPLOSION_SEQ_COUNT, 700, AV_TRUE);
 	return AV_FALSE;
 }
 
@@ -37,7 +37,7 @@ av_bool_t girl_move_timer(void* arg)
 {
 	av_rect_t rect;
 	av_sprite_p sprite = (av_sprite_p)arg;
-	((av_window_p)sprite)->get_rect((av_window_p)sprite, &rect);
+	((av_window_p)sprite)->methods->get_rect((av_window_p)sprite, &rect);
 	int screen_width = ((av_visible_p)sprite)->system->display->display_config.width;
 	int screen_height = ((av_visible_p)sprite)->system->display->display_config.height;
 
@@ -51,7 +51,7 @@ av_bool_t girl_move_timer(void* arg)
 		girl_dy = -girl_dy;
 	rect.x += girl_dx;
 	rect.y += girl_dy;
-	((av_window_p)sprite)->set_rect((av_window_p)sprite, &rect);
+	((av_window_p)sprite)->methods->set_rect((av_window_p)sprite, &rect);
 	return AV_TRUE;
 }
 
@@ -77,14 +77,14 @@ int test_sprite()
 		goto quit;
 	}
 
-	main->create_child(main, "sprite", (av_visible_p*)&sprite);
-	((av_visible_p)sprite)->set_surface((av_visible_p)sprite, girl_surface);
-	sprite->set_size(sprite, girl_width, girl_height);
+	main->methods->create_child(main, "sprite", (av_visible_p*)&sprite);
+	((av_visible_p)sprite)->methods->set_surface((av_visible_p)sprite, girl_surface);
+	sprite->methods->set_size(sprite, girl_width, girl_height);
 	rect.x = rect.y = 0;
 	rect.w = girl_width;
 	rect.h = girl_height;
-	((av_window_p)sprite)->set_rect((av_window_p)sprite, &rect);
-	sprite->set_sequence(sprite, seq_girl, 6, 700, AV_TRUE);
+	((av_window_p)sprite)->methods->set_rect((av_window_p)sprite, &rect);
+	sprite->methods->set_sequence(sprite, seq_girl, 6, 700, AV_TRUE);
 
 	/*
 	system->timer->add_timer(system->timer, girl_move_timer, 200, sprite, AV_NULL);
@@ -93,12 +93,12 @@ int test_sprite()
 	{
 		rect.x = (int)((float)1000 * RAND);
 		rect.y = (int)((float)1000 * RAND);
-		main->create_child(main, "sprite", (av_visible_p*)&sprite);
-		((av_visible_p)sprite)->set_surface((av_visible_p)sprite, explosion_surface);
-		sprite->set_size(sprite, explosion_width, explosion_height);
+		main->methods->create_child(main, "sprite", (av_visible_p*)&sprite);
+		((av_visible_p)sprite)->methods->set_surface((av_visible_p)sprite, explosion_surface);
+		sprite->methods->set_size(sprite, explosion_width, explosion_height);
 		rect.w = explosion_width;
 		rect.h = explosion_height;
-		((av_window_p)sprite)->set_rect((av_window_p)sprite, &rect);
+		((av_window_p)sprite)->methods->set_rect((av_window_p)sprite, &rect);
 		system->timer->add_timer(system->timer, sprite_timer, (int)((float)2000 * RAND), sprite, AV_NULL);
 	}*/
 
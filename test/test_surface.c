@@ -13,8 +13,8 @@ int test_surface()
 		printf("Can't load %s\n", IMAGE_NAME);
 		goto quit;
 	}
-	main->create_child(main, "visible", &visible);
-	visible->set_surface(visible, surface);
+	main->methods->create_child(main, "visible", &visible);
+	visible->methods->set_surface(visible, surface);
 	avgl_loop();
 quit:
 	avgl_destroy();
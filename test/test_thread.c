@@ -0,0 +1,119 @@
+#include <avgl.h>
+
+#define SPSC_TEST_COUNT 100000
+
+static int spsc_producer_thread(av_thread_p thread)
+{
+	av_spsc_queue_p queue = (av_spsc_queue_p)thread->arg;
+	intptr_t i;
+	for (i = 1; i <= SPSC_TEST_COUNT; i++)
+		if (AV_OK != queue->push(queue, (void*)i))
+			return 1;
+	return 0;
+}
+
+int test_spsc_queue()
+{
+	av_spsc_queue_p queue;
+	av_thread_p producer;
+	void* element;
+	intptr_t i;
+
+	if (AV_OK != av_spsc_queue_create(10, &queue))
+		return 0;
+
+	/* non blocking calls report full and empty queue */
+	for (i = 1; i <= 10; i++)
+		if (AV_OK != queue->try_push(queue, (void*)i))
+			return 0;
+	if (AV_EAGAIN != queue->try_push(queue, (void*)i))
+		return 0;
+	for (i = 1; i <= 10; i++)
+		if (AV_OK != queue->try_pop(queue, &element) || (intptr_t)element != i)
+			return 0;
+	if (AV_EAGAIN != queue->try_pop(queue, &element))
+		return 0;
+
+	/* elements pass between threads in order */
+	av_thread_create(spsc_producer_thread, queue, &producer);
+	producer->start(producer);
+	for (i = 1; i <= SPSC_TEST_COUNT; i++)
+	{
+		if (AV_OK != queue->pop(queue, &element))
+			return 0;
+		if ((intptr_t)element != i)
+			return 0;
+	}
+	producer->join(producer);
+	producer->destroy(producer);
+
+	if (0 != queue->size(queue))
+		return 0;
+
+	/* abort releases the blocked consumer */
+	queue->abort(queue);
+	if (AV_EINTERRUPT != queue->pop(queue, &element))
+		return 0;
+
+	queue->destroy(queue);
+	return 1;
+}
+
+#define TASK_TEST_COUNT 64
+
+typedef struct task_test
+{
+	av_task_pool_p pool;
+	unsigned int sum;
+} task_test_t, *task_test_p;
+
+static void task_add(void* arg)
+{
+	av_atomic_inc(&((task_test_p)arg)->sum);
+}
+
+/* spawns nested tasks and waits for them from inside the pool */
+static void task_spawn(void* arg)
+{
+	task_test_p test = (task_test_p)arg;
+	av_task_group_t group = AV_TASK_GROUP_INIT;
+	int i;
+	for (i = 0; i < TASK_TEST_COUNT; i++)
+		test->pool->submit(test->pool, &group, task_add, test);
+	test->pool->wait(test->pool, &group);
+}
+
+int test_task_pool()
+{
+	av_task_pool_p pool;
+	av_task_group_t group = AV_TASK_GROUP_INIT;
+	task_test_t test;
+	int i;
+
+	if (AV_OK != av_task_pool_create(2, &pool))
+		return 0;
+	test.pool = pool;
+	test.sum = 0;
+
+	for (i = 0; i < TASK_TEST_COUNT; i++)
+		if (AV_OK != pool->submit(pool, &group, task_add, &test))
+			return 0;
+	pool->wait(pool, &group);
+	if (TASK_TEST_COUNT != av_atomic_load(&test.sum) || 0 != group.pending)
+		return 0;
+
+	/* nested groups complete before the outer one */
+	test.sum = 0;
+	for (i = 0; i < TASK_TEST_COUNT; i++)
+		pool->submit(pool, &group, task_spawn, &test);
+	pool->wait(pool, &group);
+	if (TASK_TEST_COUNT * TASK_TEST_COUNT != av_atomic_load(&test.sum))
+		return 0;
+
+	/* tasks without group are completed before destroy returns */
+	test.sum = 0;
+	for (i = 0; i < TASK_TEST_COUNT; i++)
+		pool->submit(pool, AV_NULL, task_add, &test);
+	pool->destroy(pool);
+	return (TASK_TEST_COUNT == test.sum);
+}
@@ -0,0 +1,54 @@
+#include <avgl.h>
+
+int test_vector()
+{
+	av_vector_p vector;
+	av_rect_t rect;
+	av_rect_p prect;
+	int i, sum;
+
+	if (AV_OK != av_vector_create(sizeof(av_rect_t), &vector))
+		return 0;
+
+	/* elements are stored by value */
+	for (i = 0; i < 100; i++)
+	{
+		av_rect_init(&rect, i, 0, 1, 1);
+		if (AV_OK != vector->push_last(vector, &rect))
+			return 0;
+	}
+	if (100 != vector->size)
+		return 0;
+
+	av_rect_init(&rect, -1, 0, 1, 1);
+	vector->insert(vector, 0, &rect);
+	if (-1 != av_vector_at(vector, av_rect_t, 0).x || 99 != av_vector_at(vector, av_rect_t, 100).x)
+		return 0;
+
+	vector->remove(vector, 0);
+	av_rect_init(&rect, 50, 0, 1, 1);
+	if (50 != vector->index_of(vector, &rect))
+		return 0;
+
+	/* nested iterations do not disturb each other */
+	sum = 0;
+	av_vector_foreach(vector, av_rect_t, prect)
+	{
+		av_rect_p pinner;
+		av_vector_foreach_reverse(vector, av_rect_t, pinner)
+			if (pinner->x == prect->x)
+				sum++;
+	}
+	if (100 != sum)
+		return 0;
+
+	if (!vector->pop_last(vector, &rect) || 99 != rect.x || 99 != vector->size)
+		return 0;
+
+	vector->remove_all(vector);
+	if (0 != vector->size || vector->pop_last(vector, AV_NULL))
+		return 0;
+
+	vector->destroy(vector);
+	return 1;
+}
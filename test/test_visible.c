@@ -12,7 +12,7 @@ static av_result_t av_custom_visible_constructor(av_object_p object)
 {
 	av_custom_visible_p self = (av_custom_visible_p)object;
 	av_visible_p visible = (av_visible_p)object;
-	visible->set_surface(visible, avgl_load_surface(IMAGE_NAME));
+	visible->methods->set_surface(visible, avgl_load_surface(IMAGE_NAME));
 	return AV_OK;
 }
 
@@ -35,14 +35,14 @@ int test_visible()
 	if (AV_OK != (rc = register_visible(main)))
 		return rc;
 
-	if (AV_OK != (rc = main->create_child(main, "custom_visible", &visible)))
+	if (AV_OK != (rc = main->methods->create_child(main, "custom_visible", &visible)))
 		return rc;
 
 	system = (av_system_p)visible->system;
-	((av_window_p)visible)->get_rect((av_window_p)visible, &rect);
+	((av_window_p)visible)->methods->get_rect((av_window_p)visible, &rect);
 	
 	rect.y = (visible->system->display->display_config.height - rect.h) / 2;
-	((av_window_p)visible)->set_rect((av_window_p)visible, &rect);
+	((av_window_p)visible)->methods->set_rect((av_window_p)visible, &rect);
 
 	avgl_loop();
 	avgl_destroy();
@@ -22,8 +22,8 @@ static av_bool_t on_draw(av_visible_p self, av_graphics_p graphics)
 	av_rect_t rect;
 	av_rect_t absrect;
 	av_window_p window = (av_window_p)self;
-	window->get_rect(window, &rect);
-	window->get_absolute_rect(window, &absrect);
+	window->methods->get_rect(window, &rect);
+	window->methods->get_absolute_rect(window, &absrect);
 	rect.x = rect.y = 0;
 	graphics->rectangle(graphics, &rect);
 	addr = (addr & 0xFFFF) ^ ((addr >> 16) & 0xFFFF);
@@ -58,7 +58,7 @@ static av_bool_t on_mouse_button_down(av_window_p self, av_event_mouse_button_t
 		mouse_x = x;
 		mouse_y = y;
 		avgl_capture_visible((av_visible_p)self);
-		self->raise_top(self);
+		self->methods->raise_top(self);
 		dragging = AV_TRUE;
 		is_position_change = AV_TRUE;
 		return AV_TRUE;
@@ -125,7 +125,7 @@ static av_bool_t on_mouse_move(av_window_p self, int x, int y)
 	if (dragging)
 	{
 		av_rect_t rect;
-		self->get_rect(self, &rect);
+		self->methods->get_rect(self, &rect);
 		if (is_position_change)
 		{
 			rect.x += (x - mouse_x);
@@ -136,7 +136,7 @@ static av_bool_t on_mouse_move(av_window_p self, int x, int y)
 			rect.w += (x - mouse_x);
 			rect.h += (y - mouse_y);
 		}
-		self->set_rect(self, &rect);
+		self->methods->set_rect(self, &rect);
 //		printf("%p set_rect %d %d %d %d\n", self, rect.x, rect.y, rect.w, rect.h);
 		mouse_x = x;
 		mouse_y = y;
@@ -151,12 +151,12 @@ av_visible_p new_window(av_visible_p parent, int x, int y, int w, int h)
 	av_visible_p child;
 	av_window_p window;
 	av_rect_t rect;
-	parent->create_child(parent, "visible", &child);
+	parent->methods->create_child(parent, "visible", &child);
 	window = (av_window_p)child;
 	av_rect_init(&rect, x, y, w, h);
-	window->set_rect(window, &rect);
+	window->methods->set_rect(window, &rect);
 	child->on_draw = on_draw;
-	window->set_hover_delay(window, 0);
+	window->methods->set_hover_delay(window, 0);
 	window->on_mouse_move        = on_mouse_move;
 	window->on_mouse_button_down = on_mouse_button_down;
 	window->on_mouse_button_up   = on_mouse_button_up;
@@ -181,7 +181,7 @@ int test_widgets()
 	for (i=0; i<7; i++)
 	{
 		av_visible_p widget = new_window(root_visible, i * 2, i * 2, 4, 3);
-		((av_window_p)widget)->set_clip_children((av_window_p)widget, 1);
+		((av_window_p)widget)->methods->set_clip_children((av_window_p)widget, 1);
 		new_window(widget, 1, 1, 3, 2);
 	}
 
@@ -4,8 +4,8 @@ void dump_window(av_window_p window)
 {
 	av_rect_t rect;
 	av_rect_t arect;
-	window->get_rect(window, &rect);
-	window->get_absolute_rect(window, &arect);
+	window->methods->get_rect(window, &rect);
+	window->methods->get_absolute_rect(window, &arect);
 	printf("window %d %d %d %d {%d %d %d %d}\n", rect.x, rect.y, rect.w, rect.h, arect.x, arect.y, arect.w, arect.h);
 }
 
@@ -21,11 +21,11 @@ int test_window_absolute()
 	oop->new(oop, "window", (av_object_p*)&child);
 	
 	av_rect_init(&rect, 10, 10, 5, 5);
-	parent->set_rect(parent, &rect);
+	parent->methods->set_rect(parent, &rect);
 
 	av_rect_init(&rect, 0, 0, 5, 5);
-	child->set_rect(child, &rect);
-	child->set_parent(child, parent);
+	child->methods->set_rect(child, &rect);
+	child->methods->set_parent(child, parent);
 
 	dump_window(child);
 	dump_window(parent);
@@ -34,3 +34,151 @@ int test_window_absolute()
 	oop->destroy(oop);
 	return 1;
 }
+
+static int window_absolute_is(av_window_p window, int x, int y)
+{
+	av_rect_t rect;
+	window->methods->get_absolute_rect(window, &rect);
+	return rect.x == x && rect.y == y;
+}
+
+int test_window_geometry()
+{
+	av_window_p root;
+	av_window_p parent;
+	av_window_p child;
+	av_oop_p oop;
+	av_rect_t rect;
+	av_oop_create(&oop);
+	av_window_register_oop(oop);
+	oop->new(oop, "window", (av_object_p*)&root);
+	oop->new(oop, "window", (av_object_p*)&parent);
+	oop->new(oop, "window", (av_object_p*)&child);
+
+	av_rect_init(&rect, 0, 0, 100, 100);
+	root->methods->set_rect(root, &rect);
+	av_rect_init(&rect, 10, 10, 20, 20);
+	parent->methods->set_rect(parent, &rect);
+	av_rect_init(&rect, 15, 15, 10, 10);
+	child->methods->set_rect(child, &rect);
+	parent->methods->set_parent(parent, root);
+	child->methods->set_parent(child, parent);
+	if (!window_absolute_is(child, 25, 25))
+		return 0;
+
+	/* cached geometry follows the changes of the parents */
+	av_rect_init(&rect, 20, 10, 20, 20);
+	parent->methods->set_rect(parent, &rect);
+	if (!window_absolute_is(child, 35, 25))
+		return 0;
+	parent->methods->move(parent, -5, 0);
+	if (!window_absolute_is(child, 30, 25) || !window_absolute_is(parent, 20, 10))
+		return 0;
+
+	/* the child part outside the parent is clipped */
+	child->methods->get_clip_rect(child, &rect);
+	if (rect.x != 30 || rect.y != 25 || rect.w != 10 || rect.h != 5)
+		return 0;
+	if (!child->methods->point_inside(child, 30, 29) || child->methods->point_inside(child, 30, 30))
+		return 0;
+
+	/* hit test still requires the point inside the parent */
+	parent->methods->set_clip_children(parent, AV_FALSE);
+	child->methods->get_clip_rect(child, &rect);
+	if (rect.h != 10 || child->methods->point_inside(child, 30, 30))
+		return 0;
+
+	/* reparenting */
+	child->methods->set_parent(child, root);
+	if (!window_absolute_is(child, 15, 15) || !child->methods->point_inside(child, 15, 24))
+		return 0;
+	child->methods->detach(child);
+	if (!window_absolute_is(child, 15, 15))
+		return 0;
+
+	O_release(child);
+	O_release(parent);
+	O_release(root);
+	oop->destroy(oop);
+	return 1;
+}
+
+int test_window_index()
+{
+	av_window_p parent;
+	av_window_p children[64];
+	av_vector_p indexed;
+	av_vector_p linear;
+	av_oop_p oop;
+	av_rect_t rect;
+	int i, x, y;
+	av_oop_create(&oop);
+	av_window_register_oop(oop);
+	oop->new(oop, "window", (av_object_p*)&parent);
+	av_vector_create(sizeof(av_window_p), &indexed);
+	av_vector_create(sizeof(av_window_p), &linear);
+
+	av_rect_init(&rect, 7, 3, 1000, 1000);
+	parent->methods->set_rect(parent, &rect);
+	parent->methods->set_children_index(parent, AV_TRUE);
+
+	/* overlapping tiles, some added to the bottom, one not clipping its children */
+	for (i = 0; i < 64; i++)
+	{
+		oop->new(oop, "window", (av_object_p*)&children[i]);
+		av_rect_init(&rect, (i % 8) * 90, (i / 8) * 90, 100 + i, 100);
+		children[i]->methods->set_rect(children[i], &rect);
+		if (i % 5)
+			parent->methods->add_child_top(parent, children[i]);
+		else
+			parent->methods->add_child_bottom(parent, children[i]);
+	}
+	children[10]->methods->set_clip_children(children[10], AV_FALSE);
+	children[20]->methods->raise_top(children[20]);
+	av_rect_init(&rect, 300, 300, 150, 150);
+	children[30]->methods->set_rect(children[30], &rect);
+
+	for (y = 0; y < 800; y += 37)
+	{
+		for (x = 0; x < 800; x += 41)
+		{
+			av_window_p child = parent->methods->get_child_xy(parent, x, y);
+			av_window_p* pchild;
+			av_window_p expected = AV_NULL;
+			av_vector_foreach(parent->methods->get_children(parent), av_window_p, pchild)
+			{
+				(*pchild)->methods->get_rect(*pchild, &rect);
+				if (av_rect_point_inside(&rect, x, y))
+					expected = *pchild;
+			}
+			if (child != expected)
+				return 0;
+
+			/* rect query keeps the z-order of all children intersecting it */
+			av_rect_init(&rect, x + 7, y + 3, 50, 20);
+			indexed->remove_all(indexed);
+			linear->remove_all(linear);
+			parent->methods->get_children_in_rect(parent, &rect, indexed);
+			av_vector_foreach(parent->methods->get_children(parent), av_window_p, pchild)
+			{
+				av_rect_t crect;
+				(*pchild)->methods->get_absolute_rect(*pchild, &crect);
+				if (*pchild == children[10] || av_rect_intersect(&crect, &rect, &crect))
+					linear->push_last(linear, pchild);
+			}
+			if (indexed->size != linear->size)
+				return 0;
+			for (i = 0; i < (int)linear->size; i++)
+				if (av_vector_at(indexed, av_window_p, i) != av_vector_at(linear, av_window_p, i))
+					return 0;
+		}
+	}
+
+	for (i = 0; i < 64; i++)
+		O_release(children[i]);
+	indexed->destroy(indexed);
+	linear->destroy(linear);
+	O_release(parent);
+	oop->destroy(oop);
+	return 1;
+}